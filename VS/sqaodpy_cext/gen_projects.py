@@ -36,6 +36,7 @@ projects.append(("cpu_dg_bf_searcher", "6068ceca-94ad-40f2-a0d5-d90f58c02e2e"))
 projects.append(("cpu_dg_annealer", "973318d4-3110-4a4e-8508-97856ef046b7"))
 projects.append(("cpu_bg_bf_searcher", "ac9eb479-e526-47b5-8b09-103874f1c1ae"))
 projects.append(("cpu_bg_annealer", "ea2132df-2463-41b0-861b-d306c97bd42f"))
+projects.append(("cpu_sg_annealer", "3f6c2a8e-5b1d-4e7a-9c40-2d8b7e1f6a53"))
 
 
 # generate projects
@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <utility>
+#include <algorithm>
+#include <new>
 #include <sqaodc/common/defines.h>
 #include <sqaodc/common/types.h>
 
@@ -22,46 +24,112 @@ template<> struct ValueProp<long long> { enum { POD = true }; };
 template<> struct ValueProp<unsigned long long> { enum { POD = true }; };
 template<class V> struct ValueProp<V*> { enum { POD = true }; };
 
-/* FIXME: add move c-tor */
+/* element operations of arrays, selected at compile time.  Raw memory operations
+ * are instantiated only for PODs. */
+
+template<class V, bool POD = ValueProp<V>::POD>
+struct ArrayElementOps {
+    /* moves n elements to uninitialized dst, and destructs them in src.
+     * [dst, dst + n) and [src, src + n) may overlap. */
+    static void relocate(V *dst, V *src, SizeType n) {
+        if (dst < src) {
+            for (SizeType idx = 0; idx < n; ++idx) {
+                new (&dst[idx]) V(std::move_if_noexcept(src[idx]));
+                src[idx].~V();
+            }
+        }
+        else {
+            for (SizeType idx = n; 0 < idx; --idx) {
+                new (&dst[idx - 1]) V(std::move_if_noexcept(src[idx - 1]));
+                src[idx - 1].~V();
+            }
+        }
+    }
+
+    static void copy(V *dst, const V *src, SizeType n) {
+        for (SizeType idx = 0; idx < n; ++idx)
+            new (&dst[idx]) V(src[idx]);
+    }
+
+    static void destruct(V *v, SizeType n) {
+        for (SizeType idx = 0; idx < n; ++idx)
+            v[idx].~V();
+    }
+
+    static bool equal(const V *lhs, const V *rhs, SizeType n) {
+        for (SizeType idx = 0; idx < n; ++idx) {
+            if (lhs[idx] != rhs[idx])
+                return false;
+        }
+        return true;
+    }
+};
+
+template<class V>
+struct ArrayElementOps<V, true> {
+    static void relocate(V *dst, V *src, SizeType n) {
+        if (n != 0)
+            memmove(dst, src, sizeof(V) * n);
+    }
+
+    static void copy(V *dst, const V *src, SizeType n) {
+        if (n != 0)
+            memcpy(dst, src, sizeof(V) * n);
+    }
+
+    static void destruct(V *, SizeType) { }
+
+    static bool equal(const V *lhs, const V *rhs, SizeType n) {
+        return (n == 0) || (memcmp(lhs, rhs, sizeof(V) * n) == 0);
+    }
+};
+
+/* Arrays do not allocate memory until the first element is added.  Capacity grows
+ * geometrically, so that appending n elements costs O(log n) reallocations. */
 
 template<class V>
 struct ArrayType {
+    typedef ArrayElementOps<V> Ops;
 public:
     typedef V* iterator;
     typedef const V* const_iterator;
     typedef V ValueType;
     
-    ArrayType(SizeType capacity = 1024) {
+    ArrayType(SizeType capacity = 0) {
         data_ = nullptr;
         size_ = 0;
-        allocate(capacity);
+        capacity_ = 0;
+        reserve(capacity);
     }
 
     ArrayType(const ArrayType<V> &rhs) {
         data_ = nullptr;
         size_ = 0;
-        allocate(rhs.capacity());
+        capacity_ = 0;
+        reserve(rhs.size());
         insert(rhs.begin(), rhs.end());
     }
 
+    ArrayType(ArrayType<V> &&rhs) noexcept {
+        data_ = rhs.data_;
+        size_ = rhs.size_;
+        capacity_ = rhs.capacity_;
+        rhs.data_ = nullptr;
+        rhs.size_ = 0;
+        rhs.capacity_ = 0;
+    }
+
     ~ArrayType() {
         if (data_ != nullptr)
             deallocate();
     }
     
     void reserve(SizeType capacity) {
-        if (capacity < capacity_)
+        if (capacity <= capacity_)
             return;
         V *new_data = (V*)malloc(sizeof(V) * capacity);
-        if (ValueProp<V>::POD) {
-            memcpy(new_data, data_, sizeof(V) * size_);
-        }
-        else {
-            for (SizeType idx = 0; idx < size_; ++idx) {
-                new (&new_data[idx]) V(std::move_if_noexcept(data_[idx]));
-                data_[idx].~V();
-            }
-        }
+        throwErrorIf(new_data == nullptr, "Failed to allocate memory, capacity = %d.", (int)capacity);
+        Ops::relocate(new_data, data_, size_);
         free(data_);
         data_ = new_data;
         capacity_ = capacity;
@@ -85,37 +153,47 @@ public:
     }
 
     void erase(iterator it) {
-        if (ValueProp<V>::POD) {
-            memmove(it, it + 1, sizeof(V) * (size_ - 1));
-        }
-        else {
-            for (; it != end() - 1; ++it) {
-                it->~V();
-                new (&*it) V(std::move_if_noexcept(*(it + 1)));
-            }
-            data_[size_ - 1].~V();
-        }
+        Ops::destruct(it, 1);
+        Ops::relocate(it, it + 1, SizeType(end() - it - 1));
         --size_;
     }
     
     void pushBack(const V &v) {
-        if (size_ == capacity_)
-            reserve(capacity_ * 2);
-        if (ValueProp<V>::POD)
-            data_[size_] = v;
-        else
+        if (size_ == capacity_) {
+            /* v may refer to an element of this array. */
+            V copied(v);
+            grow(size_ + 1);
+            new (&data_[size_]) V(std::move(copied));
+        }
+        else {
             new (&data_[size_]) V(v);
+        }
         ++size_;
     }
 
-    // FIXME: apply move_if_noexcept
     void pushBack(V &&v) {
-        if (size_ == capacity_)
-            reserve(capacity_ * 2);
-        if (ValueProp<V>::POD)
-            data_[size_] = v;
-        else
-            new (&data_[size_]) V(v);
+        if (size_ == capacity_) {
+            V moved(std::move(v));
+            grow(size_ + 1);
+            new (&data_[size_]) V(std::move(moved));
+        }
+        else {
+            new (&data_[size_]) V(std::move(v));
+        }
+        ++size_;
+    }
+
+    template<class... Args>
+    void emplaceBack(Args&&... args) {
+        if (size_ == capacity_) {
+            /* args may refer to elements of this array. */
+            V constructed(std::forward<Args>(args)...);
+            grow(size_ + 1);
+            new (&data_[size_]) V(std::move(constructed));
+        }
+        else {
+            new (&data_[size_]) V(std::forward<Args>(args)...);
+        }
         ++size_;
     }
     
@@ -143,93 +221,80 @@ public:
         return data_[idx];
     }
 
+    V *data() {
+        return data_;
+    }
+
     const V *data() const {
         return data_;
     }
     
     const ArrayType &operator=(const ArrayType &rhs) {
+        if (this == &rhs)
+            return *this;
         clear();
-        reserve(rhs.capacity());
+        reserve(rhs.size());
         insert(rhs.begin(), rhs.end());
-        return rhs;
+        return *this;
+    }
+
+    const ArrayType &operator=(ArrayType &&rhs) noexcept {
+        if (this == &rhs)
+            return *this;
+        if (data_ != nullptr)
+            deallocate();
+        data_ = rhs.data_;
+        size_ = rhs.size_;
+        capacity_ = rhs.capacity_;
+        rhs.data_ = nullptr;
+        rhs.size_ = 0;
+        rhs.capacity_ = 0;
+        return *this;
     }
 
     bool operator==(const ArrayType &rhs) const {
         if (size_ != rhs.size_)
             return false;
-        if (ValueProp<V>::POD) {
-            return memcmp(data_, rhs.data_, sizeof(V) * size_) == 0;
-        }
-        else {
-            for (IdxType idx = 0; idx < size_; ++idx) {
-                if (data_[idx] != rhs.data_[idx])
-                    return false;
-            }
-            return true;
-        }
+        return Ops::equal(data_, rhs.data_, size_);
     }
 
     bool operator!=(const ArrayType &rhs) const {
         return !operator==(rhs);
     }
 
+    /* [first, last) must not be a range of this array. */
     void insert(const_iterator first, const_iterator last) {
         SizeType nElms = SizeType(last - first);
-        if (capacity_ < size_ + nElms)
-            reserve(capacity_ * 2);
-        if (ValueProp<V>::POD) {
-            memcpy(&data_[size_], first, sizeof(V) * nElms);
-            size_ += nElms;
-        }
-        else {
-            for (const_iterator it = first; it != last; ++it) {
-                new (&data_[size_]) V(*it);
-                ++size_;
-            }
-        }
+        if (nElms == 0)
+            return;
+        grow(size_ + nElms);
+        Ops::copy(&data_[size_], first, nElms);
+        size_ += nElms;
     }
 
     void insert(const_iterator pos, const ValueType &v) {
-        if (capacity_ < size_ + 1)
-            reserve(capacity_ * 2);
+        /* pos is invalidated by reallocation, and v may refer to an element of this array. */
+        IdxType posIdx = IdxType(pos - begin());
+        V copied(v);
+        grow(size_ + 1);
         
-        /* move */
-        SizeType nToMove = SizeType(end() - pos);
-        IdxType posIdx = SizeType(pos - begin());
-        if (ValueProp<V>::POD) {
-            memmove(&data_[posIdx + 1], &data_[posIdx], sizeof(V) * nToMove);
-        }
-        else {
-            IdxType dstIdx  = size();
-            IdxType srcIdx  = size() - 1;
-            for (SizeType idx = 0; idx < nToMove; ++idx) {
-                new (&data_[dstIdx - idx]) V(data_[srcIdx - idx]);
-                data_[srcIdx - idx].~V();
-            }
-        }
-        
-        if (ValueProp<V>::POD) {
-            memcpy(&data_[posIdx], &v, sizeof(V));
-        }
-        else {
-            new (&data_[posIdx]) V(v);
-        }
+        Ops::relocate(&data_[posIdx + 1], &data_[posIdx], size_ - posIdx);
+        new (&data_[posIdx]) V(std::move(copied));
         ++size_;
     }
 
 
 private:
-    void erase() {
-        if (!ValueProp<V>::POD) {
-            for (IdxType idx = 0; idx < size_; ++idx)
-                data_[idx].~V();
-        }
+    /* make room for nElms elements, capacity is at least doubled when reallocated. */
+    void grow(SizeType nElms) {
+        if (nElms <= capacity_)
+            return;
+        SizeType capacity = std::max(capacity_ * 2, SizeType(16));
+        reserve(std::max(capacity, nElms));
     }
 
-    void allocate(SizeType capacity) {
-        assert(data_ == nullptr);
-        data_ = (V*)malloc(sizeof(V) * capacity);
-        capacity_ = capacity;
+    void erase() {
+        Ops::destruct(data_, size_);
     }
 
     void deallocate() {
@@ -0,0 +1,120 @@
+#include "Checkpoint.h"
+#include "defines.h"
+#include <string.h>
+
+using namespace sqaod;
+
+namespace {
+
+const char checkpointMagic[8] = { 'S', 'Q', 'A', 'O', 'D', 'C', 'K', 'P' };
+const unsigned int checkpointVersion = 3;
+
+}
+
+
+unsigned long long sqaod::fingerprint(const void *data, size_t size, unsigned long long hash) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (size_t idx = 0; idx < size; ++idx) {
+        hash ^= bytes[idx];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+
+CheckpointWriter::CheckpointWriter(const char *filename, CheckpointKind kind)
+        : filename_(filename), tmpFilename_(std::string(filename) + ".tmp") {
+    file_ = fopen(tmpFilename_.c_str(), "wb");
+    throwErrorIf(file_ == NULL, "Failed to open %s.", tmpFilename_.c_str());
+    hash_ = fingerprint(NULL, 0);
+    unsigned int header[2] = { checkpointVersion, (unsigned int)kind };
+    bool ok = fwrite(checkpointMagic, sizeof(checkpointMagic), 1, file_) == 1;
+    ok &= fwrite(header, sizeof(header), 1, file_) == 1;
+    if (!ok) {
+        fclose(file_);
+        file_ = NULL;
+        remove(tmpFilename_.c_str());
+        throwErrorIf(true, "Failed to write %s.", tmpFilename_.c_str());
+    }
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (file_ != NULL) {
+        /* not committed */
+        fclose(file_);
+        remove(tmpFilename_.c_str());
+    }
+}
+
+void CheckpointWriter::write(const void *data, size_t size) {
+    if (size == 0)
+        return;
+    throwErrorIf(fwrite(data, size, 1, file_) != 1, "Failed to write %s.", tmpFilename_.c_str());
+    hash_ = fingerprint(data, size, hash_);
+}
+
+void CheckpointWriter::commit() {
+    bool ok = fwrite(&hash_, sizeof(hash_), 1, file_) == 1;
+    ok &= fclose(file_) == 0;
+    file_ = NULL;
+    throwErrorIf(!ok, "Failed to write %s.", tmpFilename_.c_str());
+#ifdef _WIN32
+    remove(filename_.c_str());
+#endif
+    throwErrorIf(rename(tmpFilename_.c_str(), filename_.c_str()) != 0,
+                 "Failed to rename %s to %s.", tmpFilename_.c_str(), filename_.c_str());
+}
+
+
+CheckpointReader::CheckpointReader(const char *filename, CheckpointKind kind) {
+    file_ = fopen(filename, "rb");
+    throwErrorIf(file_ == NULL, "Failed to open %s.", filename);
+    char magic[sizeof(checkpointMagic)];
+    unsigned int header[2];
+    bool ok = fread(magic, sizeof(magic), 1, file_) == 1;
+    ok &= fread(header, sizeof(header), 1, file_) == 1;
+    ok &= memcmp(magic, checkpointMagic, sizeof(magic)) == 0;
+    if (!ok) {
+        fclose(file_);
+        file_ = NULL;
+        throwErrorIf(true, "%s is not a checkpoint.", filename);
+    }
+    if ((header[0] != checkpointVersion) || (header[1] != (unsigned int)kind)) {
+        fclose(file_);
+        file_ = NULL;
+        throwErrorIf(true, "Checkpoint version or kind mismatch, version=%d, kind=%d.",
+                     header[0], header[1]);
+    }
+    /* the payload is followed by the hash. */
+    long payloadBegin = ftell(file_);
+    fseek(file_, 0, SEEK_END);
+    long fileEnd = ftell(file_);
+    fseek(file_, payloadBegin, SEEK_SET);
+    long payloadEnd = fileEnd - (long)sizeof(unsigned long long);
+    payloadSize_ = (payloadBegin < payloadEnd) ? (unsigned long long)(payloadEnd - payloadBegin) : 0;
+    nReadBytes_ = 0;
+    hash_ = fingerprint(NULL, 0);
+}
+
+CheckpointReader::~CheckpointReader() {
+    if (file_ != NULL)
+        fclose(file_);
+}
+
+void CheckpointReader::read(void *data, size_t size) {
+    if (size == 0)
+        return;
+    throwErrorIf(fread(data, size, 1, file_) != 1, "Checkpoint is truncated.");
+    hash_ = fingerprint(data, size, hash_);
+    nReadBytes_ += size;
+}
+
+unsigned long long CheckpointReader::remainingSize() const {
+    return (nReadBytes_ < payloadSize_) ? payloadSize_ - nReadBytes_ : 0;
+}
+
+void CheckpointReader::finish() {
+    unsigned long long hash;
+    bool ok = fread(&hash, sizeof(hash), 1, file_) == 1;
+    throwErrorIf(!ok || (hash != hash_), "Checkpoint is broken.");
+}
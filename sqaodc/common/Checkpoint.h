@@ -0,0 +1,115 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Array.h>
+#include <sqaodc/common/Matrix.h>
+#include <stdio.h>
+#include <string>
+
+namespace sqaod {
+
+/* Binary checkpoints of brute-force searches, also used for partial results.
+ *
+ * A file consists of a header, "SQAODCKP", a format version and a kind, the payload
+ * written by a searcher, and the FNV-1a hash of the payload.  Values are stored in the
+ * native byte order.  A checkpoint is written to a temporary file which replaces the
+ * destination on commit(), so an interrupted write does not break an older checkpoint. */
+
+enum CheckpointKind {
+    ckDenseGraphBFSearcher = 1,
+    ckBipartiteGraphBFSearcher = 2,
+    ckDenseGraphBFPartialResult = 3,
+};
+
+/* FNV-1a hash, used to check that a checkpoint is resumed with the same problem. */
+unsigned long long fingerprint(const void *data, size_t size,
+                               unsigned long long hash = 0xcbf29ce484222325ull);
+
+template<class V> inline
+unsigned long long fingerprint(const MatrixType<V> &mat,
+                               unsigned long long hash = 0xcbf29ce484222325ull) {
+    for (IdxType row = 0; row < (IdxType)mat.rows; ++row)
+        hash = fingerprint(mat.row(row), sizeof(V) * mat.cols, hash);
+    return hash;
+}
+
+template<class V> inline
+unsigned long long fingerprint(const VectorType<V> &vec,
+                               unsigned long long hash = 0xcbf29ce484222325ull) {
+    return fingerprint(vec.data, sizeof(V) * vec.size, hash);
+}
+
+
+class CheckpointWriter {
+public:
+    CheckpointWriter(const char *filename, CheckpointKind kind);
+    ~CheckpointWriter();
+
+    void write(const void *data, size_t size);
+
+    template<class V>
+    void write(const V &v) {
+        write(&v, sizeof(V));
+    }
+
+    /* elements should be trivially copyable. */
+    template<class V>
+    void writeArray(const ArrayType<V> &arr) {
+        write((unsigned long long)arr.size());
+        write(arr.data(), sizeof(V) * arr.size());
+    }
+
+    /* writes the hash, and replaces the destination file. */
+    void commit();
+
+private:
+    CheckpointWriter(const CheckpointWriter &);
+    
+    FILE *file_;
+    std::string filename_;
+    std::string tmpFilename_;
+    unsigned long long hash_;
+};
+
+
+class CheckpointReader {
+public:
+    CheckpointReader(const char *filename, CheckpointKind kind);
+    ~CheckpointReader();
+
+    void read(void *data, size_t size);
+
+    template<class V>
+    V read() {
+        V v;
+        read(&v, sizeof(V));
+        return v;
+    }
+
+    template<class V>
+    void readArray(ArrayType<V> *arr) {
+        unsigned long long size = read<unsigned long long>();
+        /* size is not verified by the hash yet. */
+        throwErrorIf(remainingSize() / sizeof(V) < size, "Checkpoint is broken.");
+        arr->clear();
+        arr->reserve(SizeType(size));
+        for (unsigned long long idx = 0; idx < size; ++idx)
+            arr->pushBack(read<V>());
+    }
+
+    /* verifies the hash of the payload. */
+    void finish();
+
+private:
+    CheckpointReader(const CheckpointReader &);
+
+    /* bytes of the payload not read yet. */
+    unsigned long long remainingSize() const;
+    
+    FILE *file_;
+    unsigned long long hash_;
+    unsigned long long payloadSize_;
+    unsigned long long nReadBytes_;
+};
+
+}
@@ -1,6 +1,8 @@
 #include "Common.h"
 #include <iostream>
 #include <float.h>
+#include <vector>
+#include <algorithm>
 
 #ifndef SQAODC_CUDA_ENABLED
 bool sqaod::isCUDAAvailable() {
@@ -88,6 +90,39 @@ bool sqaod::isSymmetric(const MatrixType<real> &W) {
     return true;
 }
 
+template<class real>
+bool sqaod::isSymmetric(const SparseMatrixType<real> &W) {
+    if (W.rows != W.cols)
+        return false;
+    /* transpose by counting sort, then compare (column, value) pairs row by row. */
+    SizeType nnz = W.nnz();
+    std::vector<IdxType> tRowPtr(W.rows + 1, 0);
+    for (IdxType idx = 0; idx < nnz; ++idx)
+        ++tRowPtr[W.colIdx(idx) + 1];
+    for (IdxType row = 0; row < W.rows; ++row)
+        tRowPtr[row + 1] += tRowPtr[row];
+    std::vector<std::pair<IdxType, real> > tEntries(nnz);
+    std::vector<IdxType> pos(tRowPtr.begin(), tRowPtr.end() - 1);
+    for (IdxType row = 0; row < W.rows; ++row) {
+        for (IdxType idx = W.rowPtr(row); idx < W.rowPtr(row + 1); ++idx)
+            tEntries[pos[W.colIdx(idx)]++] = std::make_pair(row, W.values(idx));
+    }
+    std::vector<std::pair<IdxType, real> > rowEntries;
+    for (IdxType row = 0; row < W.rows; ++row) {
+        IdxType begin = W.rowPtr(row), end = W.rowPtr(row + 1);
+        if (end - begin != tRowPtr[row + 1] - tRowPtr[row])
+            return false;
+        rowEntries.clear();
+        for (IdxType idx = begin; idx < end; ++idx)
+            rowEntries.push_back(std::make_pair(W.colIdx(idx), W.values(idx)));
+        std::sort(rowEntries.begin(), rowEntries.end());
+        std::sort(tEntries.begin() + tRowPtr[row], tEntries.begin() + tRowPtr[row + 1]);
+        if (!std::equal(rowEntries.begin(), rowEntries.end(), tEntries.begin() + tRowPtr[row]))
+            return false;
+    }
+    return true;
+}
+
 
 // template<class real>
 // sqaod::MatrixType<real> sqaod::bitsToMat(const BitMatrix &bits) {
@@ -108,6 +143,14 @@ template
 bool ::sqaod::isSymmetric<float>(const sqaod::MatrixType<float> &W);
 template
 bool ::sqaod::isSymmetric<double>(const sqaod::MatrixType<double> &W);
+template
+bool ::sqaod::isSymmetric<short>(const sqaod::MatrixType<short> &W);
+template
+bool ::sqaod::isSymmetric<int>(const sqaod::MatrixType<int> &W);
+template
+bool ::sqaod::isSymmetric<float>(const sqaod::SparseMatrixType<float> &W);
+template
+bool ::sqaod::isSymmetric<double>(const sqaod::SparseMatrixType<double> &W);
 
 // template
 // sqaod::MatrixType<double> sqaod::bitsToMat<double>(const BitMatrix &bits);
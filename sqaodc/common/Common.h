@@ -3,6 +3,8 @@
 #include <sqaodc/common/Matrix.h>
 #include <sqaodc/common/Array.h>
 #include <sqaodc/common/Random.h>
+#include <sqaodc/common/RandomXoshiro.h>
+#include <sqaodc/common/RandomPhilox.h>
 #include <sqaodc/common/Preference.h>
 #include <sqaodc/common/Solver.h>
 
@@ -20,10 +22,23 @@ void unpackBitSet(BitSet *unpacked, const PackedBitSet packed, int N);
 template<class real>
 bool isSymmetric(const MatrixType<real> &W);
 
+template<class real>
+bool isSymmetric(const SparseMatrixType<real> &W);
+
+/* copies src to dst.  dst is resized if not mapped, otherwise its shape should match. */
+template<class V> inline
+void copyToMatrix(MatrixType<V> *dst, const MatrixType<V> &src) {
+    throwErrorIf(dst->mapped && ((dst->rows != src.rows) || (dst->cols != src.cols)),
+                 "Shape of matrix, (%d, %d), should be (%d, %d).",
+                 dst->rows, dst->cols, src.rows, src.cols);
+    dst->copyFrom(src);
+}
+
 template<class V> inline
 BitMatrix x_from_q(const MatrixType<V> &q) {
     BitMatrix x(q.dim());
-    x_from_q(x.data, q.data, q.rows * q.cols);
+    for (IdxType row = 0; row < (IdxType)q.rows; ++row)
+        x_from_q(x.row(row), q.row(row), q.cols);
     return x;
 }
 
@@ -37,7 +52,8 @@ BitSet x_from_q(const VectorType<V> &q) {
 template<class V> inline
 MatrixType<V> x_to_q(const BitMatrix &x) {
     MatrixType<V> q(x.dim());
-    x_to_q(q.data, x.data, x.rows * x.cols);
+    for (IdxType row = 0; row < (IdxType)x.rows; ++row)
+        x_to_q(q.row(row), x.row(row), x.cols);
     return x;
 }
 
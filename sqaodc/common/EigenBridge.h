@@ -31,8 +31,12 @@ template<class real>
 using EigenRowVectorType = Eigen::Matrix<real, 1, Eigen::Dynamic>;
 template<class real>
 using EigenColumnVectorType = Eigen::Matrix<real, Eigen::Dynamic, 1>;
+/* rows of mapped matrices are MatrixType::stride apart. */
 template<class real>
-using EigenMappedMatrixType = Eigen::Map<EigenMatrixType<real>>;
+using EigenMappedMatrixType = Eigen::Map<EigenMatrixType<real>, Eigen::Unaligned, Eigen::OuterStride<> >;
+/* rows of padded matrices are aligned to cache lines, given by mapToAligned(). */
+template<class real>
+using EigenAlignedMappedMatrixType = Eigen::Map<EigenMatrixType<real>, Eigen::Aligned64, Eigen::OuterStride<> >;
 template<class real>
 using EigenMappedRowVectorType = Eigen::Map<EigenRowVectorType<real>>;
 template<class real>
@@ -48,14 +52,32 @@ MatrixType<V> mapFrom(EigenMatrixType<V> &matrix) {
     return MatrixType<V>(matrix.data(), matrix.rows(), matrix.cols());
 }
 
+template<class V, int Options>
+MatrixType<V> mapFrom(Eigen::Map<EigenMatrixType<V>, Options, Eigen::OuterStride<> > &matrix) {
+    return MatrixType<V>(matrix.data(), matrix.rows(), matrix.cols(), matrix.outerStride());
+}
+
 template<class V>
 EigenMappedMatrixType<V> mapTo(MatrixType<V> &mat) {
-    return EigenMappedMatrixType<V>(mat.data, mat.rows, mat.cols);
+    return EigenMappedMatrixType<V>(mat.data, mat.rows, mat.cols, Eigen::OuterStride<>(mat.stride));
 }
 
 template<class V>
 const EigenMappedMatrixType<V> mapTo(const MatrixType<V> &mat) {
-    return EigenMappedMatrixType<V>(mat.data, mat.rows, mat.cols);
+    return EigenMappedMatrixType<V>(mat.data, mat.rows, mat.cols, Eigen::OuterStride<>(mat.stride));
+}
+
+/* mat should be padded by paddedStride<V>(cols). */
+template<class V>
+EigenAlignedMappedMatrixType<V> mapToAligned(MatrixType<V> &mat) {
+    assert(mat.stride == paddedStride<V>(mat.cols));
+    return EigenAlignedMappedMatrixType<V>(mat.data, mat.rows, mat.cols, Eigen::OuterStride<>(mat.stride));
+}
+
+template<class V>
+const EigenAlignedMappedMatrixType<V> mapToAligned(const MatrixType<V> &mat) {
+    assert(mat.stride == paddedStride<V>(mat.cols));
+    return EigenAlignedMappedMatrixType<V>(mat.data, mat.rows, mat.cols, Eigen::OuterStride<>(mat.stride));
 }
 
 
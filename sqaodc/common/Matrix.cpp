@@ -28,6 +28,9 @@ MatrixType<real> MatrixType<real>::ones(SizeType rows, SizeType cols) {
 
 template struct sqaod::MatrixType<float>;
 template struct sqaod::MatrixType<double>;
+/* integer weights */
+template struct sqaod::MatrixType<short>;
+template struct sqaod::MatrixType<int>;
 
 
 template<class real>
@@ -46,4 +49,7 @@ VectorType<real> VectorType<real>::ones(SizeType size) {
 
 template struct sqaod::VectorType<float>;
 template struct sqaod::VectorType<double>;
+/* integer weights */
+template struct sqaod::VectorType<short>;
+template struct sqaod::VectorType<int>;
 
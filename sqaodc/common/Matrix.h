@@ -4,10 +4,22 @@
 #include <sqaodc/common/types.h>
 #include <sqaodc/common/UniformOp.h>
 #include <sqaodc/common/Array.h>
+#include <sqaodc/common/Memory.h>
 
 namespace sqaod {
 
-/* light-weight matrix classes for C++ API */
+/* light-weight matrix classes for C++ API
+ *
+ * Memory of matrices and vectors is aligned to cache lines.  Rows of a matrix are
+ * stride elements apart (stride >= cols), so rows can be padded to cache lines
+ * by giving stride of paddedStride<V>(cols).  Matrices are packed (stride == cols)
+ * unless stride is given. */
+
+/* row stride to align rows to cache lines */
+template<class V> inline
+SizeType paddedStride(SizeType cols) {
+    return roundUpToCacheLine<V>(cols);
+}
 
 template<class V>
 struct MatrixType {
@@ -28,6 +40,11 @@ struct MatrixType {
         allocate(dim.rows, dim.cols);
     }
 
+    explicit MatrixType(SizeType _rows, SizeType _cols, SizeType _stride) {
+        resetState();
+        allocate(_rows, _cols, _stride);
+    }
+
     MatrixType(const MatrixType<V> &mat) {
         resetState();
         copyFrom(mat);
@@ -42,6 +59,16 @@ struct MatrixType {
         data = _data;
         rows = _rows;
         cols = _cols;
+        stride = _cols;
+        mapped = true;
+    }
+
+    explicit MatrixType(V *_data, SizeType _rows, SizeType _cols, SizeType _stride) {
+        assert(_cols <= _stride);
+        data = _data;
+        rows = _rows;
+        cols = _cols;
+        stride = _stride;
         mapped = true;
     }
     
@@ -56,7 +83,12 @@ struct MatrixType {
     }
 
     void operator=(const V &v) {
-        sqaod::fill(data, v, rows * cols);
+        if (isPacked()) {
+            sqaod::fill(data, v, rows * cols);
+            return;
+        }
+        for (IdxType r = 0; r < (IdxType)rows; ++r)
+            sqaod::fill(row(r), v, cols);
     }
 
     const MatrixType<V> &operator=(MatrixType<V> &&rhs) noexcept {
@@ -66,21 +98,31 @@ struct MatrixType {
 
     Dim dim() const { return Dim(rows, cols); }
 
+    /* true if rows are not padded. */
+    bool isPacked() const { return stride == cols; }
+
     void resetState() {
         data = nullptr;
-        rows = cols = -1;
+        rows = cols = stride = -1;
         mapped = false;
     }
     
     void map(V *_data, SizeType _rows, SizeType _cols) {
+        map(_data, _rows, _cols, _cols);
+    }
+
+    void map(V *_data, SizeType _rows, SizeType _cols, SizeType _stride) {
+        assert(_cols <= _stride);
         if (!mapped)
             free();
         mapped = true;
         data = _data;
         rows = _rows;
         cols = _cols;
+        stride = _stride;
     }
     
+    /* stride of this matrix is kept if the shape is the same as src. */
     void copyFrom(const MatrixType<V> &src) {
         if (this == &src)
             return;
@@ -90,7 +132,12 @@ struct MatrixType {
         }
         if (data == nullptr)
             allocate(src.rows, src.cols);
-        memcpy(data, src.data, sizeof(V) * rows * cols);
+        if (isPacked() && src.isPacked()) {
+            memcpy(data, src.data, sizeof(V) * rows * cols);
+            return;
+        }
+        for (IdxType r = 0; r < (IdxType)rows; ++r)
+            memcpy(row(r), src.row(r), sizeof(V) * cols);
     }
 
     void moveFrom(MatrixType<V> &src) {
@@ -101,6 +148,7 @@ struct MatrixType {
         /* updating this */
         rows = src.rows;
         cols = src.cols;
+        stride = src.stride;
         data = src.data;
         mapped = src.mapped;
         /* clean up src */
@@ -108,25 +156,37 @@ struct MatrixType {
     }
     
     void allocate(SizeType _rows, SizeType _cols) {
+        allocate(_rows, _cols, _cols);
+    }
+
+    void allocate(SizeType _rows, SizeType _cols, SizeType _stride) {
         assert(!mapped);
+        assert(_cols <= _stride);
         rows = _rows;
         cols = _cols;
-        data = (V*)malloc(rows * cols * sizeof(V));
+        stride = _stride;
+        data = nullptr;
+        if ((0 < rows) && (0 < stride))
+            data = (V*)alignedMalloc(rows * stride * sizeof(V));
     }
     
     void free() {
         assert(!mapped);
-        rows = cols = -1;
+        rows = cols = stride = -1;
         if (data != nullptr)
-            ::free(data);
+            alignedFree(data);
         data = nullptr;
     }
     
     void resize(SizeType _rows, SizeType _cols) {
+        resize(_rows, _cols, _cols);
+    }
+
+    void resize(SizeType _rows, SizeType _cols, SizeType _stride) {
         assert(!mapped); /* mapping state not allowed */
-        if ((_rows != rows) || (_cols != cols)) {
-            ::free(data);
-            allocate(_rows, _cols);
+        if ((_rows != rows) || (_cols != cols) || (_stride != stride)) {
+            free();
+            allocate(_rows, _cols, _stride);
         }
     }
 
@@ -137,24 +197,43 @@ struct MatrixType {
     V &operator()(IdxType r, IdxType c) {
         assert((0 <= r) && (r < (IdxType)rows));
         assert((0 <= c) && (c < (IdxType)cols));
-        return data[r * cols + c];
+        return data[r * stride + c];
     }
     
     const V &operator()(IdxType r, IdxType c) const {
         assert((0 <= r) && (r < (IdxType)rows));
         assert((0 <= c) && (c < (IdxType)cols));
-        return data[r * cols + c];
+        return data[r * stride + c];
+    }
+
+    V *row(IdxType r) {
+        return &data[r * stride];
+    }
+
+    const V *row(IdxType r) const {
+        return &data[r * stride];
     }
 
     V sum() const {
-        return sqaod::sum(data, rows * cols);
+        if (isPacked())
+            return sqaod::sum(data, rows * cols);
+        V v = V(0);
+        for (IdxType r = 0; r < (IdxType)rows; ++r)
+            v += sqaod::sum(row(r), cols);
+        return v;
     }
 
     V min() const {
-        return sqaod::min(data, rows * cols);
+        if (isPacked())
+            return sqaod::min(data, rows * cols);
+        V v = std::numeric_limits<V>::max();
+        for (IdxType r = 0; r < (IdxType)rows; ++r)
+            v = std::min(v, sqaod::min(row(r), cols));
+        return v;
     }
     
     SizeType rows, cols;
+    SizeType stride; /* # elements between the heads of adjacent rows. */
     V *data;
     bool mapped;
 
@@ -184,7 +263,13 @@ template<class V>
 bool operator==(const MatrixType<V> &lhs, const MatrixType<V> &rhs) {
     if (lhs.dim() != rhs.dim())
         return false;
-    return memcmp(lhs.data, rhs.data, sizeof(V) * lhs.rows * lhs.cols) == 0;
+    if (lhs.isPacked() && rhs.isPacked())
+        return memcmp(lhs.data, rhs.data, sizeof(V) * lhs.rows * lhs.cols) == 0;
+    for (IdxType r = 0; r < (IdxType)lhs.rows; ++r) {
+        if (memcmp(lhs.row(r), rhs.row(r), sizeof(V) * lhs.cols) != 0)
+            return false;
+    }
+    return true;
 }
 
 template<class V>
@@ -194,14 +279,24 @@ bool operator!=(const MatrixType<V> &lhs, const MatrixType<V> &rhs) {
 
 template<class V>
 MatrixType<V> &operator*=(MatrixType<V> &mat, const V &v) {
-    multiply(mat.data, v, mat.rows * mat.cols);
+    if (mat.isPacked()) {
+        multiply(mat.data, v, mat.rows * mat.cols);
+        return mat;
+    }
+    for (IdxType r = 0; r < (IdxType)mat.rows; ++r)
+        multiply(mat.row(r), v, mat.cols);
     return mat;
 }
 
 template<class newV, class V>
 sqaod::MatrixType<newV> cast(const MatrixType<V> &mat) {
     MatrixType<newV> newMat(mat.dim());
-    cast(newMat.data, mat.data, mat.rows * mat.cols);
+    if (mat.isPacked()) {
+        cast(newMat.data, mat.data, mat.rows * mat.cols);
+        return newMat;
+    }
+    for (IdxType r = 0; r < (IdxType)mat.rows; ++r)
+        cast(newMat.row(r), mat.row(r), mat.cols);
     return newMat;
 }
 
@@ -299,23 +394,24 @@ struct VectorType {
     
     void allocate(SizeType _size) {
         assert(!mapped);
-        /* FIXME: alligned mem allocator */
         size = _size;
-        data = (V*)malloc(size * sizeof(V));
+        data = nullptr;
+        if (0 < size)
+            data = (V*)alignedMalloc(size * sizeof(V));
     }
     
     void free() {
         assert(!mapped);
         size = -1;
         if (data != nullptr)
-            ::free(data);
+            alignedFree(data);
         data = nullptr;
     }
     
     void resize(SizeType _size) {
         assert(!mapped);
         if (_size != size) {
-            ::free(data);
+            free();
             allocate(_size);
         }
     }
@@ -381,6 +477,52 @@ sqaod::VectorType<newV> cast(const VectorType<V> &vec) {
 
 
 
+/* light-weight sparse matrix in the compressed sparse row (CSR) format.
+ * Column indices and values of the row i are stored in
+ * colIdx(rowPtr(i)) ... colIdx(rowPtr(i + 1) - 1), and values in the same range. */
+
+template<class V>
+struct SparseMatrixType {
+    typedef V ValueType;
+
+    explicit SparseMatrixType() : rows(0), cols(0) { }
+
+    explicit SparseMatrixType(SizeType _rows, SizeType _cols, SizeType _nnz)
+            : rows(_rows), cols(_cols), rowPtr(_rows + 1), colIdx(_nnz), values(_nnz) { }
+
+    void resize(SizeType _rows, SizeType _cols, SizeType _nnz) {
+        rows = _rows;
+        cols = _cols;
+        rowPtr.resize(_rows + 1);
+        colIdx.resize(_nnz);
+        values.resize(_nnz);
+    }
+
+    /* map CSR arrays allocated outside. */
+    void map(IdxType *_rowPtr, IdxType *_colIdx, V *_values,
+             SizeType _rows, SizeType _cols, SizeType _nnz) {
+        rows = _rows;
+        cols = _cols;
+        rowPtr.map(_rowPtr, _rows + 1);
+        colIdx.map(_colIdx, _nnz);
+        values.map(_values, _nnz);
+    }
+
+    SizeType nnz() const {
+        return values.size;
+    }
+
+    Dim dim() const {
+        return Dim(rows, cols);
+    }
+
+    SizeType rows, cols;
+    VectorType<IdxType> rowPtr;
+    VectorType<IdxType> colIdx;
+    VectorType<V> values;
+};
+
+
 typedef VectorType<char> BitSet;
 typedef MatrixType<char> BitMatrix;
 typedef ArrayType<BitSet> BitSetArray;
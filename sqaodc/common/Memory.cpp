@@ -0,0 +1,31 @@
+#include "Memory.h"
+#include "defines.h"
+#include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace sqaod;
+
+
+void *sqaod::alignedMalloc(size_t size, size_t alignment) {
+    void *ptr = NULL;
+    if (size == 0)
+        return NULL;
+#ifdef _WIN32
+    ptr = _aligned_malloc(size, alignment);
+#else
+    if (posix_memalign(&ptr, alignment, size) != 0)
+        ptr = NULL;
+#endif
+    throwErrorIf(ptr == NULL, "Failed to allocate aligned memory, size = %d.", (int)size);
+    return ptr;
+}
+
+void sqaod::alignedFree(void *ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
@@ -0,0 +1,26 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/types.h>
+#include <stddef.h>
+
+namespace sqaod {
+
+/* size of cache line, used to align and pad memory updated by multiple threads. */
+enum {
+    cacheLineSize = 64,
+};
+
+/* allocate memory aligned to alignment, which should be a power of 2. */
+void *alignedMalloc(size_t size, size_t alignment = cacheLineSize);
+
+void alignedFree(void *ptr);
+
+/* number of elements padded to fill cache lines. */
+template<class V> inline
+SizeType roundUpToCacheLine(SizeType size) {
+    const SizeType nElmsInLine = cacheLineSize / sizeof(V);
+    return ((size + nElmsInLine - 1) / nElmsInLine) * nElmsInLine;
+}
+
+}
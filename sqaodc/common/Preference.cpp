@@ -15,6 +15,14 @@ const char *sqaod::algorithmToString(Algorithm algo) {
         return "coloring";
     case algoBruteForceSearch:
         return "brute_force_search";
+    case algoLocalField:
+        return "local_field";
+    case algoMultiSpinCoding:
+        return "multi_spin_coding";
+    case algoGrayCode:
+        return "gray_code";
+    case algoBranchAndBound:
+        return "branch_and_bound";
     case algoDefault:
         return "default";
     case algoUnknown:
@@ -30,12 +38,70 @@ Algorithm sqaod::algorithmFromString(const char *algoStr) {
         return algoColoring;
     if (strcasecmp("brute_force_search", algoStr) == 0)
         return algoBruteForceSearch;
+    if (strcasecmp("local_field", algoStr) == 0)
+        return algoLocalField;
+    if (strcasecmp("multi_spin_coding", algoStr) == 0)
+        return algoMultiSpinCoding;
+    if (strcasecmp("gray_code", algoStr) == 0)
+        return algoGrayCode;
+    if (strcasecmp("branch_and_bound", algoStr) == 0)
+        return algoBranchAndBound;
     if (strcasecmp("default", algoStr) == 0)
         return algoDefault;
     return algoUnknown;
 }
 
 
+const char *sqaod::randomGeneratorToString(RandomGenerator rng) {
+    switch (rng) {
+    case rngDefault:
+        return "default";
+    case rngCounterBased:
+        return "counter_based";
+    case rngUnknown:
+    default:
+        return "unknown";
+    }
+}
+
+RandomGenerator sqaod::randomGeneratorFromString(const char *rngStr) {
+    if (strcasecmp("default", rngStr) == 0)
+        return rngDefault;
+    if (strcasecmp("counter_based", rngStr) == 0)
+        return rngCounterBased;
+    return rngUnknown;
+}
+
+
+const char *sqaod::acceptanceMethodToString(AcceptanceMethod method) {
+    switch (method) {
+    case acceptDefault:
+        return "default";
+    case acceptLogUniform:
+        return "log_uniform";
+    case acceptTable:
+        return "table";
+    case acceptFastExp:
+        return "fast_exp";
+    case acceptUnknown:
+    default:
+        return "unknown";
+    }
+}
+
+AcceptanceMethod sqaod::acceptanceMethodFromString(const char *methodStr) {
+    if (strcasecmp("default", methodStr) == 0)
+        return acceptDefault;
+    if (strcasecmp("log_uniform", methodStr) == 0)
+        return acceptLogUniform;
+    if (strcasecmp("table", methodStr) == 0)
+        return acceptTable;
+    if (strcasecmp("fast_exp", methodStr) == 0)
+        return acceptFastExp;
+    return acceptUnknown;
+}
+
+
 enum PreferenceName sqaod::preferenceNameFromString(const char *name) {
     if (strcasecmp("algorithm", name) == 0)
         return pnAlgorithm;
@@ -49,6 +115,16 @@ enum PreferenceName sqaod::preferenceNameFromString(const char *name) {
         return pnTileSize1;
     if (strcasecmp("precision", name) == 0)
         return pnPrecision;
+    if (strcasecmp("n_threads", name) == 0)
+        return pnNumThreads;
+    if (strcasecmp("random", name) == 0)
+        return pnRandom;
+    if (strcasecmp("acceptance", name) == 0)
+        return pnAcceptance;
+    if (strcasecmp("top_k", name) == 0)
+        return pnTopK;
+    if (strcasecmp("energy_window", name) == 0)
+        return pnEnergyWindow;
     return pnUnknown;
 }
 
@@ -68,6 +144,16 @@ const char *sqaod::preferenceNameToString(enum PreferenceName pn) {
         return "precision";
     case pnDevice:
         return "device";
+    case pnNumThreads:
+        return "n_threads";
+    case pnRandom:
+        return "random";
+    case pnAcceptance:
+        return "acceptance";
+    case pnTopK:
+        return "top_k";
+    case pnEnergyWindow:
+        return "energy_window";
     default:
         return "unknown";
     }
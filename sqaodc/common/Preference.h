@@ -11,6 +11,10 @@ enum Algorithm {
     algoNaive,
     algoColoring,
     algoBruteForceSearch,
+    algoLocalField,
+    algoMultiSpinCoding,
+    algoGrayCode,
+    algoBranchAndBound,
 };
 
 
@@ -19,6 +23,30 @@ const char *algorithmToString(Algorithm algo);
 Algorithm algorithmFromString(const char *algoStr);
 
 
+enum RandomGenerator {
+    rngUnknown,
+    rngDefault,      /* a random number stream per thread */
+    rngCounterBased, /* counter-based, results do not depend on # threads */
+};
+
+const char *randomGeneratorToString(RandomGenerator rng);
+
+RandomGenerator randomGeneratorFromString(const char *rngStr);
+
+
+enum AcceptanceMethod {
+    acceptUnknown,
+    acceptDefault,    /* exp(-dE beta) > u */
+    acceptLogUniform, /* dE beta < -log(u) */
+    acceptTable,      /* tabulated exp(-dE beta), for integer-valued hamiltonians */
+    acceptFastExp,    /* polynomial approximation of exp() */
+};
+
+const char *acceptanceMethodToString(AcceptanceMethod method);
+
+AcceptanceMethod acceptanceMethodFromString(const char *methodStr);
+
+
 enum PreferenceName {
     pnUnknown = 0,
     pnAlgorithm = 1,
@@ -28,7 +56,13 @@ enum PreferenceName {
     pnTileSize1 = 5,   /* tileSize1 for bipartite graph searchers */
     pnPrecision = 6,
     pnDevice = 7,
-    pnMax = 8,
+    pnNumThreads = 8,  /* # threads for CPU solvers */
+    pnRandom = 9,      /* random number generator for CPU annealers */
+    pnAcceptance = 10, /* acceptance method of flips for CPU annealers */
+    pnTopK = 11,         /* # lowest-energy states collected by CPU brute force searchers */
+    pnEnergyWindow = 12, /* states in [Emin, Emin + energyWindow] are collected by CPU BF searchers,
+                            up to tile_size states without top_k */
+    pnMax = 13,
 };
 
 enum PreferenceName preferenceNameFromString(const char *name);
@@ -38,7 +72,11 @@ const char *preferenceNameToString(enum PreferenceName pn);
 struct Preference {
     Preference(PreferenceName _name, SizeType _size) : name(_name), size(_size) { }
     Preference(PreferenceName _name, Algorithm _algo) : name(_name), algo(_algo) { }
+    Preference(PreferenceName _name, RandomGenerator _rng) : name(_name), rng(_rng) { }
+    Preference(PreferenceName _name, AcceptanceMethod _acceptance)
+            : name(_name), acceptance(_acceptance) { }
     Preference(PreferenceName _name, const char *_str) : name(_name), str(_str) { }
+    Preference(PreferenceName _name, double _value) : name(_name), value(_value) { }
     Preference() : name(pnUnknown) { }
     Preference(const Preference &) = default;
 
@@ -46,10 +84,16 @@ struct Preference {
     union {
         SizeType size;
         const char *str;
+        double value;
 
         Algorithm algo;
+        RandomGenerator rng;
+        AcceptanceMethod acceptance;
         SizeType tileSize;
         SizeType nTrotters;
+        SizeType nThreads;
+        SizeType topK;
+        double energyWindow;
         const char *precision;
         const char *device;
     };
@@ -0,0 +1,105 @@
+#include "RandomPhilox.h"
+#include <time.h>
+
+using namespace sqaod;
+
+
+/* Philox4x32-10 by J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw,
+ * "Parallel random numbers: as easy as 1, 2, 3", SC11. */
+
+namespace {
+
+enum {
+    nRounds = 10,
+    nLanes = 8,
+};
+
+const unsigned int philoxM0 = 0xD2511F53u, philoxM1 = 0xCD9E8D57u;
+const unsigned int philoxW0 = 0x9E3779B9u, philoxW1 = 0xBB67AE85u;
+
+inline
+void philoxRound(unsigned int &c0, unsigned int &c1, unsigned int &c2, unsigned int &c3,
+                 unsigned int k0, unsigned int k1) {
+    unsigned long long p0 = (unsigned long long)philoxM0 * c0;
+    unsigned long long p1 = (unsigned long long)philoxM1 * c2;
+    unsigned int n0 = (unsigned int)(p1 >> 32) ^ c1 ^ k0;
+    unsigned int n2 = (unsigned int)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (unsigned int)p1;
+    c3 = (unsigned int)p0;
+    c0 = n0;
+    c2 = n2;
+}
+
+}
+
+
+RandomPhilox::RandomPhilox() {
+    seed();
+}
+
+void RandomPhilox::seed() {
+    seed((unsigned long long)time(NULL));
+}
+
+void RandomPhilox::seed(unsigned long long s) {
+    key_[0] = (unsigned int)s;
+    key_[1] = (unsigned int)(s >> 32);
+    seek(0, 0, 0);
+}
+
+void RandomPhilox::generate() {
+    unsigned int c0 = counter_[0], c1 = counter_[1], c2 = counter_[2], c3 = counter_[3];
+    unsigned int k0 = key_[0], k1 = key_[1];
+    for (int round = 0; round < nRounds; ++round) {
+        philoxRound(c0, c1, c2, c3, k0, k1);
+        k0 += philoxW0;
+        k1 += philoxW1;
+    }
+    buffer_[0] = c0;
+    buffer_[1] = c1;
+    buffer_[2] = c2;
+    buffer_[3] = c3;
+    ++counter_[0];
+    pos_ = 0;
+}
+
+void RandomPhilox::fill(float *v, SizeType size) {
+    /* consume words left in the buffer. */
+    while ((pos_ != 4) && (0 < size)) {
+        *v++ = randomf32();
+        --size;
+    }
+    /* nLanes blocks are generated at once in a vectorizable loop. */
+    while (nLanes * 4 <= size) {
+        unsigned int c0[nLanes], c1[nLanes], c2[nLanes], c3[nLanes];
+        for (int lane = 0; lane < nLanes; ++lane) {
+            c0[lane] = counter_[0] + lane;
+            c1[lane] = counter_[1];
+            c2[lane] = counter_[2];
+            c3[lane] = counter_[3];
+        }
+        unsigned int k0 = key_[0], k1 = key_[1];
+        for (int round = 0; round < nRounds; ++round) {
+            for (int lane = 0; lane < nLanes; ++lane)
+                philoxRound(c0[lane], c1[lane], c2[lane], c3[lane], k0, k1);
+            k0 += philoxW0;
+            k1 += philoxW1;
+        }
+        for (int lane = 0; lane < nLanes; ++lane) {
+            v[lane * 4] = (int)(c0[lane] >> 8) * float(1. / 16777216.);
+            v[lane * 4 + 1] = (int)(c1[lane] >> 8) * float(1. / 16777216.);
+            v[lane * 4 + 2] = (int)(c2[lane] >> 8) * float(1. / 16777216.);
+            v[lane * 4 + 3] = (int)(c3[lane] >> 8) * float(1. / 16777216.);
+        }
+        counter_[0] += nLanes;
+        v += nLanes * 4;
+        size -= nLanes * 4;
+    }
+    for (int idx = 0; idx < size; ++idx)
+        v[idx] = randomf32();
+}
+
+void RandomPhilox::fill(double *v, SizeType size) {
+    for (int idx = 0; idx < size; ++idx)
+        v[idx] = randomf64();
+}
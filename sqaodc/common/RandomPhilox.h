@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/types.h>
+
+namespace sqaod {
+
+/* Philox4x32-10 counter-based generator.
+ *
+ * Random numbers are given by a function of (key, counter), and seek() moves the
+ * stream to the counter (0, c1, c2, c3).  The first counter word is incremented
+ * as the stream is consumed, so a stream started at (c1, c2, c3) gives the same
+ * sequence whichever thread or generator instance draws it. */
+
+class RandomPhilox {
+public:
+    RandomPhilox();
+
+    void seed();
+
+    void seed(unsigned long long s);
+
+    void seek(unsigned int c1, unsigned int c2, unsigned int c3) {
+        counter_[0] = 0;
+        counter_[1] = c1;
+        counter_[2] = c2;
+        counter_[3] = c3;
+        pos_ = 4;
+    }
+
+    unsigned int randInt32() {
+        if (pos_ == 4)
+            generate();
+        return buffer_[pos_++];
+    }
+
+    /* unbiased random integer in [0, N) */
+    unsigned long randInt(int N);
+
+    float randomf32() {
+        return (randInt32() >> 8) * float(1. / 16777216.); /* 24 bits */
+    }
+
+    double randomf64() {
+        unsigned int a = randInt32() >> 5, b = randInt32() >> 6;
+        return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0); /* 53 bits */
+    }
+
+    template<class real>
+    real random();
+
+    void fill(float *v, SizeType size);
+
+    void fill(double *v, SizeType size);
+
+private:
+    void generate();
+
+    unsigned int key_[2];
+    unsigned int counter_[4];
+    unsigned int buffer_[4];
+    int pos_;
+};
+
+
+inline
+unsigned long RandomPhilox::randInt(int N) {
+    /* Lemire's multiply-and-reject method. */
+    unsigned int range = (unsigned int)N;
+    unsigned long long m = (unsigned long long)randInt32() * range;
+    unsigned int low = (unsigned int)m;
+    if (low < range) {
+        unsigned int threshold = (0u - range) % range;
+        while (low < threshold) {
+            m = (unsigned long long)randInt32() * range;
+            low = (unsigned int)m;
+        }
+    }
+    return (unsigned long)(m >> 32);
+}
+
+template<> inline
+float RandomPhilox::random<float>() {
+    return randomf32();
+}
+template<> inline
+double RandomPhilox::random<double>() {
+    return randomf64();
+}
+
+}
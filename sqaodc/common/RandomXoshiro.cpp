@@ -0,0 +1,86 @@
+#include "RandomXoshiro.h"
+#include <time.h>
+
+using namespace sqaod;
+
+
+/* xoshiro128+ by David Blackman and Sebastiano Vigna, http://prng.di.unimi.it/ */
+
+RandomXoshiro::RandomXoshiro() {
+    seed();
+}
+
+void RandomXoshiro::seed() {
+    seed((unsigned long long)time(NULL));
+}
+
+/* splitmix64 is used to initialize states. */
+static unsigned long long splitmix64(unsigned long long &x) {
+    unsigned long long z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void RandomXoshiro::seed(unsigned long long s) {
+    for (int lane = 0; lane < nLanes; ++lane) {
+        unsigned long long v0 = splitmix64(s), v1 = splitmix64(s);
+        state_[0][lane] = (unsigned int)v0;
+        state_[1][lane] = (unsigned int)(v0 >> 32);
+        state_[2][lane] = (unsigned int)v1;
+        state_[3][lane] = (unsigned int)(v1 >> 32);
+        if ((v0 | v1) == 0) /* all-zero state is not allowed. */
+            state_[0][lane] = 1;
+    }
+    pos_ = bufferSize;
+}
+
+void RandomXoshiro::generate() {
+    unsigned int s0[nLanes], s1[nLanes], s2[nLanes], s3[nLanes];
+    for (int lane = 0; lane < nLanes; ++lane) {
+        s0[lane] = state_[0][lane];
+        s1[lane] = state_[1][lane];
+        s2[lane] = state_[2][lane];
+        s3[lane] = state_[3][lane];
+    }
+    for (int idx = 0; idx < bufferSize; idx += nLanes) {
+        for (int lane = 0; lane < nLanes; ++lane) {
+            buffer_[idx + lane] = s0[lane] + s3[lane];
+            unsigned int t = s1[lane] << 9;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+        }
+    }
+    for (int lane = 0; lane < nLanes; ++lane) {
+        state_[0][lane] = s0[lane];
+        state_[1][lane] = s1[lane];
+        state_[2][lane] = s2[lane];
+        state_[3][lane] = s3[lane];
+    }
+    pos_ = 0;
+}
+
+void RandomXoshiro::fill(float *v, SizeType size) {
+    while (0 < size) {
+        if (pos_ == bufferSize)
+            generate();
+        int nToCopy = bufferSize - pos_;
+        if (size < nToCopy)
+            nToCopy = size;
+        const unsigned int *words = &buffer_[pos_];
+        for (int idx = 0; idx < nToCopy; ++idx)
+            v[idx] = (int)(words[idx] >> 8) * float(1. / 16777216.);
+        pos_ += nToCopy;
+        v += nToCopy;
+        size -= nToCopy;
+    }
+}
+
+void RandomXoshiro::fill(double *v, SizeType size) {
+    for (int idx = 0; idx < size; ++idx)
+        v[idx] = randomf64();
+}
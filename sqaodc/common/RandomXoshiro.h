@@ -0,0 +1,87 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/types.h>
+
+namespace sqaod {
+
+/* xoshiro128+ generators running in nLanes interleaved lanes.
+ *
+ * Random numbers are generated by blocks of bufferSize words, and the lanes are
+ * updated in the inner loop so that the block generation is vectorized.
+ * The interface is compatible with sq::Random, and fill() generates uniform random
+ * numbers in [0, 1) for a whole array at once. */
+
+class RandomXoshiro {
+public:
+    RandomXoshiro();
+
+    void seed();
+
+    void seed(unsigned long long s);
+
+    unsigned int randInt32() {
+        if (pos_ == bufferSize)
+            generate();
+        return buffer_[pos_++];
+    }
+
+    /* unbiased random integer in [0, N) */
+    unsigned long randInt(int N);
+
+    float randomf32() {
+        return (randInt32() >> 8) * float(1. / 16777216.); /* 24 bits */
+    }
+
+    double randomf64() {
+        unsigned int a = randInt32() >> 5, b = randInt32() >> 6;
+        return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0); /* 53 bits */
+    }
+
+    template<class real>
+    real random();
+
+    void fill(float *v, SizeType size);
+
+    void fill(double *v, SizeType size);
+
+private:
+    void generate();
+
+    enum {
+        nLanes = 8,
+        bufferSize = 256,
+    };
+
+    unsigned int state_[4][nLanes];
+    unsigned int buffer_[bufferSize];
+    int pos_;
+};
+
+
+inline
+unsigned long RandomXoshiro::randInt(int N) {
+    /* Lemire's multiply-and-reject method. */
+    unsigned int range = (unsigned int)N;
+    unsigned long long m = (unsigned long long)randInt32() * range;
+    unsigned int low = (unsigned int)m;
+    if (low < range) {
+        unsigned int threshold = (0u - range) % range;
+        while (low < threshold) {
+            m = (unsigned long long)randInt32() * range;
+            low = (unsigned int)m;
+        }
+    }
+    return (unsigned long)(m >> 32);
+}
+
+template<> inline
+float RandomXoshiro::random<float>() {
+    return randomf32();
+}
+template<> inline
+double RandomXoshiro::random<double>() {
+    return randomf64();
+}
+
+}
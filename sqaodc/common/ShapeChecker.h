@@ -162,6 +162,39 @@ void isingModelSolutionShapeCheck(sq::SizeType N0, sq::SizeType N1,
 }
 
 
+/* Sparse graph */
+
+template<class real>
+void sparseMatrixShapeCheck(const sq::SparseMatrixType<real> &W,
+                            const char *func) {
+    throwErrorIf(W.rowPtr.size != W.rows + 1, "%s, Shape does not match.", func);
+    throwErrorIf(W.colIdx.size != W.nnz(), "%s, Shape does not match.", func);
+    throwErrorIf((W.rowPtr(0) != 0) || (W.rowPtr(W.rows) != W.nnz()),
+                 "%s, Broken row pointers.", func);
+    for (sq::IdxType row = 0; row < W.rows; ++row)
+        throwErrorIf(W.rowPtr(row + 1) < W.rowPtr(row), "%s, Broken row pointers.", func);
+    for (sq::IdxType idx = 0; idx < W.nnz(); ++idx)
+        throwErrorIf((W.colIdx(idx) < 0) || (W.cols <= W.colIdx(idx)),
+                     "%s, Column index out of range.", func);
+}
+
+template<class real>
+void quboShapeCheck(const sq::SparseMatrixType<real> &W,
+                    const char *func) {
+    sparseMatrixShapeCheck(W, func);
+    throwErrorIf(!sq::isSymmetric(W), "%s, W is not symmetric.", func);
+}
+
+template<class real>
+void isingModelShapeCheck(const sq::VectorType<real> &h,
+                          const sq::SparseMatrixType<real> &J, real c,
+                          const char *func) {
+    sparseMatrixShapeCheck(J, func);
+    throwErrorIf(!sq::isSymmetric(J), "%s, J is not symmetric.", func);
+    throwErrorIf(h.size != J.cols, "%s, Shape does not match.", func);
+}
+
+
 /* helpers to check  out parameters */
 
 template<class real> inline
@@ -1,5 +1,8 @@
 #include "Solver.h"
+#include "Common.h"
+#include "Checkpoint.h"
 #include "defines.h"
+#include <algorithm>
 
 
 namespace sqaod {
@@ -112,6 +115,16 @@ Algorithm BFSearcher<real>::getAlgorithm() const {
     return algoBruteForceSearch;
 }
 
+template<class real>
+void BFSearcher<real>::saveCheckpoint(const char *filename) const {
+    throwErrorIf(true, "Checkpoint is not supported by this searcher.");
+}
+
+template<class real>
+void BFSearcher<real>::resumeFromCheckpoint(const char *filename) {
+    throwErrorIf(true, "Checkpoint is not supported by this searcher.");
+}
+
 template<class real>
 Preferences Annealer<real>::getPreferences() const {
     Preferences prefs;
@@ -135,11 +148,129 @@ void Annealer<real>::setPreference(const Preference &pref) {
 }
 
 
+template<class real>
+void Annealer<real>::anneal(const AnnealSchedule<real> &schedule,
+                            AnnealCallback callback, void *userData, SizeType interval) {
+    throwErrorIf(schedule.G.size != schedule.beta.size,
+                 "Sizes of G and beta are not the same, %d, %d.",
+                 schedule.G.size, schedule.beta.size);
+    throwErrorIf((callback != NULL) && (interval <= 0),
+                 "Callback interval must be a positive integer, %d.", interval);
+    for (IdxType step = 0; step < schedule.size(); ++step) {
+        real G = schedule.G(step), beta = schedule.beta(step);
+        annealOneStep(G, beta);
+        if ((callback != NULL) && ((step + 1) % interval == 0)) {
+            if (!callback(userData, step, G, beta))
+                break;
+        }
+    }
+}
+
+
+template<class real>
+AnnealSchedule<real>::AnnealSchedule(const VectorType<real> &_G, const VectorType<real> &_beta)
+        : G(_G), beta(_beta) {
+    throwErrorIf(G.size != beta.size, "Sizes of G and beta are not the same, %d, %d.",
+                 G.size, beta.size);
+}
+
+template<class real>
+AnnealSchedule<real> AnnealSchedule<real>::geometric(real Ginit, real Gfin, real tau, real beta) {
+    throwErrorIf((tau <= real(0.)) || (real(1.) <= tau), "tau must be in (0, 1).");
+    throwErrorIf(Gfin <= real(0.), "Gfin must be positive.");
+    SizeType nSteps = 0;
+    for (real G = Ginit; Gfin < G; G *= tau)
+        ++nSteps;
+    AnnealSchedule<real> schedule;
+    schedule.G.allocate(nSteps);
+    schedule.beta.allocate(nSteps);
+    real G = Ginit;
+    for (IdxType step = 0; step < nSteps; ++step) {
+        schedule.G(step) = G;
+        schedule.beta(step) = beta;
+        G *= tau;
+    }
+    return schedule;
+}
+
+template<class real>
+AnnealSchedule<real> AnnealSchedule<real>::linear(real Ginit, real Gfin, SizeType nSteps,
+                                                  real beta) {
+    throwErrorIf(nSteps <= 0, "# steps must be a positive integer, %d.", nSteps);
+    AnnealSchedule<real> schedule;
+    schedule.G.allocate(nSteps);
+    schedule.beta.allocate(nSteps);
+    for (IdxType step = 0; step < nSteps; ++step) {
+        real ratio = (nSteps == 1) ? real(0.) : real(step) / real(nSteps - 1);
+        schedule.G(step) = Ginit + (Gfin - Ginit) * ratio;
+        schedule.beta(step) = beta;
+    }
+    return schedule;
+}
+
+
+/* rows of a matrix from bit sets, used by default implementations of annealers. */
+static BitMatrix toBitMatrix(const BitSetArray &bitsList, SizeType N) {
+    BitMatrix mat((SizeType)bitsList.size(), N);
+    for (IdxType idx = 0; idx < (IdxType)bitsList.size(); ++idx)
+        memcpy(&mat(idx, 0), bitsList[idx].data, N);
+    return mat;
+}
+
+static BitMatrix toBitMatrix(const BitSetPairArray &bitsPairList, bool second, SizeType N) {
+    BitMatrix mat((SizeType)bitsPairList.size(), N);
+    for (IdxType idx = 0; idx < (IdxType)bitsPairList.size(); ++idx) {
+        const BitSetPairArray::ValueType &pair = bitsPairList[idx];
+        memcpy(&mat(idx, 0), second ? pair.second.data : pair.first.data, N);
+    }
+    return mat;
+}
+
+template<class real>
+void DenseGraphAnnealer<real>::get_x(BitMatrix *x) const {
+    copyToMatrix(x, toBitMatrix(this->get_x(), this->N_));
+}
+
+template<class real>
+void DenseGraphAnnealer<real>::get_q(BitMatrix *q) const {
+    copyToMatrix(q, toBitMatrix(this->get_q(), this->N_));
+}
+
+template<class real>
+void SparseGraphAnnealer<real>::get_x(BitMatrix *x) const {
+    copyToMatrix(x, toBitMatrix(this->get_x(), this->N_));
+}
+
+template<class real>
+void SparseGraphAnnealer<real>::get_q(BitMatrix *q) const {
+    copyToMatrix(q, toBitMatrix(this->get_q(), this->N_));
+}
+
+template<class real>
+void BipartiteGraphAnnealer<real>::get_x(BitMatrix *x0, BitMatrix *x1) const {
+    const BitSetPairArray &xPairList = this->get_x();
+    copyToMatrix(x0, toBitMatrix(xPairList, false, this->N0_));
+    copyToMatrix(x1, toBitMatrix(xPairList, true, this->N1_));
+}
+
+template<class real>
+void BipartiteGraphAnnealer<real>::get_q(BitMatrix *q0, BitMatrix *q1) const {
+    const BitSetPairArray &qPairList = this->get_q();
+    copyToMatrix(q0, toBitMatrix(qPairList, false, this->N0_));
+    copyToMatrix(q1, toBitMatrix(qPairList, true, this->N1_));
+}
+
+
 template<class real>
 void DenseGraphSolver<real>::getProblemSize(SizeType *N) const {
     *N = N_;
 }
 
+template<class real>
+void SparseGraphSolver<real>::getProblemSize(SizeType *N) const {
+    *N = N_;
+}
+
 template<class real>
 void BipartiteGraphSolver<real>::getProblemSize(SizeType *N0, SizeType *N1) const {
     *N0 = N0_;
@@ -147,6 +278,101 @@ void BipartiteGraphSolver<real>::getProblemSize(SizeType *N0, SizeType *N1) cons
 }
 
 
+template<class real>
+void DenseGraphBFPartialResult<real>::merge(const DenseGraphBFPartialResult<real> &other,
+                                           SizeType maxSolutions) {
+    if (ranges.empty()) {
+        *this = other;
+        return;
+    }
+    throwErrorIf((N != other.N) || (om != other.om) || (problemHash != other.problemHash),
+                 "Partial results are not for the same problem.");
+    throwErrorIf(algo != other.algo, "Partial results are searched by different algorithms, %s and %s.",
+                 algorithmToString(algo), algorithmToString(other.algo));
+
+    /* energies of integer-valued W are compared in integers, as values of real may be rounded. */
+    bool integral = (EminInt != LLONG_MAX) || (other.EminInt != LLONG_MAX);
+    bool less = integral ? (other.EminInt < EminInt) : (other.Emin < Emin);
+    bool equal = integral ? (other.EminInt == EminInt) : (other.Emin == Emin);
+    if (less) {
+        Emin = other.Emin;
+        EminInt = other.EminInt;
+        packedXList = other.packedXList;
+    }
+    else if (equal) {
+        for (IdxType idx = 0; idx < (IdxType)other.packedXList.size(); ++idx) {
+            if (maxSolutions <= packedXList.size())
+                break;
+            packedXList.pushBack(other.packedXList[idx]);
+        }
+    }
+
+    for (IdxType idx = 0; idx < (IdxType)other.ranges.size(); ++idx)
+        ranges.pushBack(other.ranges[idx]);
+    std::sort(ranges.begin(), ranges.end(),
+              [](const PackedBitSetPair &lhs, const PackedBitSetPair &rhs) {
+                  return lhs.bits0 < rhs.bits0; });
+    PackedBitSetPairArray merged;
+    for (IdxType idx = 0; idx < (IdxType)ranges.size(); ++idx) {
+        const PackedBitSetPair &range = ranges[idx];
+        if (!merged.empty() && (range.bits0 <= merged[merged.size() - 1].bits1)) {
+            PackedBitSet &last = merged[merged.size() - 1].bits1;
+            last = std::max(last, range.bits1);
+        }
+        else {
+            merged.pushBack(range);
+        }
+    }
+    ranges = merged;
+}
+
+template<class real>
+bool DenseGraphBFPartialResult<real>::covers(PackedBitSet xMax) const {
+    return (ranges.size() == 1) && (ranges[0].bits0 == 0) && (ranges[0].bits1 == xMax);
+}
+
+template<class real>
+void DenseGraphBFPartialResult<real>::save(const char *filename) const {
+    CheckpointWriter writer(filename, ckDenseGraphBFPartialResult);
+    writer.write(int(sizeof(real)));
+    writer.write(N);
+    writer.write(int(om));
+    writer.write(int(algo));
+    writer.write(problemHash);
+    writer.write(Emin);
+    writer.write(EminInt);
+    writer.writeArray(ranges);
+    writer.writeArray(packedXList);
+    writer.commit();
+}
+
+template<class real>
+void DenseGraphBFPartialResult<real>::load(const char *filename) {
+    CheckpointReader reader(filename, ckDenseGraphBFPartialResult);
+    throwErrorIf(reader.read<int>() != (int)sizeof(real), "Precision mismatch, %s.", filename);
+    SizeType N_ = reader.read<SizeType>();
+    OptimizeMethod om_ = (OptimizeMethod)reader.read<int>();
+    Algorithm algo_ = (Algorithm)reader.read<int>();
+    unsigned long long problemHash_ = reader.read<unsigned long long>();
+    real Emin_ = reader.read<real>();
+    long long EminInt_ = reader.read<long long>();
+    PackedBitSetPairArray ranges_;
+    PackedBitSetArray packedXList_;
+    reader.readArray(&ranges_);
+    reader.readArray(&packedXList_);
+    reader.finish();
+
+    N = N_;
+    om = om_;
+    algo = algo_;
+    problemHash = problemHash_;
+    Emin = Emin_;
+    EminInt = EminInt_;
+    ranges = ranges_;
+    packedXList = packedXList_;
+}
+
+
 template<class real>
 Preferences DenseGraphBFSearcher<real>::getPreferences() const {
     Preferences prefs;
@@ -162,13 +388,37 @@ void DenseGraphBFSearcher<real>::setPreference(const Preference &pref) {
         throwErrorIf(pref.tileSize <= 0, "tileSize must be a positive integer.");
         tileSize_ = pref.tileSize;
     }
+    else if (pref.name == pnAlgorithm) {
+        this->selectAlgorithm(pref.algo);
+    }
 }
 
 
+template<class real>
+bool DenseGraphBFSearcher<real>::searchBudget(PackedBitSet budget, PackedBitSet *curXEnd) {
+    PackedBitSet xEnd = (xMax_ - x_ <= budget) ? xMax_ : x_ + budget;
+    bool completed;
+    do {
+        completed = searchRange(curXEnd);
+    } while (!completed && (x_ < xEnd));
+    return completed;
+}
+
+template<class real>
+void DenseGraphBFSearcher<real>::searchPartial(PackedBitSet xBegin, PackedBitSet xEnd,
+                                              DenseGraphBFPartialResult<real> *partial) {
+    throwErrorIf(true, "Partial search is not supported by this searcher.");
+}
+
+template<class real>
+void DenseGraphBFSearcher<real>::setPartialResult(const DenseGraphBFPartialResult<real> &partial) {
+    throwErrorIf(true, "Partial search is not supported by this searcher.");
+}
+
 template<class real>
 void DenseGraphBFSearcher<real>::search() {
     this->prepare();
-    while (!searchRange(NULL));
+    while (!searchBudget(xMax_, NULL));
     this->makeSolution();
 }
 
@@ -176,7 +426,7 @@ void DenseGraphBFSearcher<real>::search() {
 template<class real>
 Preferences BipartiteGraphBFSearcher<real>::getPreferences() const {
     Preferences prefs;
-    prefs.pushBack(Preference(pnAlgorithm, algoBruteForceSearch));
+    prefs.pushBack(Preference(pnAlgorithm, this->getAlgorithm()));
     prefs.pushBack(Preference(pnTileSize0, tileSize0_));
     prefs.pushBack(Preference(pnTileSize1, tileSize1_));
     return prefs;
@@ -192,6 +442,9 @@ void BipartiteGraphBFSearcher<real>::setPreference(const Preference &pref) {
         throwErrorIf(pref.tileSize <= 0, "tileSize1 must be a positive integer.");
         tileSize1_ = pref.tileSize;
     }
+    if (pref.name == pnAlgorithm) {
+        this->selectAlgorithm(pref.algo);
+    }
 }
 
 template<class real>
@@ -209,15 +462,23 @@ template struct sqaod::BFSearcher<double>;
 template struct sqaod::BFSearcher<float>;
 template struct sqaod::Annealer<double>;
 template struct sqaod::Annealer<float>;
+template struct sqaod::AnnealSchedule<double>;
+template struct sqaod::AnnealSchedule<float>;
 template struct sqaod::DenseGraphSolver<double>;
 template struct sqaod::DenseGraphSolver<float>;
 template struct sqaod::BipartiteGraphSolver<double>;
 template struct sqaod::BipartiteGraphSolver<float>;
+template struct sqaod::SparseGraphSolver<double>;
+template struct sqaod::SparseGraphSolver<float>;
 
+template struct sqaod::DenseGraphBFPartialResult<double>;
+template struct sqaod::DenseGraphBFPartialResult<float>;
 template struct sqaod::DenseGraphBFSearcher<double>;
 template struct sqaod::DenseGraphBFSearcher<float>;
 template struct sqaod::DenseGraphAnnealer<double>;
 template struct sqaod::DenseGraphAnnealer<float>;
+template struct sqaod::SparseGraphAnnealer<double>;
+template struct sqaod::SparseGraphAnnealer<float>;
 template struct sqaod::BipartiteGraphBFSearcher<double>;
 template struct sqaod::BipartiteGraphBFSearcher<float>;
 template struct sqaod::BipartiteGraphAnnealer<double>;
@@ -2,6 +2,7 @@
 
 #include <sqaodc/common/Matrix.h>
 #include <sqaodc/common/Preference.h>
+#include <limits.h>
 
 namespace sqaod {
 
@@ -85,16 +86,47 @@ struct BFSearcher : Solver<real> {
 
     virtual void search() = 0;
 
+    /* saves the progress of a search, called between searchRange() calls. */
+    virtual void saveCheckpoint(const char *filename) const;
+
+    /* restores a saved progress.  The same problem should be given by setQUBO(). */
+    virtual void resumeFromCheckpoint(const char *filename);
+
 protected:
     BFSearcher() { }
 
 };
 
 
+/* annealing schedule, pairs of (G[step], beta[step]) applied in the order of steps. */
+template<class real>
+struct AnnealSchedule {
+    AnnealSchedule() { }
+
+    AnnealSchedule(const VectorType<real> &_G, const VectorType<real> &_beta);
+
+    /* G = Ginit * tau^step while Gfin < G, beta is constant. */
+    static AnnealSchedule geometric(real Ginit, real Gfin, real tau, real beta);
+
+    /* nSteps of G linearly changing from Ginit to Gfin, beta is constant. */
+    static AnnealSchedule linear(real Ginit, real Gfin, SizeType nSteps, real beta);
+
+    SizeType size() const {
+        return G.size;
+    }
+
+    VectorType<real> G;
+    VectorType<real> beta;
+};
+
+
 template<class real>
 struct Annealer : Solver<real> {
     virtual ~Annealer() { }
 
+    /* called every interval steps in anneal(), annealing stops if false is returned. */
+    typedef bool (*AnnealCallback)(void *userData, IdxType step, real G, real beta);
+
     virtual Preferences getPreferences() const;
 
     virtual void setPreference(const Preference &pref);
@@ -107,6 +139,11 @@ struct Annealer : Solver<real> {
     
     virtual void annealOneStep(real G, real beta) = 0;
 
+    /* runs annealOneStep() for all steps in a schedule.  prepare() and randomizeSpin()
+     * should be called before, and makeSolution() after. */
+    void anneal(const AnnealSchedule<real> &schedule,
+                AnnealCallback callback = NULL, void *userData = NULL, SizeType interval = 1);
+
 protected:
     Annealer() : m_(0) { }
 
@@ -152,6 +189,57 @@ protected:
 
 
 
+template<class real>
+struct SparseGraphSolver {
+    virtual ~SparseGraphSolver() { }
+
+    void getProblemSize(SizeType *N) const;
+
+    /* W is a symmetric N x N matrix in the CSR format. */
+    virtual void setQUBO(const SparseMatrixType<real> &W,
+                         OptimizeMethod om = sqaod::optMinimize) = 0;
+
+    virtual const BitSetArray &get_x() const = 0;
+
+protected:
+    SparseGraphSolver() : N_(0) { }
+
+    SizeType N_;
+};
+
+
+
+/* result of a dense graph search over sub-ranges of the search space.  Results of
+ * sub-ranges searched in separate processes are combined by merge(). */
+template<class real>
+struct DenseGraphBFPartialResult {
+    DenseGraphBFPartialResult()
+            : N(0), om(optMinimize), algo(algoDefault), problemHash(0),
+              Emin(real(0.)), EminInt(LLONG_MAX) { }
+
+    /* merges in the same manner as searchers merge results of threads. */
+    void merge(const DenseGraphBFPartialResult<real> &other, SizeType maxSolutions);
+
+    /* true if searched ranges cover [0, xMax). */
+    bool covers(PackedBitSet xMax) const;
+
+    void save(const char *filename) const;
+
+    void load(const char *filename);
+
+    SizeType N;
+    OptimizeMethod om;
+    /* ranges are in the enumeration order of algo, x for brute_force_search and
+     * i of gray(i) for gray_code. */
+    Algorithm algo;
+    unsigned long long problemHash;
+    real Emin; /* energy of the minimization problem, negated if om == optMaximize. */
+    long long EminInt; /* exact Emin for integer-valued W, otherwise LLONG_MAX. */
+    PackedBitSetPairArray ranges; /* searched ranges, [bits0, bits1), sorted and merged. */
+    PackedBitSetArray packedXList;
+};
+
+
 template<class real>
 struct DenseGraphBFSearcher
         : BFSearcher<real>, DenseGraphSolver<real> {
@@ -165,6 +253,18 @@ struct DenseGraphBFSearcher
 
     virtual bool searchRange(sqaod::PackedBitSet *curXEnd) = 0;
 
+    /* searches at least budget candidates from the current position in one call, or
+     * until the end of the search space.  Returns true if the search is completed. */
+    virtual bool searchBudget(sqaod::PackedBitSet budget, sqaod::PackedBitSet *curXEnd);
+
+    /* searches [xBegin, xEnd) from scratch, and stores the result to partial.
+     * Ranges are in the enumeration order of the selected algorithm. */
+    virtual void searchPartial(PackedBitSet xBegin, PackedBitSet xEnd,
+                               DenseGraphBFPartialResult<real> *partial);
+
+    /* sets merged partial results, solutions are given by makeSolution(). */
+    virtual void setPartialResult(const DenseGraphBFPartialResult<real> &partial);
+
     virtual void search();
 
 protected:
@@ -188,13 +288,48 @@ struct DenseGraphAnnealer
     
     virtual void set_x(const BitSet &x) = 0;
 
+    using DenseGraphSolver<real>::get_x;
+
+    /* x of all trotters in an m x N matrix, copied by a single call. */
+    virtual void get_x(BitMatrix *x) const;
+
     virtual const BitSetArray &get_q() const = 0;
 
+    /* q of all trotters in an m x N matrix. */
+    virtual void get_q(BitMatrix *q) const;
+
 protected:
     DenseGraphAnnealer() { }
 };
     
 
+template<class real>
+struct SparseGraphAnnealer
+        : Annealer<real>, SparseGraphSolver<real> {
+    virtual ~SparseGraphAnnealer() { }
+
+    virtual void setHamiltonian(const VectorType<real> &h, const SparseMatrixType<real> &J,
+                                real c = real(0.)) = 0;
+
+    virtual void getHamiltonian(VectorType<real> *h, SparseMatrixType<real> *J, real *c) const = 0;
+
+    virtual void set_x(const BitSet &x) = 0;
+
+    using SparseGraphSolver<real>::get_x;
+
+    /* x of all trotters in an m x N matrix, copied by a single call. */
+    virtual void get_x(BitMatrix *x) const;
+
+    virtual const BitSetArray &get_q() const = 0;
+
+    /* q of all trotters in an m x N matrix. */
+    virtual void get_q(BitMatrix *q) const;
+
+protected:
+    SparseGraphAnnealer() { }
+};
+
+
 template<class real>
 struct BipartiteGraphBFSearcher
         : BFSearcher<real>, BipartiteGraphSolver<real> {
@@ -233,8 +368,16 @@ struct BipartiteGraphAnnealer
 
     virtual void set_x(const BitSet &x0, const BitSet &x1) = 0;
 
+    using BipartiteGraphSolver<real>::get_x;
+
+    /* x0 and x1 of all trotters in m x N0 and m x N1 matrices, copied by a single call. */
+    virtual void get_x(BitMatrix *x0, BitMatrix *x1) const;
+
     virtual const BitSetPairArray &get_q() const = 0;
 
+    /* q0 and q1 of all trotters in m x N0 and m x N1 matrices. */
+    virtual void get_q(BitMatrix *q0, BitMatrix *q1) const;
+
 protected:
     BipartiteGraphAnnealer() { }
 };
@@ -34,7 +34,7 @@ V sum(const V *values, SizeType size) {
 }
 
 template<class V> inline
-V min(V *values, SizeType size) {
+V min(const V *values, SizeType size) {
     V v = std::numeric_limits<V>::max();
     for (IdxType idx = 0; idx < (IdxType)size; ++idx)
         v = std::min(v, values[idx]);
@@ -0,0 +1,130 @@
+#include "CPUAcceptance.h"
+#include <algorithm>
+
+using namespace sqaod_cpu;
+
+enum {
+    maxTableSize = 1 << 16,
+};
+
+
+template<class real>
+CPUAcceptance<real>::CPUAcceptance() {
+    method_ = sq::acceptDefault;
+    activeMethod_ = sq::acceptDefault;
+    twoDivM_ = coef_ = beta_ = real(0.);
+    clearLocalFieldRange();
+}
+
+template<class real>
+void CPUAcceptance<real>::setMethod(sq::AcceptanceMethod method) {
+    throwErrorIf(method == sq::acceptUnknown, "Unknown acceptance method.");
+    method_ = method;
+    tableValid_ = false;
+    fallbackLogged_ = false;
+}
+
+template<class real>
+void CPUAcceptance<real>::clearLocalFieldRange() {
+    fieldIsInteger_ = true;
+    fieldScale_ = real(1.);
+    maxAbsField_ = real(0.);
+    tableValid_ = false;
+    fallbackLogged_ = false;
+}
+
+template<class real>
+void CPUAcceptance<real>::addLocalFieldRange(const EigenRowVector &h, const EigenMatrix &J) {
+    /* find a power-of-2 factor to make h and J integer-valued. */
+    if (fieldIsInteger_) {
+        real scale = real(0.);
+        for (real mul = real(1.); mul <= real(16.); mul *= real(2.)) {
+            if (((h * mul).array() == (h * mul).array().round()).all() &&
+                ((J * mul).array() == (J * mul).array().round()).all()) {
+                scale = mul;
+                break;
+            }
+        }
+        if (scale == real(0.))
+            fieldIsInteger_ = false;
+        else
+            fieldScale_ = std::max(fieldScale_, scale);
+    }
+    real maxAbs = (h.cwiseAbs().transpose() + J.cwiseAbs().rowwise().sum()).maxCoeff();
+    maxAbsField_ = std::max(maxAbsField_, maxAbs);
+    tableValid_ = false;
+}
+
+template<class real>
+void CPUAcceptance<real>::addLocalFieldRange(const EigenRowVector &h,
+                                             const sq::SparseMatrixType<real> &J) {
+    typedef Eigen::Map<const EigenRowVector> EigenConstMappedRowVector;
+    EigenConstMappedRowVector values(J.values.data, J.nnz());
+    if (fieldIsInteger_) {
+        real scale = real(0.);
+        for (real mul = real(1.); mul <= real(16.); mul *= real(2.)) {
+            if (((h * mul).array() == (h * mul).array().round()).all() &&
+                ((values * mul).array() == (values * mul).array().round()).all()) {
+                scale = mul;
+                break;
+            }
+        }
+        if (scale == real(0.))
+            fieldIsInteger_ = false;
+        else
+            fieldScale_ = std::max(fieldScale_, scale);
+    }
+    real maxAbs = real(0.);
+    for (sq::IdxType row = 0; row < J.rows; ++row) {
+        sq::IdxType begin = J.rowPtr(row), end = J.rowPtr(row + 1);
+        real rowAbs = std::abs(h(row)) + values.segment(begin, end - begin).cwiseAbs().sum();
+        maxAbs = std::max(maxAbs, rowAbs);
+    }
+    maxAbsField_ = std::max(maxAbsField_, maxAbs);
+    tableValid_ = false;
+}
+
+template<class real>
+void CPUAcceptance<real>::prepare(real twoDivM, real coef, real beta) {
+    if ((twoDivM != twoDivM_) || (coef != coef_) || (beta != beta_))
+        tableValid_ = false;
+    twoDivM_ = twoDivM;
+    coef_ = coef;
+    beta_ = beta;
+
+    activeMethod_ = method_;
+    if (method_ == sq::acceptTable) {
+        if (!tableValid_)
+            updateTable();
+        if (!tableValid_)
+            activeMethod_ = sq::acceptDefault;
+    }
+}
+
+template<class real>
+void CPUAcceptance<real>::updateTable() {
+    double kMax = std::ceil(double(maxAbsField_) * fieldScale_);
+    if (!fieldIsInteger_ || (maxTableSize < 3 * (2 * kMax + 1))) {
+        if (!fallbackLogged_)
+            sq::log("Hamiltonian is not integer-valued or too large for acceptance table, "
+                    "exp() is used.");
+        fallbackLogged_ = true;
+        return;
+    }
+    tableOffset_ = (int)kMax;
+    tableStride_ = 2 * tableOffset_ + 1;
+    table_.resize(3 * tableStride_);
+    for (int l = 0; l < 3; ++l) {
+        double qNeibour = 2. * (l - 1);
+        for (int k = - tableOffset_; k <= tableOffset_; ++k) {
+            double dE = double(twoDivM_) * (k / double(fieldScale_)) - qNeibour * double(coef_);
+            double threshold = (dE < 0.) ? 1. : std::exp(-dE * double(beta_));
+            table_(l * tableStride_ + k + tableOffset_) = real(threshold);
+        }
+    }
+    tableValid_ = true;
+}
+
+
+template class CPUAcceptance<float>;
+template class CPUAcceptance<double>;
@@ -0,0 +1,124 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Common.h>
+#include <sqaodc/common/EigenBridge.h>
+#include <cmath>
+#include <string.h>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* exp(x) for x <= 0, by a polynomial on x - n log(2), |x - n log(2)| <= log(2) / 2.
+ * Relative error is below 2e-7, and exp(x) for x < -87 is flushed to 0. */
+
+template<class real> inline
+real fastExp(real x);
+
+template<> inline
+float fastExp<float>(float x) {
+    if (x < -87.f)
+        return 0.f;
+    int n = int(x * 1.44269504088896341f - 0.5f); /* round, x <= 0 */
+    float r = x - float(n) * 0.693147180559945309f;
+    float p = 1.f + r * (1.f + r * (0.5f + r * (1.f / 6.f + r * (1.f / 24.f + r * (1.f / 120.f + r * (1.f / 720.f))))));
+    unsigned int bits = (unsigned int)(n + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+template<> inline
+double fastExp<double>(double x) {
+    if (x < -87.)
+        return 0.;
+    int n = int(x * 1.44269504088896341 - 0.5); /* round, x <= 0 */
+    double r = x - double(n) * 0.693147180559945309;
+    double p = 1. + r * (1. + r * (0.5 + r * (1. / 6. + r * (1. / 24. + r * (1. / 120. + r * (1. / 720.))))));
+    unsigned long long bits = (unsigned long long)(n + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+
+/* Acceptance test of Metropolis flips.
+ *
+ * A flip of q(y, x) is accepted with probability min(1, exp(-dE beta)), where
+ *   dE = twoDivM * qField - qNeibour * coef,
+ *   qField = q(y, x) (h(x) + sum_j J(x, j) q(y, j)),
+ *   qNeibour = q(y, x) (q(y - 1, x) + q(y + 1, x)), -2, 0 or 2.
+ *
+ * acceptTable is available when the local field, h + J q, takes values on integers
+ * scaled by a power-of-2 factor.  Otherwise the default method is used. */
+
+template<class real>
+class CPUAcceptance {
+    typedef sq::EigenMatrixType<real> EigenMatrix;
+    typedef sq::EigenRowVectorType<real> EigenRowVector;
+public:
+    CPUAcceptance();
+
+    void setMethod(sq::AcceptanceMethod method);
+
+    sq::AcceptanceMethod getMethod() const {
+        return method_;
+    }
+
+    /* range of local fields, J(x, j) is the coupling of the spin x and h(x) is its bias. */
+    void clearLocalFieldRange();
+
+    void addLocalFieldRange(const EigenRowVector &h, const EigenMatrix &J);
+
+    void addLocalFieldRange(const EigenRowVector &h, const sq::SparseMatrixType<real> &J);
+
+    /* called at the beginning of each annealing step. */
+    void prepare(real twoDivM, real coef, real beta);
+
+    bool accept(real qField, real qNeibour, real u) const {
+        switch (activeMethod_) {
+        case sq::acceptLogUniform: {
+            real dE = twoDivM_ * qField - qNeibour * coef_;
+            return dE * beta_ < - std::log(u);
+        }
+        case sq::acceptTable: {
+            int k = int(qField * fieldScale_ + real(tableOffset_ + 0.5));
+            int l = int(qNeibour) / 2 + 1;
+            return table_(l * tableStride_ + k) > u;
+        }
+        case sq::acceptFastExp: {
+            real dE = twoDivM_ * qField - qNeibour * coef_;
+            real threshold = (dE < real(0.)) ? real(1.) : fastExp(-dE * beta_);
+            return threshold > u;
+        }
+        case sq::acceptDefault:
+        default: {
+            real dE = twoDivM_ * qField - qNeibour * coef_;
+            real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE * beta_);
+            return threshold > u;
+        }
+        }
+    }
+
+private:
+    void updateTable();
+
+    sq::AcceptanceMethod method_;
+    sq::AcceptanceMethod activeMethod_;
+    real twoDivM_, coef_, beta_;
+
+    /* local field range */
+    bool fieldIsInteger_;
+    real fieldScale_;  /* local field x fieldScale_ is integer-valued. */
+    real maxAbsField_;
+
+    /* table of min(1, exp(-dE beta)) for 3 values of qNeibour and integer fields */
+    EigenRowVector table_;
+    int tableOffset_;
+    int tableStride_;
+    bool tableValid_;
+    bool fallbackLogged_;
+};
+
+}
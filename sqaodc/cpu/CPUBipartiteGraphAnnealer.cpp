@@ -5,34 +5,56 @@
 #include <algorithm>
 #include <exception>
 #include "CPUFormulas.h"
+#include "CPUMetropolisSweep.h"
 #include <time.h>
+#include <vector>
 
 namespace sqint = sqaod_internal;
 using namespace sqaod_cpu;
 
+enum {
+    /* dEmat is recalculated by GEMMs every dEmatResyncInterval steps. */
+    dEmatResyncInterval = 64,
+    /* a row of dEmat is recalculated if more than 1 / rankUpdateRatio of spins flipped. */
+    rankUpdateRatio = 8,
+};
+
 template<class real>
 CPUBipartiteGraphAnnealer<real>::CPUBipartiteGraphAnnealer() {
     m_ = -1;
+    bitSetsValid_ = false;
     annealMethod_ = &CPUBipartiteGraphAnnealer::annealOneStepColoring;
+    seed_ = 0;
+    counterBased_ = false;
+    step_ = 0;
+    dEmatValid_ = false;
+    nIncrementalSteps_ = 0;
 #ifdef _OPENMP
     nMaxThreads_ = omp_get_max_threads();
     sq::log("# max threads: %d", nMaxThreads_);
 #else
     nMaxThreads_ = 1;
 #endif
-    random_ = new sq::Random[nMaxThreads_];
+    random_ = new CPURandom[nMaxThreads_];
+    arenas_ = new CPUScratchArena[nMaxThreads_];
 }
 
 template<class real>
 CPUBipartiteGraphAnnealer<real>::~CPUBipartiteGraphAnnealer() {
     delete [] random_;
+    delete [] arenas_;
 }
 
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::seed(unsigned long long seed) {
-    for (int idx = 0; idx < nMaxThreads_; ++idx)
-        random_[idx].seed(seed + 17 * idx);
+    seed_ = seed;
+    /* threads share the seed in the counter-based mode. */
+    for (int idx = 0; idx < nMaxThreads_; ++idx) {
+        random_[idx].seed(counterBased_ ? seed : seed + 17 * idx);
+        random_[idx].setCounterBased(counterBased_);
+    }
+    step_ = 0;
     setState(solRandSeedGiven);
 }
 
@@ -89,6 +111,9 @@ void CPUBipartiteGraphAnnealer<real>::setQUBO(const Vector &b0, const Vector &b1
         J_ *= real(-1.);
         c_ *= real(-1.);
     }
+    JT_ = J_.transpose();
+    dEmatValid_ = false;
+    updateLocalFieldRange();
     setState(solProblemSet);
 }
 
@@ -105,13 +130,41 @@ setHamiltonian(const Vector &h0, const Vector &h1, const Matrix &J, real c) {
     h1_ = sq::mapToRowVector(h1);
     J_ = sq::mapTo(J);
     om_ = sq::optMinimize;
+    JT_ = J_.transpose();
+    dEmatValid_ = false;
+    updateLocalFieldRange();
     setState(solProblemSet);
 }
 
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::updateLocalFieldRange() {
+    acceptance_.clearLocalFieldRange();
+    acceptance_.addLocalFieldRange(h1_, J_);
+    acceptance_.addLocalFieldRange(h0_, J_.transpose());
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::setPreference(const sq::Preference &pref) {
+    if (pref.name == sq::pnAcceptance) {
+        acceptance_.setMethod(pref.acceptance);
+    }
+    else if (pref.name == sq::pnRandom) {
+        throwErrorIf(pref.rng == sq::rngUnknown, "Unknown random number generator.");
+        counterBased_ = (pref.rng == sq::rngCounterBased);
+        if (isRandSeedGiven())
+            seed(seed_);
+    }
+    else {
+        Base::setPreference(pref);
+    }
+}
+
 template<class real>
 sq::Preferences CPUBipartiteGraphAnnealer<real>::getPreferences() const {
     sq::Preferences prefs = Base::getPreferences();
     prefs.pushBack(sq::Preference(sq::pnDevice, "cpu"));
+    prefs.pushBack(sq::Preference(sq::pnRandom, counterBased_ ? sq::rngCounterBased : sq::rngDefault));
+    prefs.pushBack(sq::Preference(sq::pnAcceptance, acceptance_.getMethod()));
     return prefs;
 }
 
@@ -119,9 +172,18 @@ template<class real>
 const sq::BitSetPairArray &CPUBipartiteGraphAnnealer<real>::get_x() const {
     if (!isSolutionAvailable())
         const_cast<This*>(this)->makeSolution();
+    const_cast<This*>(this)->syncBitSets();
     return bitsPairX_;
 }
 
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::get_x(sq::BitMatrix *x0, sq::BitMatrix *x1) const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    sq::copyToMatrix(x0, bitsX0_);
+    sq::copyToMatrix(x1, bitsX1_);
+}
+
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::set_x(const sq::BitSet &x0, const sq::BitSet &x1) {
     sqint::isingModelShapeCheck(sq::mapFrom(h0_), sq::mapFrom(h1_), sq::mapFrom(J_), c_,
@@ -133,8 +195,9 @@ void CPUBipartiteGraphAnnealer<real>::set_x(const sq::BitSet &x0, const sq::BitS
                  "Dimension of x1, %d,  should be equal to N1, %d.", x1.size, N1_);
     EigenRowVector ex0 = mapToRowVector(x0).cast<real>();
     EigenRowVector ex1 = mapToRowVector(x1).cast<real>();
-    matQ0_ = (ex0.array() * 2 - 1).matrix();
-    matQ1_ = (ex1.array() * 2 - 1).matrix();
+    matQ0_.rowwise() = (ex0.array() * 2 - 1).matrix();
+    matQ1_.rowwise() = (ex1.array() * 2 - 1).matrix();
+    dEmatValid_ = false;
 
     clearState(solSolutionAvailable);
     setState(solQSet);
@@ -164,32 +227,41 @@ template<class real>
 const sq::BitSetPairArray &CPUBipartiteGraphAnnealer<real>::get_q() const {
     if (!isSolutionAvailable())
         const_cast<This*>(this)->makeSolution();
+    const_cast<This*>(this)->syncBitSets();
     return bitsPairQ_;
 }
 
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::get_q(sq::BitMatrix *q0, sq::BitMatrix *q1) const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    sq::copyToMatrix(q0, bitsQ0_);
+    sq::copyToMatrix(q1, bitsQ1_);
+}
+
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::randomizeSpin() {
     throwErrorIfNotPrepared();
 #ifndef _OPENMP
     {
-        sq::Random &random = random_[0];
-        real *q = matQ0_.data();
+        CPURandom &random = random_[0];
 #else
 #pragma omp parallel
     {
-        sq::Random &random = random_[omp_get_thread_num()];
-        real *q = matQ0_.data();
+        CPURandom &random = random_[omp_get_thread_num()];
 #pragma omp for
 #endif
-        for (int idx = 0; idx < sq::IdxType(N0_ * m_); ++idx)
-            q[idx] = random.randInt(2) ? real(1.) : real(-1.);
-        q = matQ1_.data();
-#ifdef _OPENMP
-#pragma omp for 
-#endif
-        for (int idx = 0; idx < sq::IdxType(N1_ * m_); ++idx)
-            q[idx] = random.randInt(2) ? real(1.) : real(-1.);
+        for (int im = 0; im < m_; ++im) {
+            random.seek(step_, im, 0);
+            for (int ix = 0; ix < N0_; ++ix)
+                matQ0_(im, ix) = random.randInt(2) ? real(1.) : real(-1.);
+            random.seek(step_, im, 1);
+            for (int ix = 0; ix < N1_; ++ix)
+                matQ1_(im, ix) = random.randInt(2) ? real(1.) : real(-1.);
+        }
     }
+    ++step_;
+    dEmatValid_ = false;
     setState(solQSet);
 }
 
@@ -211,6 +283,7 @@ void CPUBipartiteGraphAnnealer<real>::prepare() {
 
     matQ0_.resize(m_, N0_);
     matQ1_.resize(m_, N1_);
+    dEmatValid_ = false;
     E_.resize(m_);
 
     setState(solPrepared);
@@ -231,7 +304,9 @@ void CPUBipartiteGraphAnnealer<real>::annealOneStepNaive(real G, real beta) {
     
     real twoDivM = real(2.) / real(m_);
     real coef = std::log(std::tanh(G * beta / m_)) * beta;
-    sq::Random &random = random_[0];
+    acceptance_.prepare(twoDivM, coef, beta);
+    CPURandom &random = random_[0];
+    random.seek(step_, 0, 0);
     int N = N0_ + N1_;
     for (int loop = 0; loop < sq::IdxType(N * m_); ++loop) {
         int x = random.randInt(N);
@@ -239,27 +314,25 @@ void CPUBipartiteGraphAnnealer<real>::annealOneStepNaive(real G, real beta) {
         if (x < N0_) {
             real qyx = matQ0_(y, x);
             real sum = J_.transpose().row(x).dot(matQ1_.row(y));
-            real dE = twoDivM * qyx * (h0_(x) + sum);
             int neibour0 = (y == 0) ? m_ - 1 : y - 1;
             int neibour1 = (y == m_ - 1) ? 0 : y + 1;
-            dE -= qyx * (matQ0_(neibour0, x) + matQ0_(neibour1, x)) * coef;
-            real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE * beta);
-            if (threshold > random.random<real>())
+            real qNeibour = qyx * (matQ0_(neibour0, x) + matQ0_(neibour1, x));
+            if (acceptance_.accept(qyx * (h0_(x) + sum), qNeibour, random.random<real>()))
                 matQ0_(y, x) = - qyx;
         }
         else {
             x -= N0_;
             real qyx = matQ1_(y, x);
             real sum = J_.row(x).dot(matQ0_.row(y));
-            real dE = twoDivM * qyx * (h1_(x) + sum);
             int neibour0 = (y == 0) ? m_ - 1 : y - 1;
             int neibour1 = (y == m_ - 1) ? 0 : y + 1;
-            dE -= qyx * (matQ1_(neibour0, x) + matQ1_(neibour1, x)) * coef;
-            real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE * beta);
-            if (threshold > random.random<real>())
+            real qNeibour = qyx * (matQ1_(neibour0, x) + matQ1_(neibour1, x));
+            if (acceptance_.accept(qyx * (h1_(x) + sum), qNeibour, random.random<real>()))
                 matQ1_(y, x) = - qyx;
         }
     }
+    ++step_;
+    dEmatValid_ = false;
     clearState(solSolutionAvailable);
 }
 
@@ -267,85 +340,187 @@ template<class real>
 void CPUBipartiteGraphAnnealer<real>::annealOneStepColoring(real G, real beta) {
     throwErrorIfQNotSet();
 
-    annealHalfStepColoring(N1_, matQ1_, h1_, J_, matQ0_, G, beta);
-    annealHalfStepColoring(N0_, matQ0_, h0_, J_.transpose(), matQ1_, G, beta);
+    if (!dEmatValid_ || (dEmatResyncInterval <= nIncrementalSteps_))
+        updateDEmat();
+    annealHalfStepColoring(N1_, matQ1_, h1_, dEmat1_, dEmat0_, J_, G, beta);
+    annealHalfStepColoring(N0_, matQ0_, h0_, dEmat0_, dEmat1_, JT_, G, beta);
+    ++nIncrementalSteps_;
 }
 
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::getDEmat(Matrix *dEmat0, Matrix *dEmat1) const {
+    throwErrorIf(!dEmatValid_, "dEmat is not calculated.");
+    dEmat0->resize(m_, N0_);
+    dEmat1->resize(m_, N1_);
+    mapTo(*dEmat0) = dEmat0_;
+    mapTo(*dEmat1) = dEmat1_;
+}
 
-template<class real, class T> static inline
-void tryFlip(sq::EigenMatrixType<real> &qAnneal, int im, const sq::EigenMatrixType<real> &dEmat, const sq::EigenRowVectorType<real> &h, const T &J, sq::SizeType N, sq::SizeType m, 
-             real twoDivM, real beta, real coef, sq::Random &random) {
-    for (int iq = 0; iq < N; ++iq) {
+
+/* dEmat0_ = q1 J, dEmat1_ = q0 J^T, calculated by GEMMs.
+ * They're updated by flips in annealHalfStepColoring(), and recalculated every
+ * dEmatResyncInterval steps not to accumulate rounding errors. */
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::updateDEmat() {
+    dEmat0_.resize(m_, N0_);
+    dEmat1_.resize(m_, N1_);
+#ifndef _OPENMP
+    dEmat0_.noalias() = matQ1_ * J_;
+    dEmat1_.noalias() = matQ0_ * JT_;
+#else
+#pragma omp parallel
+    {
+        int threadNum = omp_get_thread_num();
+        int qRowSpan = (m_ + nMaxThreads_ - 1) / nMaxThreads_;
+        int qRowBegin = std::min(m_, qRowSpan * threadNum);
+        int qRowEnd = std::min(m_, qRowSpan * (threadNum + 1));
+        qRowSpan = qRowEnd - qRowBegin;
+        if (0 < qRowSpan) {
+            dEmat0_.block(qRowBegin, 0, qRowSpan, N0_).noalias() = matQ1_.middleRows(qRowBegin, qRowSpan) * J_;
+            dEmat1_.block(qRowBegin, 0, qRowSpan, N1_).noalias() = matQ0_.middleRows(qRowBegin, qRowSpan) * JT_;
+        }
+    }
+#endif
+    dEmatValid_ = true;
+    nIncrementalSteps_ = 0;
+}
+
+
+/* flips in a row are independent of each other given dEmat, and swept by SIMD kernels.
+ * Each half step consumes one step of the counter-based random stream.
+ * SIMD kernels evaluate exp() by vectorized polynomials.  Other acceptance methods
+ * given by preference are evaluated by CPUAcceptance spin by spin. */
+template<class real> static inline
+void tryFlip(sq::EigenMatrixType<real> &qAnneal, int im, const sq::EigenMatrixType<real> &dEmat, const sq::EigenRowVectorType<real> &h, sq::SizeType N, sq::SizeType m, 
+             real twoDivM, real beta, real coef, const CPUAcceptance<real> &acceptance,
+             CPURandom &random, real *rand) {
+    random.fill(rand, N);
+    int mNeibour0 = (im + m - 1) % m;
+    int mNeibour1 = (im + 1) % m;
+    if (acceptance.getMethod() == sq::acceptDefault) {
+        metropolisSweep(&qAnneal(im, 0), &qAnneal(mNeibour0, 0), &qAnneal(mNeibour1, 0),
+                        h.data(), &dEmat(im, 0), rand, N, twoDivM, coef, beta);
+        return;
+    }
+    for (int iq = 0; iq < (int)N; ++iq) {
         real q = qAnneal(im, iq);
-        real dE = twoDivM * q * (h[iq] + dEmat(im, iq));
-        int mNeibour0 = (im + m - 1) % m;
-        int mNeibour1 = (im + 1) % m;
-        dE -= q * (qAnneal(mNeibour0, iq) + qAnneal(mNeibour1, iq)) * coef;
-        real thresh = dE < real(0.) ? real(1.) : std::exp(- dE * beta);
-        if (thresh > random.random<real>())
-            qAnneal(im, iq) = -q;
+        real qNeibour = q * (qAnneal(mNeibour0, iq) + qAnneal(mNeibour1, iq));
+        if (acceptance.accept(q * (h(iq) + dEmat(im, iq)), qNeibour, rand[iq]))
+            qAnneal(im, iq) = - q;
+    }
+}
+
+/* Flips in qAnneal(im, :) are applied to dEmatOther(im, :) as a rank-k update by
+ * rows of Jrows, or the row is recalculated by GEMV if many spins flipped. */
+template<class real> static inline
+void updateDEmatRow(sq::EigenMatrixType<real> &dEmatOther, int im,
+                    const sq::EigenMatrixType<real> &qAnneal, const real *qPrev,
+                    const sq::EigenMatrixType<real> &Jrows, int *flipped) {
+    int N = qAnneal.cols();
+    int nFlipped = 0;
+    for (int iq = 0; iq < N; ++iq) {
+        if (qAnneal(im, iq) != qPrev[iq])
+            flipped[nFlipped++] = iq;
+    }
+    if (N < nFlipped * rankUpdateRatio) {
+        dEmatOther.row(im).noalias() = qAnneal.row(im) * Jrows;
+    }
+    else {
+        for (int idx = 0; idx < nFlipped; ++idx) {
+            int iq = flipped[idx];
+            /* q changed by 2 q(im, iq) */
+            dEmatOther.row(im) += (real(2.) * qAnneal(im, iq)) * Jrows.row(iq);
+        }
     }
 }
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::
-annealHalfStepColoring(int N, EigenMatrix &qAnneal,
-                       const EigenRowVector &h, const EigenMatrix &J,
-                       const EigenMatrix &qFixed, real G, real beta) {
+annealHalfStepColoring(int N, EigenMatrix &qAnneal, const EigenRowVector &h,
+                       const EigenMatrix &dEmat, EigenMatrix &dEmatOther, const EigenMatrix &Jrows,
+                       real G, real beta) {
     real twoDivM = real(2.) / m_;
     real coef = std::log(std::tanh(G * beta / m_)) * beta;
     int m2 = (m_ / 2) * 2; /* round down */
+    acceptance_.prepare(twoDivM, coef, beta);
 
 #ifndef _OPENMP
-    EigenMatrix dEmat = qFixed * J.transpose();
-    sq::Random &random = random_[0];
+    CPURandom &random = random_[0];
+    CPUScratchArena &arena = arenas_[0];
+    arena.reset();
+    real *rand = arena.allocate<real>(N);
+    EigenScratchRowVectorType<real> qPrev = arena.eigenRowVector<real>(N);
+    int *flipped = arena.allocate<int>(N);
     for (int offset = 0; offset < 2; ++offset) {
-        for (int im = offset; im < m_; im += 2)
-            tryFlip(qAnneal, im, dEmat, h, J, N, m_, twoDivM, beta, coef, random);
+        for (int im = offset; im < m_; im += 2) {
+            random.seek(step_, im, 0);
+            qPrev = qAnneal.row(im);
+            tryFlip(qAnneal, im, dEmat, h, N, m_, twoDivM, beta, coef, acceptance_, random, rand);
+            updateDEmatRow(dEmatOther, im, qAnneal, qPrev.data(), Jrows, flipped);
+        }
     }
 #else
-    EigenMatrix dEmat(qFixed.rows(), J.rows());
-    // dEmat = qFixed * J.transpose();  // For debug
 #pragma omp parallel
     {
-        int threadNum = omp_get_thread_num();
-        int qRowSpan = (qFixed.rows() + nMaxThreads_ - 1) / nMaxThreads_;
-        int qRowBegin = std::min(J.rows(), qRowSpan * threadNum);
-        int qRowEnd = std::min(qFixed.rows(), qRowSpan * (threadNum + 1));
-        qRowSpan = qRowEnd - qRowBegin;
-        if (0 < qRowSpan)
-            dEmat.block(qRowBegin, 0, qRowSpan, J.rows()) = qFixed.block(qRowBegin, 0, qRowSpan, qFixed.cols()) * J.transpose();
-#  pragma omp barrier
-        sq::Random &random = random_[threadNum];
+        CPURandom &random = random_[omp_get_thread_num()];
+        CPUScratchArena &arena = arenas_[omp_get_thread_num()];
+        arena.reset();
+        real *rand = arena.allocate<real>(N);
+        EigenScratchRowVectorType<real> qPrev = arena.eigenRowVector<real>(N);
+        int *flipped = arena.allocate<int>(N);
         for (int offset = 0; offset < 2; ++offset) {
 #  pragma omp for
             for (int im = offset; im < m2; im += 2) {
-                tryFlip(qAnneal, im, dEmat, h, J, N, m_, twoDivM, beta, coef, random);
+                random.seek(step_, im, 0);
+                qPrev = qAnneal.row(im);
+                tryFlip(qAnneal, im, dEmat, h, N, m_, twoDivM, beta, coef, acceptance_, random, rand);
+                updateDEmatRow(dEmatOther, im, qAnneal, qPrev.data(), Jrows, flipped);
             }
 #  pragma omp single
             if ((offset == 0) && ((m_ % 2) != 0)) { /* m is odd. */
                 int im = m_ - 1;
-                tryFlip(qAnneal, im, dEmat, h, J, N, m_, twoDivM, beta, coef, random_[0]);
+                random_[0].seek(step_, im, 0);
+                qPrev = qAnneal.row(im);
+                tryFlip(qAnneal, im, dEmat, h, N, m_, twoDivM, beta, coef, acceptance_, random_[0], rand);
+                updateDEmatRow(dEmatOther, im, qAnneal, qPrev.data(), Jrows, flipped);
             }
         }
     }
 #endif
+    ++step_;
     clearState(solSolutionAvailable);
 }
 
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::syncBits() {
+    bitsQ0_.resize(m_, N0_);
+    bitsQ1_.resize(m_, N1_);
+    bitsX0_.resize(m_, N0_);
+    bitsX1_.resize(m_, N1_);
+    mapTo(bitsQ0_) = matQ0_.template cast<char>();
+    mapTo(bitsQ1_) = matQ1_.template cast<char>();
+    sq::x_from_q(bitsX0_.data, bitsQ0_.data, m_ * N0_);
+    sq::x_from_q(bitsX1_.data, bitsQ1_.data, m_ * N1_);
+    bitSetsValid_ = false;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::syncBitSets() {
+    if (bitSetsValid_)
+        return;
     bitsPairX_.clear();
     bitsPairQ_.clear();
-    sq::BitSet x0, x1;
+    bitsPairX_.reserve(m_);
+    bitsPairQ_.reserve(m_);
     for (int idx = 0; idx < sq::IdxType(m_); ++idx) {
-        sq::BitSet q0 = sq::extractRow<char>(matQ0_, idx);
-        sq::BitSet q1 = sq::extractRow<char>(matQ1_, idx);
-        bitsPairQ_.pushBack(sq::BitSetPairArray::ValueType(q0, q1));
-        sq::BitSet x0 = x_from_q(q0), x1 = x_from_q(q1);
-        bitsPairX_.pushBack(sq::BitSetPairArray::ValueType(x0, x1));
+        sq::BitSet x0(&bitsX0_(idx, 0), N0_), x1(&bitsX1_(idx, 0), N1_);
+        bitsPairX_.emplaceBack(x0, x1);
+        sq::BitSet q0(&bitsQ0_(idx, 0), N0_), q1(&bitsQ1_(idx, 0), N1_);
+        bitsPairQ_.emplaceBack(q0, q1);
     }
+    bitSetsValid_ = true;
 }
 
 
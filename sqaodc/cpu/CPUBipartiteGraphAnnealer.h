@@ -3,6 +3,9 @@
 
 #include <sqaodc/common/Common.h>
 #include <sqaodc/common/EigenBridge.h>
+#include <sqaodc/cpu/CPURandom.h>
+#include <sqaodc/cpu/CPUScratchArena.h>
+#include <sqaodc/cpu/CPUAcceptance.h>
 
 
 namespace sqaod_cpu {
@@ -34,8 +37,9 @@ public:
     void setHamiltonian(const Vector &h0, const Vector &h1, const Matrix &J,
                         real c = real(0.));
 
-    /* FIXME: algo */
-    /* void setPreference(const Preference &pref); */
+    void setPreference(const sq::Preference &pref);
+
+    using sq::Solver<real>::setPreference;
 
     sq::Preferences getPreferences() const;
 
@@ -43,6 +47,8 @@ public:
 
     const sq::BitSetPairArray &get_x() const;
 
+    void get_x(sq::BitMatrix *x0, sq::BitMatrix *x1) const;
+
     void set_x(const sq::BitSet &x0, const sq::BitSet &x1);
 
     /* Ising machine / spins */
@@ -51,6 +57,8 @@ public:
 
     const sq::BitSetPairArray &get_q() const;
 
+    void get_q(sq::BitMatrix *q0, sq::BitMatrix *q1) const;
+
     void randomizeSpin();
 
     void prepare();
@@ -66,6 +74,9 @@ public:
     void annealOneStepNaive(real G, real beta);
 
     void annealOneStepColoring(real G, real beta);
+
+    /* cached fields of annealOneStepColoring(), q1 J (m x N0) and q0 J^T (m x N1). */
+    void getDEmat(Matrix *dEmat0, Matrix *dEmat1) const;
     
 private:
     typedef void (CPUBipartiteGraphAnnealer<real>::*AnnealMethod)(real G, real beta);
@@ -73,19 +84,37 @@ private:
     
     void syncBits();
 
-    void annealHalfStepColoring(int N, EigenMatrix &qAnneal,
-                                const EigenRowVector &h, const EigenMatrix &J,
-                                const EigenMatrix &qFixed, real G, real beta);
+    void syncBitSets();
+
+    void updateLocalFieldRange();
+
+    void annealHalfStepColoring(int N, EigenMatrix &qAnneal, const EigenRowVector &h,
+                                const EigenMatrix &dEmat, EigenMatrix &dEmatOther,
+                                const EigenMatrix &Jrows, real G, real beta);
+
+    void updateDEmat();
 
-    sq::Random *random_;
+    CPURandom *random_;
+    CPUScratchArena *arenas_; /* temporaries of threads in annealHalfStepColoring() */
     int nMaxThreads_;
+    unsigned long long seed_;
+    bool counterBased_;
+    unsigned int step_; /* counter for the counter-based random mode */
+    CPUAcceptance<real> acceptance_;
     EigenRowVector h0_, h1_;
     EigenMatrix J_;
+    EigenMatrix JT_; /* J transposed, N0 x N1 */
     real c_;
     Vector E_;
     EigenMatrix matQ0_, matQ1_;
-    sq::BitSetPairArray bitsPairX_;
+    EigenMatrix dEmat0_, dEmat1_; /* m x N0, q1 J and m x N1, q0 J^T */
+    bool dEmatValid_;
+    int nIncrementalSteps_;
+    sq::BitMatrix bitsX0_, bitsX1_; /* m x N0, m x N1, synced by makeSolution() */
+    sq::BitMatrix bitsQ0_, bitsQ1_;
+    sq::BitSetPairArray bitsPairX_; /* rows of bit matrices, created on get_x() and get_q(). */
     sq::BitSetPairArray bitsPairQ_;
+    bool bitSetsValid_;
 
     typedef CPUBipartiteGraphAnnealer<real> This;
     typedef sq::BipartiteGraphAnnealer<real> Base;
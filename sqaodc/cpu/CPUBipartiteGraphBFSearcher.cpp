@@ -1,10 +1,13 @@
 #include "CPUBipartiteGraphBFSearcher.h"
 #include "CPUBipartiteGraphBatchSearch.h"
+#include <sqaodc/common/Checkpoint.h>
 #include <sqaodc/common/ShapeChecker.h>
 #include <cmath>
 #include <float.h>
+#include <limits.h>
 #include <algorithm>
 #include <exception>
+#include <vector>
 
 namespace sqint = sqaod_internal;
 using namespace sqaod_cpu;
@@ -13,6 +16,9 @@ template<class real>
 CPUBipartiteGraphBFSearcher<real>::CPUBipartiteGraphBFSearcher() {
     tileSize0_ = 1024;
     tileSize1_ = 1024;
+    algo_ = sq::algoGrayCode;
+    topK_ = 0;
+    energyWindow_ = real(-1.);
 #ifdef _OPENMP
     nMaxThreads_ = omp_get_max_threads();
     sq::log("# max threads: %d", nMaxThreads_);
@@ -52,10 +58,75 @@ void CPUBipartiteGraphBFSearcher<real>::setQUBO(const Vector &b0, const Vector &
     setState(solProblemSet);
 }
 
+/* throws if integer weights are not exactly represented by real. */
+template<class real, class V>
+static void checkWeights(const real *weights, const V *values, sq::SizeType size) {
+    for (sq::IdxType idx = 0; idx < size; ++idx)
+        throwErrorIf(double(weights[idx]) != double(values[idx]),
+                     "Weight, %d, is not exactly represented by %d-bit real.",
+                     int(values[idx]), int(sizeof(real) * 8));
+}
+
+template<class real> template<class V>
+void CPUBipartiteGraphBFSearcher<real>::setQUBO(const sq::VectorType<V> &b0,
+                                                const sq::VectorType<V> &b1,
+                                                const sq::MatrixType<V> &W, sq::OptimizeMethod om) {
+    Vector b0r = sq::cast<real>(b0), b1r = sq::cast<real>(b1);
+    Matrix Wr = sq::cast<real>(W);
+    checkWeights(b0r.data, b0.data, b0.size);
+    checkWeights(b1r.data, b1.data, b1.size);
+    for (sq::IdxType row = 0; row < W.rows; ++row)
+        checkWeights(Wr.row(row), W.row(row), W.cols);
+    setQUBO(b0r, b1r, Wr, om);
+}
+
+template<class real>
+sq::Algorithm CPUBipartiteGraphBFSearcher<real>::selectAlgorithm(sq::Algorithm algo) {
+    switch (algo) {
+    case sq::algoBruteForceSearch:
+        algo_ = algo;
+        break;
+    case sq::algoGrayCode:
+    case sq::algoDefault:
+        algo_ = sq::algoGrayCode;
+        break;
+    default:
+        sq::log("Uknown algo, %s, defaulting to %s.",
+                sq::algorithmToString(algo), sq::algorithmToString(sq::algoGrayCode));
+        algo_ = sq::algoGrayCode;
+    }
+    return algo_;
+}
+
+template<class real>
+sq::Algorithm CPUBipartiteGraphBFSearcher<real>::getAlgorithm() const {
+    return algo_;
+}
+
+template<class real>
+void CPUBipartiteGraphBFSearcher<real>::setPreference(const sq::Preference &pref) {
+    if (pref.name == sq::pnTopK) {
+        throwErrorIf(pref.topK < 0, "top_k must not be negative.");
+        topK_ = pref.topK;
+        clearState(solPrepared);
+    }
+    else if (pref.name == sq::pnEnergyWindow) {
+        energyWindow_ = real(pref.energyWindow);
+        clearState(solPrepared);
+    }
+    else {
+        Base::setPreference(pref);
+    }
+}
+
 template<class real>
 sq::Preferences CPUBipartiteGraphBFSearcher<real>::getPreferences() const {
     sq::Preferences prefs = Base::getPreferences();
     prefs.pushBack(sq::Preference(sq::pnDevice, "cpu"));
+    if (0 < topK_)
+        prefs.pushBack(sq::Preference(sq::pnTopK, topK_));
+    if (0 <= energyWindow_)
+        prefs.pushBack(sq::Preference(sq::pnEnergyWindow, double(energyWindow_)));
     return prefs;
 }
 
@@ -91,7 +162,11 @@ void CPUBipartiteGraphBFSearcher<real>::prepare() {
     for (int idx = 0; idx < nMaxThreads_; ++idx) {
         searchers_[idx].setQUBO(b0_, b1_, W_, tileSize0_, tileSize1_);
         searchers_[idx].initSearch();
+        searchers_[idx].collector_.reset(topK_, energyWindow_, tileSize0_ + tileSize1_);
     }
+    if (searchers_[0].intBits_ != 0)
+        sq::log("QUBO is integer-valued, energies are evaluated by %d-bit integers.",
+                searchers_[0].intBits_);
     setState(solPrepared);
 
 #ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
@@ -103,6 +178,24 @@ void CPUBipartiteGraphBFSearcher<real>::prepare() {
 template<class real>
 void CPUBipartiteGraphBFSearcher<real>::calculate_E() {
     throwErrorIfNotPrepared();
+    if (isCollecting()) {
+        /* energies of collected states differ, and are calculated from x. */
+        const sq::EigenMappedMatrixType<real> W(mapTo(W_));
+        const sq::EigenMappedRowVectorType<real> b0(mapToRowVector(b0_)), b1(mapToRowVector(b1_));
+        sq::EigenRowVectorType<real> x0(N0_), x1(N1_);
+        real sign = (om_ == sq::optMaximize) ? real(-1.) : real(1.);
+        E_.resize(xPairList_.size());
+        for (sq::IdxType idx = 0; idx < (sq::IdxType)xPairList_.size(); ++idx) {
+            const sq::BitSetPairArray::ValueType &pair = xPairList_[idx];
+            for (int k = 0; k < N0_; ++k)
+                x0(k) = real(pair.first(k));
+            for (int k = 0; k < N1_; ++k)
+                x1(k) = real(pair.second(k));
+            E_(idx) = sign * (b0.dot(x0) + b1.dot(x1) + x1.dot(x0 * W.transpose()));
+        }
+        setState(solEAvailable);
+        return;
+    }
     if (xPairList_.empty())
         E_.resize(1);
     else
@@ -111,35 +204,35 @@ void CPUBipartiteGraphBFSearcher<real>::calculate_E() {
     setState(solEAvailable);
 }
 
+static bool packedBitSetPairLess(const sq::PackedBitSetPair &lhs, const sq::PackedBitSetPair &rhs) {
+    if (lhs.bits0 != rhs.bits0)
+        return lhs.bits0 < rhs.bits0;
+    return lhs.bits1 < rhs.bits1;
+}
+
 template<class real>
 void CPUBipartiteGraphBFSearcher<real>::makeSolution() {
+    if (isCollecting()) {
+        makeSolutionCollected();
+        return;
+    }
     xPairList_.clear();
 
     int nMaxSolutions = tileSize0_ + tileSize1_;
     
     sq::PackedBitSetPairArray packedXPairList;
-    for (int idx = 0; idx < nMaxThreads_; ++idx) {
-        const BatchSearcher &searcher = searchers_[idx];
-        if (searcher.Emin_ < Emin_) {
-            Emin_ = searcher.Emin_;
-            packedXPairList = searcher.packedXPairList_;
-        }
-        else if (searcher.Emin_ == Emin_) {
-            if (packedXPairList.size() < nMaxSolutions) {
-                packedXPairList.insert(searcher.packedXPairList_.begin(),
-                                       searcher.packedXPairList_.end());
-                                       
-            }
-        }
-    }
+    long long EminInt = LLONG_MAX;
+    mergeSolutions(&Emin_, &EminInt, &packedXPairList);
 
+    std::sort(packedXPairList.begin(), packedXPairList.end(), packedBitSetPairLess);
     int nSolutions = std::min(nMaxSolutions, (int)packedXPairList.size());
+    xPairList_.reserve(nSolutions);
     for (int idx = 0; idx < nSolutions; ++idx) {
         const sq::PackedBitSetPair &pair =  packedXPairList[idx];
         sq::BitSet x0(N0_), x1(N1_);
         unpackBitSet(&x0, pair.bits0, N0_);
         unpackBitSet(&x1, pair.bits1, N1_);
-        xPairList_.pushBack(sq::BitSetPairArray::ValueType(x0, x1));
+        xPairList_.emplaceBack(std::move(x0), std::move(x1));
     }
     real tmpE = (om_ == sq::optMaximize) ? - Emin_ : Emin_;
     E_.resize(nSolutions);
@@ -157,6 +250,147 @@ void CPUBipartiteGraphBFSearcher<real>::makeSolution() {
 #endif
 }
 
+/* collected states of threads are merged after searches, so no lock is required. */
+template<class real>
+void CPUBipartiteGraphBFSearcher<real>::makeSolutionCollected() {
+    typedef CPUSolutionCollector<real, sq::PackedBitSetPair> Collector;
+    Collector collector;
+    sq::SizeType maxSize = tileSize0_ + tileSize1_;
+    collector.reset(topK_, energyWindow_, maxSize);
+    for (int idx = 0; idx < nMaxThreads_; ++idx)
+        collector.merge(searchers_[idx].collector_);
+    if (collector.isTruncated())
+        sq::log("More than %d states are in the energy window, the lowest %d states are collected.",
+                maxSize, maxSize);
+    std::vector<typename Collector::Entry> entries;
+    collector.getSolutions(&entries);
+
+    xPairList_.clear();
+    xPairList_.reserve(entries.size());
+    Emin_ = entries.empty() ? real(FLT_MAX) : entries[0].E;
+    for (size_t idx = 0; idx < entries.size(); ++idx) {
+        sq::BitSet x0(N0_), x1(N1_);
+        unpackBitSet(&x0, entries[idx].x.bits0, N0_);
+        unpackBitSet(&x1, entries[idx].x.bits1, N1_);
+        xPairList_.emplaceBack(std::move(x0), std::move(x1));
+    }
+    calculate_E();
+    setState(solSolutionAvailable);
+}
+
+template<class real>
+void CPUBipartiteGraphBFSearcher<real>::mergeSolutions(real *Emin, long long *EminInt,
+                                                       sq::PackedBitSetPairArray *packedXPairList) const {
+    int nMaxSolutions = tileSize0_ + tileSize1_;
+    packedXPairList->clear();
+    if (searchers_[0].intBits_ != 0) {
+        /* energies are compared in integers, as values of real may be rounded. */
+        for (int idx = 0; idx < nMaxThreads_; ++idx)
+            *EminInt = std::min(*EminInt, searchers_[idx].EminInt_);
+        if (*EminInt == LLONG_MAX)
+            return;
+        *Emin = real(*EminInt);
+        for (int idx = 0; idx < nMaxThreads_; ++idx) {
+            const BatchSearcher &searcher = searchers_[idx];
+            if ((searcher.EminInt_ == *EminInt) && (packedXPairList->size() < nMaxSolutions)) {
+                packedXPairList->insert(searcher.packedXPairList_.begin(),
+                                        searcher.packedXPairList_.end());
+            }
+        }
+        return;
+    }
+    for (int idx = 0; idx < nMaxThreads_; ++idx) {
+        const BatchSearcher &searcher = searchers_[idx];
+        if (searcher.Emin_ < *Emin) {
+            *Emin = searcher.Emin_;
+            *packedXPairList = searcher.packedXPairList_;
+        }
+        else if (searcher.Emin_ == *Emin) {
+            if (packedXPairList->size() < nMaxSolutions) {
+                packedXPairList->insert(searcher.packedXPairList_.begin(),
+                                        searcher.packedXPairList_.end());
+            }
+        }
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphBFSearcher<real>::saveCheckpoint(const char *filename) const {
+    throwErrorIfNotPrepared();
+    throwErrorIf(isCollecting(), "Checkpoint is not supported with top_k or energy_window.");
+    real Emin = FLT_MAX;
+    long long EminInt = LLONG_MAX;
+    sq::PackedBitSetPairArray packedXPairList;
+    mergeSolutions(&Emin, &EminInt, &packedXPairList);
+
+    sq::CheckpointWriter writer(filename, sq::ckBipartiteGraphBFSearcher);
+    writer.write(int(sizeof(real)));
+    writer.write(N0_);
+    writer.write(N1_);
+    writer.write(int(om_));
+    writer.write(sq::fingerprint(W_, sq::fingerprint(b1_, sq::fingerprint(b0_))));
+    writer.write(int(algo_));
+    writer.write(tileSize0_);
+    writer.write(tileSize1_);
+    writer.write(x0_);
+    writer.write(x1_);
+    writer.write(Emin);
+    writer.write(EminInt);
+    writer.writeArray(packedXPairList);
+    writer.commit();
+}
+
+template<class real>
+void CPUBipartiteGraphBFSearcher<real>::resumeFromCheckpoint(const char *filename) {
+    throwErrorIfProblemNotSet();
+
+    sq::CheckpointReader reader(filename, sq::ckBipartiteGraphBFSearcher);
+    int realSize = reader.read<int>();
+    sq::SizeType N0 = reader.read<sq::SizeType>();
+    sq::SizeType N1 = reader.read<sq::SizeType>();
+    int om = reader.read<int>();
+    unsigned long long hash = reader.read<unsigned long long>();
+    throwErrorIf((realSize != (int)sizeof(real)) || (N0 != N0_) || (N1 != N1_) ||
+                 (om != (int)om_) ||
+                 (hash != sq::fingerprint(W_, sq::fingerprint(b1_, sq::fingerprint(b0_)))),
+                 "Checkpoint does not match the problem.");
+    sq::Algorithm algo = (sq::Algorithm)reader.read<int>();
+    sq::SizeType tileSize0 = reader.read<sq::SizeType>();
+    sq::SizeType tileSize1 = reader.read<sq::SizeType>();
+    sq::PackedBitSet x0 = reader.read<sq::PackedBitSet>();
+    sq::PackedBitSet x1 = reader.read<sq::PackedBitSet>();
+    real Emin = reader.read<real>();
+    long long EminInt = reader.read<long long>();
+    sq::PackedBitSetPairArray packedXPairList;
+    reader.readArray(&packedXPairList);
+    reader.finish();
+
+    algo_ = algo;
+    tileSize0_ = tileSize0;
+    tileSize1_ = tileSize1;
+    prepare();
+    throwErrorIf((x0max_ < x0) || (x1max_ < x1), "Checkpoint is broken.");
+    x0_ = x0;
+    x1_ = x1;
+    searchers_[0].restore(Emin, EminInt, packedXPairList);
+#ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
+    for (sq::PackedBitSet x0begin = 0; x0begin < x0_; x0begin += tileSize0_)
+        rangeMapArray_[sq::SizeType(x0begin / tileSize0_)].insert(0, x1max_);
+    if (0 < x1_)
+        rangeMapArray_[sq::SizeType(x0_ / tileSize0_)].insert(0, x1_);
+#endif
+}
+
+template<class real>
+void CPUBipartiteGraphBFSearcher<real>::searchTile(int threadNum,
+                                                   sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                                                   sq::PackedBitSet x1begin, sq::PackedBitSet x1end) {
+    if (algo_ == sq::algoGrayCode)
+        searchers_[threadNum].searchRangeGrayCode(x0begin, x0end, x1begin, x1end);
+    else
+        searchers_[threadNum].searchRange(x0begin, x0end, x1begin, x1end);
+}
+
 template<class real>
 bool CPUBipartiteGraphBFSearcher<real>::searchRange(sq::PackedBitSet *curX0, sq::PackedBitSet *curX1) {
     throwErrorIfNotPrepared();
@@ -204,7 +438,7 @@ bool CPUBipartiteGraphBFSearcher<real>::searchRange(sq::PackedBitSet *curX0, sq:
         sq::PackedBitSet b1b = batch1begin[threadNum];
         sq::PackedBitSet b1e = batch1end[threadNum];
         if ((b0b < b0e) && (b1b < b1e))
-            searchers_[threadNum].searchRange(b0b, b0e, b1b, b1e);
+            searchTile(threadNum, b0b, b0e, b1b, b1e);
     }
 
     /* move to next batch */
@@ -224,7 +458,7 @@ bool CPUBipartiteGraphBFSearcher<real>::searchRange(sq::PackedBitSet *curX0, sq:
 #endif
 
     if ((batch0begin < batch0end) && (batch1begin < batch1end))
-        searchers_[0].searchRange(batch0begin, batch0end, batch1begin, batch1end);
+        searchTile(0, batch0begin, batch0end, batch1begin, batch1end);
 
     x1_ = batch1end;
 #endif
@@ -245,3 +479,17 @@ bool CPUBipartiteGraphBFSearcher<real>::searchRange(sq::PackedBitSet *curX0, sq:
 
 template class CPUBipartiteGraphBFSearcher<float>;
 template class CPUBipartiteGraphBFSearcher<double>;
+
+/* integer weights */
+template void CPUBipartiteGraphBFSearcher<float>::setQUBO<short>(
+        const sq::VectorType<short> &, const sq::VectorType<short> &,
+        const sq::MatrixType<short> &, sq::OptimizeMethod);
+template void CPUBipartiteGraphBFSearcher<float>::setQUBO<int>(
+        const sq::VectorType<int> &, const sq::VectorType<int> &,
+        const sq::MatrixType<int> &, sq::OptimizeMethod);
+template void CPUBipartiteGraphBFSearcher<double>::setQUBO<short>(
+        const sq::VectorType<short> &, const sq::VectorType<short> &,
+        const sq::MatrixType<short> &, sq::OptimizeMethod);
+template void CPUBipartiteGraphBFSearcher<double>::setQUBO<int>(
+        const sq::VectorType<int> &, const sq::VectorType<int> &,
+        const sq::MatrixType<int> &, sq::OptimizeMethod);
@@ -25,12 +25,24 @@ public:
     CPUBipartiteGraphBFSearcher();
     ~CPUBipartiteGraphBFSearcher();
 
+    sq::Algorithm selectAlgorithm(sq::Algorithm algo);
+
+    sq::Algorithm getAlgorithm() const;
+
     /* void getProblemSize(int *N0, int *N1) const; */
 
     void setQUBO(const Vector &b0, const Vector &b1, const Matrix &W,
                  sq::OptimizeMethod om = sq::optMinimize);
 
-    /* void setPreference(const Preference &pref); */
+    /* b0, b1 and W of integer weights, short or int.  Weights should be exactly represented
+     * by real. */
+    template<class V>
+    void setQUBO(const sq::VectorType<V> &b0, const sq::VectorType<V> &b1,
+                 const sq::MatrixType<V> &W, sq::OptimizeMethod om = sq::optMinimize);
+
+    void setPreference(const sq::Preference &pref);
+
+    using sq::Solver<real>::setPreference;
 
     sq::Preferences getPreferences() const;
     
@@ -46,9 +58,29 @@ public:
 
     bool searchRange(sq::PackedBitSet *currentX0, sq::PackedBitSet *currentX1);
 
+    void saveCheckpoint(const char *filename) const;
+
+    void resumeFromCheckpoint(const char *filename);
+
     /* void search(); */
     
 private:    
+    void mergeSolutions(real *Emin, long long *EminInt,
+                        sq::PackedBitSetPairArray *packedXPairList) const;
+
+    void makeSolutionCollected();
+
+    /* top-K or energy-window collection of low-lying states. */
+    bool isCollecting() const {
+        return (0 < topK_) || (0 <= energyWindow_);
+    }
+
+    void searchTile(int threadNum, sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                    sq::PackedBitSet x1begin, sq::PackedBitSet x1end);
+
+    sq::Algorithm algo_;
+    sq::SizeType topK_;
+    real energyWindow_;
     Vector b0_, b1_;
     Matrix W_;
     real Emin_;
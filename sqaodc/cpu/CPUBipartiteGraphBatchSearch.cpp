@@ -2,11 +2,16 @@
 #include <common/EigenBridge.h>
 #include <cpu/CPUFormulas.h>
 #include <float.h>
+#include <limits.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace sqaod_cpu;
 
 template<class real>
-CPUBipartiteGraphBatchSearch<real>::CPUBipartiteGraphBatchSearch() {
+CPUBipartiteGraphBatchSearch<real>::CPUBipartiteGraphBatchSearch()
+        : cachedX0begin_(0), cachedX0end_(0), intBits_(0) {
 }
 
 template<class real> void CPUBipartiteGraphBatchSearch<real>::
@@ -14,54 +19,272 @@ setQUBO(const Vector &b0, const Vector &b1, const Matrix &W,
         sq::SizeType tileSize0, sq::SizeType tileSize1) {
     b0_.map(b0.data, b0.size);
     b1_.map(b1.data, b1.size);
-    W_.map(W.data, W.rows, W.cols);
+    W_.map(W.data, W.rows, W.cols, W.stride);
     tileSize0_ = tileSize0;
     tileSize1_ = tileSize1;
+    cachedX0begin_ = cachedX0end_ = 0;
+    intBits_ = BGFuncs<real>::integralEnergyBits(b0, b1, W);
+    if (intBits_ == 32)
+        setIntegralTerms(&terms32_);
+    else if (intBits_ == 64)
+        setIntegralTerms(&terms64_);
+}
+
+template<class real> template<class V>
+void CPUBipartiteGraphBatchSearch<real>::setIntegralTerms(IntegralTerms<V> *terms) {
+    terms->W = mapTo(W_).template cast<V>();
+    terms->b0 = mapToRowVector(b0_).template cast<V>();
+    terms->b1 = mapToRowVector(b1_).template cast<V>();
 }
 
 template<class real>
 void CPUBipartiteGraphBatchSearch<real>::initSearch() {
     Emin_ = FLT_MAX;
+    EminInt_ = LLONG_MAX;
     packedXPairList_.clear();
 }
 
+template<class real> void CPUBipartiteGraphBatchSearch<real>::
+restore(real Emin, long long EminInt, const sq::PackedBitSetPairArray &packedXPairList) {
+    Emin_ = Emin;
+    EminInt_ = EminInt;
+    packedXPairList_ = packedXPairList;
+}
+
+template<class real> void CPUBipartiteGraphBatchSearch<real>::
+updateX0Cache(sq::PackedBitSet x0begin, sq::PackedBitSet x0end) {
+    if ((cachedX0begin_ == x0begin) && (cachedX0end_ == x0end))
+        return;
+
+    int nBatchSize0 = int(x0end - x0begin);
+    int N0 = W_.cols;
+    Matrix bitsSeq0 = arena_.matrix<real>(nBatchSize0, N0);
+    sq::createBitSetSequence(bitsSeq0.data, N0, x0begin, x0end);
+
+    cachedX0begin_ = x0begin;
+    cachedX0end_ = x0end;
+    if (intBits_ == 32) {
+        updateX0CacheIntegral(&terms32_, bitsSeq0);
+        return;
+    }
+    if (intBits_ == 64) {
+        updateX0CacheIntegral(&terms64_, bitsSeq0);
+        return;
+    }
+    const EigenMappedMatrix eW(mapTo(W_)), ex0(mapTo(bitsSeq0));
+    const EigenMappedRowVector eb0(mapToRowVector(b0_));
+    Wx0_.noalias() = eW * ex0.transpose();
+    bx0_.noalias() = eb0 * ex0.transpose();
+}
+
+template<class real> template<class V>
+void CPUBipartiteGraphBatchSearch<real>::updateX0CacheIntegral(IntegralTerms<V> *terms,
+                                                               const Matrix &bitsSeq0) {
+    EigenScratchMatrixType<V> x0 = arena_.eigenMatrix<V>(bitsSeq0.rows, bitsSeq0.cols);
+    x0 = mapTo(bitsSeq0).template cast<V>();
+    terms->Wx0.noalias() = terms->W * x0.transpose();
+    terms->bx0.noalias() = terms->b0 * x0.transpose();
+}
+
+template<class real> template<class V>
+void CPUBipartiteGraphBatchSearch<real>::updateXPairMinsIntegral(const IntegralTerms<V> &terms,
+                                                                 sq::PackedBitSet x0begin,
+                                                                 sq::PackedBitSet x1) {
+    const typename IntegralTerms<V>::RowVector &E = terms.E;
+    if (collector_.isEnabled()) {
+        if (collector_.threshold() < real(E.minCoeff()))
+            return;
+        for (int idx0 = 0; idx0 < (int)E.size(); ++idx0)
+            collector_.add(real(E(idx0)), sq::PackedBitSetPair(x0begin + idx0, x1));
+        return;
+    }
+    if (EminInt_ < (long long)E.minCoeff())
+        return;
+
+    int maxNSolutions = W_.rows + W_.cols;
+    for (int idx0 = 0; idx0 < (int)E.size(); ++idx0) {
+        long long Etmp = E(idx0);
+        if (Etmp > EminInt_) {
+            continue;
+        }
+        else if (Etmp == EminInt_) {
+            if (packedXPairList_.size() < maxNSolutions)
+                packedXPairList_.pushBack(
+                        sq::PackedBitSetPairArray::ValueType(x0begin + idx0, x1));
+        }
+        else {
+            EminInt_ = Etmp;
+            Emin_ = real(Etmp);
+            packedXPairList_.clear();
+            packedXPairList_.pushBack(sq::PackedBitSetPairArray::ValueType(x0begin + idx0, x1));
+        }
+    }
+}
+
+template<class real> void CPUBipartiteGraphBatchSearch<real>::
+updateXPairMins(sq::PackedBitSet x0begin, sq::PackedBitSet x1) {
+    if (collector_.isEnabled()) {
+        if (collector_.threshold() < E_.minCoeff())
+            return;
+        for (int idx0 = 0; idx0 < (int)E_.size(); ++idx0)
+            collector_.add(E_(idx0), sq::PackedBitSetPair(x0begin + idx0, x1));
+        return;
+    }
+    if (Emin_ < E_.minCoeff())
+        return;
+
+    int maxNSolutions = W_.rows + W_.cols;
+    for (int idx0 = 0; idx0 < (int)E_.size(); ++idx0) {
+        real Etmp = E_(idx0);
+        if (Etmp > Emin_) {
+            continue;
+        }
+        else if (Etmp == Emin_) {
+            if (packedXPairList_.size() < maxNSolutions)
+                packedXPairList_.pushBack(
+                        sq::PackedBitSetPairArray::ValueType(x0begin + idx0, x1));
+        }
+        else {
+            Emin_ = Etmp;
+            packedXPairList_.clear();
+            packedXPairList_.pushBack(sq::PackedBitSetPairArray::ValueType(x0begin + idx0, x1));
+        }
+    }
+}
 
 template<class real> void CPUBipartiteGraphBatchSearch<real>::
 searchRange(sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
             sq::PackedBitSet x1begin, sq::PackedBitSet x1end) {
-    int nBatchSize0 = int(x0end - x0begin);
-    int nBatchSize1 = int(x1end - x1begin);
+    arena_.reset();
+    updateX0Cache(x0begin, x0end);
+    if (intBits_ == 32) {
+        searchRangeIntegral(terms32_, x0begin, x0end, x1begin, x1end);
+        return;
+    }
+    if (intBits_ == 64) {
+        searchRangeIntegral(terms64_, x0begin, x0end, x1begin, x1end);
+        return;
+    }
 
-    // typedef sq::EigenColumnVectorType<real> EigenColumnVector;
-    int N0 = W_.cols;
+    int nBatchSize1 = int(x1end - x1begin);
     int N1 = W_.rows;
-    Matrix bitsSeq0(nBatchSize0, N0);
-    Matrix bitsSeq1(nBatchSize1, N1);
-
-    sq::createBitSetSequence(bitsSeq0.data, N0, x0begin, x0end);
+    Matrix bitsSeq1 = arena_.matrix<real>(nBatchSize1, N1);
     sq::createBitSetSequence(bitsSeq1.data, N1, x1begin, x1end);
 
-    int maxNSolutions = W_.rows + W_.cols;
-    Matrix EBatch;
+    const EigenMappedMatrix ex1(mapTo(bitsSeq1));
+    const EigenMappedRowVector eb1(mapToRowVector(b1_));
+    EigenScratchMatrixType<real> EBatch = arena_.eigenMatrix<real>(nBatchSize1, Wx0_.cols());
+    EigenScratchRowVectorType<real> bx1 = arena_.eigenRowVector<real>(nBatchSize1);
+    EBatch.noalias() = ex1 * Wx0_;
+    bx1.noalias() = eb1 * ex1.transpose();
+    EBatch.rowwise() += bx0_;
+    for (int idx1 = 0; idx1 < nBatchSize1; ++idx1) {
+        E_ = EBatch.row(idx1).array() + bx1(idx1);
+        updateXPairMins(x0begin, x1begin + idx1);
+    }
+}
 
-    BGFuncs<real>::calculate_E_2d(&EBatch, b0_, b1_, W_, bitsSeq0, bitsSeq1);
+template<class real> template<class V>
+void CPUBipartiteGraphBatchSearch<real>::searchRangeIntegral(IntegralTerms<V> &terms,
+                                                             sq::PackedBitSet x0begin,
+                                                             sq::PackedBitSet x0end,
+                                                             sq::PackedBitSet x1begin,
+                                                             sq::PackedBitSet x1end) {
+    int nBatchSize1 = int(x1end - x1begin);
+    int N1 = W_.rows;
+    Matrix bitsSeq1 = arena_.matrix<real>(nBatchSize1, N1);
+    sq::createBitSetSequence(bitsSeq1.data, N1, x1begin, x1end);
+
+    EigenScratchMatrixType<V> x1 = arena_.eigenMatrix<V>(nBatchSize1, N1);
+    x1 = mapTo(bitsSeq1).template cast<V>();
+    EigenScratchMatrixType<V> EBatch = arena_.eigenMatrix<V>(nBatchSize1, terms.Wx0.cols());
+    EigenScratchRowVectorType<V> bx1 = arena_.eigenRowVector<V>(nBatchSize1);
+    EBatch.noalias() = x1 * terms.Wx0;
+    bx1.noalias() = terms.b1 * x1.transpose();
+    EBatch.rowwise() += terms.bx0;
     for (int idx1 = 0; idx1 < nBatchSize1; ++idx1) {
-        for (int idx0 = 0; idx0 < nBatchSize0; ++idx0) {
-            real Etmp = EBatch(idx1, idx0);
-            if (Etmp > Emin_) {
-                continue;
-            }
-            else if (Etmp == Emin_) {
-                if (packedXPairList_.size() < maxNSolutions)
-                    packedXPairList_.pushBack(
-                            sq::PackedBitSetPairArray::ValueType(x0begin + idx0, x1begin + idx1));
-            }
-            else {
-                Emin_ = Etmp;
-                packedXPairList_.clear();
-                packedXPairList_.pushBack(sq::PackedBitSetPairArray::ValueType(x0begin + idx0, x1begin + idx1));
-            }
+        terms.E = EBatch.row(idx1).array() + bx1(idx1);
+        updateXPairMinsIntegral(terms, x0begin, x1begin + idx1);
+    }
+}
+
+static inline int countTrailingZeros(sq::PackedBitSet v) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return (int)idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+template<class real> void CPUBipartiteGraphBatchSearch<real>::
+searchRangeGrayCode(sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                    sq::PackedBitSet i1begin, sq::PackedBitSet i1end) {
+    arena_.reset();
+    updateX0Cache(x0begin, x0end);
+    if (intBits_ == 32) {
+        searchRangeGrayCodeIntegral(terms32_, x0begin, x0end, i1begin, i1end);
+        return;
+    }
+    if (intBits_ == 64) {
+        searchRangeGrayCodeIntegral(terms64_, x0begin, x0end, i1begin, i1end);
+        return;
+    }
+
+    int N1 = W_.rows;
+    const EigenMappedRowVector eb1(mapToRowVector(b1_));
+
+    /* bit (N1 - 1 - k) of a packed x1 is x1_k. */
+    sq::PackedBitSet x1 = i1begin ^ (i1begin >> 1);
+    x1_.resize(N1);
+    for (int k = 0; k < N1; ++k)
+        x1_(k) = real((x1 >> (N1 - 1 - k)) & 1);
+    E_.noalias() = x1_ * Wx0_;
+    E_.array() += bx0_.array() + eb1.dot(x1_);
+    updateXPairMins(x0begin, x1);
+
+    for (sq::PackedBitSet i1 = i1begin + 1; i1 < i1end; ++i1) {
+        int bit = countTrailingZeros(i1);
+        int k = N1 - 1 - bit;
+        real d = real(1.) - real(2.) * x1_(k); /* +1 : 0 -> 1, -1 : 1 -> 0 */
+        E_.array() += d * (Wx0_.row(k).array() + eb1(k));
+        x1_(k) += d;
+        x1 ^= sq::PackedBitSet(1) << bit;
+        updateXPairMins(x0begin, x1);
+    }
+}
+    
+
+template<class real> template<class V>
+void CPUBipartiteGraphBatchSearch<real>::
+searchRangeGrayCodeIntegral(IntegralTerms<V> &terms,
+                            sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                            sq::PackedBitSet i1begin, sq::PackedBitSet i1end) {
+    int N1 = W_.rows;
+    typename IntegralTerms<V>::RowVector &E = terms.E, &x1v = terms.x1;
+
+    sq::PackedBitSet x1 = i1begin ^ (i1begin >> 1);
+    x1v.resize(N1);
+    for (int k = 0; k < N1; ++k)
+        x1v(k) = V((x1 >> (N1 - 1 - k)) & 1);
+    E.noalias() = x1v * terms.Wx0;
+    E.array() += terms.bx0.array() + terms.b1.dot(x1v);
+    updateXPairMinsIntegral(terms, x0begin, x1);
+
+    for (sq::PackedBitSet i1 = i1begin + 1; i1 < i1end; ++i1) {
+        int bit = countTrailingZeros(i1);
+        int k = N1 - 1 - bit;
+        if (x1v(k) == 0) {
+            E.array() += terms.Wx0.row(k).array() + terms.b1(k);
+            x1v(k) = 1;
+        }
+        else {
+            E.array() -= terms.Wx0.row(k).array() + terms.b1(k);
+            x1v(k) = 0;
         }
+        x1 ^= sq::PackedBitSet(1) << bit;
+        updateXPairMinsIntegral(terms, x0begin, x1);
     }
 }
     
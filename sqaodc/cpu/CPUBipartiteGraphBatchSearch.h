@@ -2,6 +2,8 @@
 
 #include <common/Common.h>
 #include <common/EigenBridge.h>
+#include <cpu/CPUSolutionCollector.h>
+#include <cpu/CPUScratchArena.h>
 
 namespace sqaod_cpu {
 
@@ -11,6 +13,10 @@ template<class real>
 struct CPUBipartiteGraphBatchSearch {
     typedef sq::MatrixType<real> Matrix;
     typedef sq::VectorType<real> Vector;
+    typedef sq::EigenMatrixType<real> EigenMatrix;
+    typedef sq::EigenRowVectorType<real> EigenRowVector;
+    typedef sq::EigenMappedMatrixType<real> EigenMappedMatrix;
+    typedef sq::EigenMappedRowVectorType<real> EigenMappedRowVector;
     
     CPUBipartiteGraphBatchSearch();
 
@@ -22,12 +28,66 @@ struct CPUBipartiteGraphBatchSearch {
     void searchRange(sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
                      sq::PackedBitSet x1begin, sq::PackedBitSet x1end);
 
+    /* visits x1 = i1 ^ (i1 >> 1) for i1 in [i1begin, i1end).  Consecutive x1 differ by one bit,
+     * so energies for all x0 in a tile are updated by a row of W x0^T per candidate. */
+    void searchRangeGrayCode(sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                             sq::PackedBitSet i1begin, sq::PackedBitSet i1end);
+
+    /* W x0^T and b0 x0^T depend only on the x0 tile, and are reused across x1 tiles.
+     * Temporaries are drawn from arena_, which is reset by the caller. */
+    void updateX0Cache(sq::PackedBitSet x0begin, sq::PackedBitSet x0end);
+
+    void updateXPairMins(sq::PackedBitSet x0begin, sq::PackedBitSet x1);
+
+    /* sets the minimum energy and solutions, used to resume searches. */
+    void restore(real Emin, long long EminInt, const sq::PackedBitSetPairArray &packedXPairList);
+
+    /* integer counterparts of the problem and the x0 tile cache, for integer-valued problems. */
+    template<class V>
+    struct IntegralTerms {
+        typedef Eigen::Matrix<V, 1, Eigen::Dynamic> RowVector;
+        sq::EigenMatrixType<V> W, Wx0;
+        RowVector b0, b1, bx0, E, x1;
+    };
+
+    template<class V>
+    void setIntegralTerms(IntegralTerms<V> *terms);
+
+    template<class V>
+    void updateX0CacheIntegral(IntegralTerms<V> *terms, const Matrix &bitsSeq0);
+
+    template<class V>
+    void searchRangeIntegral(IntegralTerms<V> &terms,
+                             sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                             sq::PackedBitSet x1begin, sq::PackedBitSet x1end);
+
+    template<class V>
+    void searchRangeGrayCodeIntegral(IntegralTerms<V> &terms,
+                                     sq::PackedBitSet x0begin, sq::PackedBitSet x0end,
+                                     sq::PackedBitSet i1begin, sq::PackedBitSet i1end);
+
+    template<class V>
+    void updateXPairMinsIntegral(const IntegralTerms<V> &terms,
+                                 sq::PackedBitSet x0begin, sq::PackedBitSet x1);
+
     Vector b0_, b1_;
     Matrix W_;
     sq::SizeType tileSize0_;
     sq::SizeType tileSize1_;
     real Emin_;
     sq::PackedBitSetPairArray packedXPairList_;
+    CPUSolutionCollector<real, sq::PackedBitSetPair> collector_; /* for top-K and energy window */
+
+    sq::PackedBitSet cachedX0begin_, cachedX0end_;
+    EigenMatrix Wx0_;
+    EigenRowVector bx0_, E_, x1_;
+
+    int intBits_; /* 32 or 64 for integer-valued problems, otherwise 0. */
+    long long EminInt_;
+    IntegralTerms<int> terms32_;
+    IntegralTerms<long long> terms64_;
+
+    CPUScratchArena arena_; /* temporaries of searchRange*() */
 };
 
 
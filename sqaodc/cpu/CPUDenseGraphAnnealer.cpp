@@ -3,24 +3,39 @@
 #include <sqaodc/common/ShapeChecker.h>
 #include <common/Common.h>
 #include <time.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace sqint = sqaod_internal;
 using namespace sqaod_cpu;
 
+enum {
+    /* local fields are recalculated by GEMM every localFieldResyncInterval steps. */
+    localFieldResyncInterval = 64,
+};
+
 template<class real>
 CPUDenseGraphAnnealer<real>::CPUDenseGraphAnnealer() {
     m_ = -1;
+    bitSetsValid_ = false;
     annealMethod_ = &CPUDenseGraphAnnealer::annealOneStepColoring;
+    localFieldValid_ = false;
+    nIncrementalSteps_ = 0;
+    packedJValid_ = false;
+    packedQValid_ = false;
+    matQValid_ = true;
+    seed_ = 0;
+    counterBased_ = false;
+    step_ = 0;
+    random_ = NULL;
+    nMaxThreads_ = 0;
 #ifdef _OPENMP
-    /* FIXME: needing to apply prefetch with fixes for matrix memory alignment. */
-    sq::log("Currently limiting the number of threads to 2 for better performance.");
-    omp_set_num_threads(2);
-    nMaxThreads_ = omp_get_max_threads();
+    setNumThreads(omp_get_max_threads());
     sq::log("# max threads: %d", nMaxThreads_);
 #else
-    nMaxThreads_ = 1;
+    setNumThreads(1);
 #endif
-    random_ = new sq::Random[nMaxThreads_];
 }
 
 template<class real>
@@ -30,11 +45,28 @@ CPUDenseGraphAnnealer<real>::~CPUDenseGraphAnnealer() {
 
 template<class real>
 void CPUDenseGraphAnnealer<real>::seed(unsigned long long seed) {
-    for (int idx = 0; idx < nMaxThreads_; ++idx)
-        random_[idx].seed(seed + 17 * idx);
+    seed_ = seed;
+    /* threads share the seed in the counter-based mode. */
+    for (int idx = 0; idx < nMaxThreads_; ++idx) {
+        random_[idx].seed(counterBased_ ? seed : seed + 17 * idx);
+        random_[idx].setCounterBased(counterBased_);
+    }
+    step_ = 0;
     setState(solRandSeedGiven);
 }
 
+template<class real>
+void CPUDenseGraphAnnealer<real>::setNumThreads(int nThreads) {
+    if (nThreads == nMaxThreads_)
+        return;
+    delete [] random_;
+    nMaxThreads_ = nThreads;
+    random_ = new CPURandom[nMaxThreads_];
+    /* reseed random number generators for the new number of threads. */
+    if (isRandSeedGiven())
+        seed(seed_);
+}
+
 
 template<class real>
 sq::Algorithm CPUDenseGraphAnnealer<real>::selectAlgorithm(enum sq::Algorithm algo) {
@@ -47,6 +79,12 @@ sq::Algorithm CPUDenseGraphAnnealer<real>::selectAlgorithm(enum sq::Algorithm al
         annealMethod_ = &CPUDenseGraphAnnealer::annealOneStepColoring;
         return sq::algoColoring;
         break;
+    case sq::algoLocalField:
+        annealMethod_ = &CPUDenseGraphAnnealer::annealOneStepLocalField;
+        return sq::algoLocalField;
+    case sq::algoMultiSpinCoding:
+        annealMethod_ = &CPUDenseGraphAnnealer::annealOneStepMultiSpinCoding;
+        return sq::algoMultiSpinCoding;
     default:
         sq::log("Uknown algo, %s, defaulting to %s.",
                 sq::algorithmToString(algo), sq::algorithmToString(sq::algoColoring));
@@ -61,6 +99,10 @@ sq::Algorithm CPUDenseGraphAnnealer<real>::getAlgorithm() const {
         return sq::algoNaive;
     if (annealMethod_ == &CPUDenseGraphAnnealer::annealOneStepColoring)
         return sq::algoColoring;
+    if (annealMethod_ == &CPUDenseGraphAnnealer::annealOneStepLocalField)
+        return sq::algoLocalField;
+    if (annealMethod_ == &CPUDenseGraphAnnealer::annealOneStepMultiSpinCoding)
+        return sq::algoMultiSpinCoding;
     abort_("Must not reach here.");
     return sq::algoDefault; /* to suppress warning. */
 }
@@ -84,6 +126,10 @@ void CPUDenseGraphAnnealer<real>::setQUBO(const Matrix &W, sq::OptimizeMethod om
         J_ *= real(-1.);
         c_ *= real(-1.);
     }
+    localFieldValid_ = false;
+    packedJValid_ = false;
+    acceptance_.clearLocalFieldRange();
+    acceptance_.addLocalFieldRange(h_, J_);
     setState(solProblemSet);
 }
 
@@ -97,14 +143,41 @@ void CPUDenseGraphAnnealer<real>::setHamiltonian(const Vector &h, const Matrix &
     sq::mapFrom(h_) = h;
     sq::mapFrom(J_) = J;
     c_ = c;
+    localFieldValid_ = false;
+    packedJValid_ = false;
+    acceptance_.clearLocalFieldRange();
+    acceptance_.addLocalFieldRange(h_, J_);
     setState(solProblemSet);
 }
 
 
+template<class real>
+void CPUDenseGraphAnnealer<real>::setPreference(const sq::Preference &pref) {
+    if (pref.name == sq::pnNumThreads) {
+        throwErrorIf(pref.nThreads <= 0, "# threads must be a positive integer.");
+        setNumThreads(pref.nThreads);
+    }
+    else if (pref.name == sq::pnAcceptance) {
+        acceptance_.setMethod(pref.acceptance);
+    }
+    else if (pref.name == sq::pnRandom) {
+        throwErrorIf(pref.rng == sq::rngUnknown, "Unknown random number generator.");
+        counterBased_ = (pref.rng == sq::rngCounterBased);
+        if (isRandSeedGiven())
+            seed(seed_);
+    }
+    else {
+        Base::setPreference(pref);
+    }
+}
+
 template<class real>
 sq::Preferences CPUDenseGraphAnnealer<real>::getPreferences() const {
     sq::Preferences prefs = Base::getPreferences();
     prefs.pushBack(sq::Preference(sq::pnDevice, "cpu"));
+    prefs.pushBack(sq::Preference(sq::pnNumThreads, nMaxThreads_));
+    prefs.pushBack(sq::Preference(sq::pnRandom, counterBased_ ? sq::rngCounterBased : sq::rngDefault));
+    prefs.pushBack(sq::Preference(sq::pnAcceptance, acceptance_.getMethod()));
     return prefs;
 }
 
@@ -119,7 +192,15 @@ template<class real>
 const sq::BitSetArray &CPUDenseGraphAnnealer<real>::get_x() const {
     if (!isSolutionAvailable())
         const_cast<This*>(this)->makeSolution();
-    return bitsX_;
+    const_cast<This*>(this)->syncBitSets();
+    return bitSetsX_;
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::get_x(sq::BitMatrix *x) const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    sq::copyToMatrix(x, bitsX_);
 }
 
 template<class real>
@@ -130,7 +211,10 @@ void CPUDenseGraphAnnealer<real>::set_x(const sq::BitSet &x) {
                  "Dimension of x, %d,  should be equal to N, %d.", x.size, N_);
     
     EigenRowVector ex = mapToRowVector(sq::cast<real>(x));
-    matQ_ = (ex.array() * 2 - 1).matrix();
+    sq::mapToAligned(matQ_).rowwise() = (ex.array() * 2 - 1).matrix();
+    matQValid_ = true;
+    packedQValid_ = false;
+    localFieldValid_ = false;
     setState(solQSet);
 }
 
@@ -146,15 +230,29 @@ template<class real>
 const sq::BitSetArray &CPUDenseGraphAnnealer<real>::get_q() const {
     if (!isSolutionAvailable())
         const_cast<This*>(this)->makeSolution();
-    return bitsQ_;
+    const_cast<This*>(this)->syncBitSets();
+    return bitSetsQ_;
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::get_q(sq::BitMatrix *q) const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    sq::copyToMatrix(q, bitsQ_);
 }
 
 template<class real>
 void CPUDenseGraphAnnealer<real>::randomizeSpin() {
     throwErrorIfNotPrepared();
-    real *q = matQ_.data();
-    for (int idx = 0; idx < sq::IdxType(N_ * m_); ++idx)
-        q[idx] = random_->randInt(2) ? real(1.) : real(-1.);
+    for (int y = 0; y < sq::IdxType(m_); ++y) {
+        random_[0].seek(step_, y, 0);
+        for (int x = 0; x < sq::IdxType(N_); ++x)
+            matQ_(y, x) = random_[0].randInt(2) ? real(1.) : real(-1.);
+    }
+    ++step_;
+    matQValid_ = true;
+    packedQValid_ = false;
+    localFieldValid_ = false;
     setState(solQSet);
 }
 
@@ -163,10 +261,13 @@ void CPUDenseGraphAnnealer<real>::prepare() {
     if (!isRandSeedGiven())
         seed((unsigned long long)time(NULL));
     setState(solRandSeedGiven);
-    bitsX_.reserve(m_);
-    bitsQ_.reserve(m_);
-    matQ_.resize(m_, N_);;
+    bitsX_.resize(m_, N_);
+    bitsQ_.resize(m_, N_);
+    matQ_.resize(m_, N_, sq::paddedStride<real>(N_));
     E_.resize(m_);
+    matQValid_ = true;
+    packedQValid_ = false;
+    localFieldValid_ = false;
 
     setState(solPrepared);
 }
@@ -174,6 +275,7 @@ void CPUDenseGraphAnnealer<real>::prepare() {
 template<class real>
 void CPUDenseGraphAnnealer<real>::makeSolution() {
     throwErrorIfQNotSet();
+    syncQ();
     syncBits();
     setState(solSolutionAvailable);
     calculate_E();
@@ -183,7 +285,8 @@ void CPUDenseGraphAnnealer<real>::makeSolution() {
 template<class real>
 void CPUDenseGraphAnnealer<real>::calculate_E() {
     throwErrorIfQNotSet();
-    DGFuncs<real>::calculate_E(&E_, sq::mapFrom(h_), sq::mapFrom(J_), c_, sq::mapFrom(matQ_));
+    syncQ();
+    DGFuncs<real>::calculate_E(&E_, sq::mapFrom(h_), sq::mapFrom(J_), c_, matQ_);
     if (om_ == sq::optMaximize)
         mapToRowVector(E_) *= real(-1.);
     setState(solEAvailable);
@@ -192,30 +295,42 @@ void CPUDenseGraphAnnealer<real>::calculate_E() {
 
 template<class real>
 void CPUDenseGraphAnnealer<real>::syncBits() {
-    bitsX_.clear();
-    bitsQ_.clear();
     for (int idx = 0; idx < sq::IdxType(m_); ++idx) {
-        sq::BitSet q = sq::extractRow<char>(matQ_, idx);
-        bitsQ_.pushBack(q);
-        bitsX_.pushBack(x_from_q(q));
+        for (int x = 0; x < sq::IdxType(N_); ++x)
+            bitsQ_(idx, x) = (char)matQ_(idx, x);
     }
+    sq::x_from_q(bitsX_.data, bitsQ_.data, m_ * N_);
+    bitSetsValid_ = false;
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::syncBitSets() {
+    if (bitSetsValid_)
+        return;
+    bitSetsX_.clear();
+    bitSetsQ_.clear();
+    bitSetsX_.reserve(m_);
+    bitSetsQ_.reserve(m_);
+    for (int idx = 0; idx < sq::IdxType(m_); ++idx) {
+        bitSetsX_.pushBack(sq::BitSet(&bitsX_(idx, 0), N_));
+        bitSetsQ_.pushBack(sq::BitSet(&bitsQ_(idx, 0), N_));
+    }
+    bitSetsValid_ = true;
 }
 
 
 template<class real> inline static
-void tryFlip(sq::EigenMatrixType<real> &matQ, int y, const sq::EigenRowVectorType<real> &h, const sq::EigenMatrixType<real> &J, 
-             sq::Random &random, real twoDivM, real coef, real beta) {
+void tryFlip(sq::EigenAlignedMappedMatrixType<real> &matQ, int y, const sq::EigenRowVectorType<real> &h, const sq::EigenMatrixType<real> &J, 
+             CPURandom &random, const CPUAcceptance<real> &acceptance) {
     int N = J.rows();
     int m = matQ.rows();
     int x = random.randInt(N);
     real qyx = matQ(y, x);
     real sum = J.row(x).dot(matQ.row(y));
-    real dE = twoDivM * qyx * (h(x) + sum);
     int neibour0 = (y == 0) ? m - 1 : y - 1;
     int neibour1 = (y == m - 1) ? 0 : y + 1;
-    dE -= qyx * (matQ(neibour0, x) + matQ(neibour1, x)) * coef;
-    real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE * beta);
-    if (threshold > random.random<real>())
+    real qNeibour = qyx * (matQ(neibour0, x) + matQ(neibour1, x));
+    if (acceptance.accept(qyx * (h(x) + sum), qNeibour, random.random<real>()))
         matQ(y, x) = - qyx;
 }
 
@@ -223,56 +338,391 @@ void tryFlip(sq::EigenMatrixType<real> &matQ, int y, const sq::EigenRowVectorTyp
 template<class real>
 void CPUDenseGraphAnnealer<real>::annealOneStepNaive(real G, real beta) {
     throwErrorIfQNotSet();
+    syncQ();
 
     real twoDivM = real(2.) / real(m_);
     real coef = std::log(std::tanh(G * beta / m_)) * beta;
-    sq::Random &random = random_[0];
+    acceptance_.prepare(twoDivM, coef, beta);
+    CPURandom &random = random_[0];
+    random.seek(step_, 0, 0);
+    EigenAlignedMappedMatrix matQ(sq::mapToAligned(matQ_));
     for (int loop = 0; loop < sq::IdxType(N_ * m_); ++loop) {
         int y = random.randInt(m_);
-        tryFlip(matQ_, y, h_, J_, random, twoDivM, coef, beta);
+        tryFlip(matQ, y, h_, J_, random, acceptance_);
     }
+    ++step_;
+    packedQValid_ = false;
+    localFieldValid_ = false;
     clearState(solSolutionAvailable);
 }
 
 
+/* annealColoredPlane() is called by all threads in a parallel region. */
+
 template<class real>
-void CPUDenseGraphAnnealer<real>::annealColoredPlane(real G, real beta, int stepOffset) {
+void CPUDenseGraphAnnealer<real>::annealColoredPlane(CPURandom &random, int iPlane) {
+    EigenAlignedMappedMatrix matQ(sq::mapToAligned(matQ_));
+#ifndef _OPENMP
+    /* single thread */
+    for (int yOffset = 0; yOffset < 2; ++yOffset) {
+        for (int y = yOffset; y < m_; y += 2) {
+            random.seek(step_, y, iPlane);
+            tryFlip(matQ, y, h_, J_, random, acceptance_);
+        }
+    }
+#else
+    sq::IdxType m2 = (m_ / 2) * 2; /* round down */
+    for (int yOffset = 0; yOffset < 2; ++yOffset) {
+#  pragma omp for
+        for (int y = yOffset; y < m2; y += 2) {
+            random.seek(step_, y, iPlane);
+            tryFlip(matQ, y, h_, J_, random, acceptance_);
+        }
+#  pragma omp single
+        if ((m_ % 2) != 0) { /* m is odd. */
+            CPURandom &random = random_[0];
+            random.seek(step_, m_ - 1, iPlane);
+            tryFlip(matQ, m_ - 1, h_, J_, random, acceptance_);
+        }
+    }
+#endif
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::annealOneStepColoring(real G, real beta) {
+    throwErrorIfQNotSet();
+    syncQ();
+
     real twoDivM = real(2.) / real(m_);
     real coef = std::log(std::tanh(G * beta / m_)) * beta;
+    acceptance_.prepare(twoDivM, coef, beta);
+    /* a parallel region is opened once for all planes. */
+#ifndef _OPENMP
+    for (int idx = 0; idx < (sq::IdxType)N_; ++idx)
+        annealColoredPlane(random_[0], idx);
+#else
+#  pragma omp parallel num_threads(nMaxThreads_)
+    {
+        CPURandom &random = random_[omp_get_thread_num()];
+        for (int idx = 0; idx < (sq::IdxType)N_; ++idx)
+            annealColoredPlane(random, idx);
+    }
+#endif
+    ++step_;
+    packedQValid_ = false;
+    localFieldValid_ = false;
+    clearState(solSolutionAvailable);
+}
+
+
+/* local field cache, matLocalField_(y, x) = h(x) + sum_j J(x, j) q(y, j).
+ * J is symmetric, so the cache for all trotters is given by q J + h.
+ * It's updated only when a flip is accepted, and a rejected flip costs O(1).
+ * It's recalculated every localFieldResyncInterval steps not to accumulate rounding errors. */
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::updateLocalField() {
+    matLocalField_.resize(m_, N_, sq::paddedStride<real>(N_));
+    EigenAlignedMappedMatrix localField(sq::mapToAligned(matLocalField_));
+    localField.noalias() = sq::mapToAligned(matQ_) * J_;
+    localField.rowwise() += h_;
+    localFieldValid_ = true;
+    nIncrementalSteps_ = 0;
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::getLocalField(Matrix *localField) const {
+    throwErrorIf(!localFieldValid_, "Local fields are not calculated.");
+    localField->resize(m_, N_);
+    mapTo(*localField) = sq::mapToAligned(matLocalField_);
+}
+
+template<class real> inline static
+void tryFlipLocalField(sq::EigenAlignedMappedMatrixType<real> &matQ,
+                       sq::EigenAlignedMappedMatrixType<real> &matLocalField,
+                       int y, const sq::EigenMatrixType<real> &J,
+                       CPURandom &random, const CPUAcceptance<real> &acceptance) {
+    int N = J.rows();
+    int m = matQ.rows();
+    int x = random.randInt(N);
+    real qyx = matQ(y, x);
+    int neibour0 = (y == 0) ? m - 1 : y - 1;
+    int neibour1 = (y == m - 1) ? 0 : y + 1;
+    real qNeibour = qyx * (matQ(neibour0, x) + matQ(neibour1, x));
+    if (acceptance.accept(qyx * matLocalField(y, x), qNeibour, random.random<real>())) {
+        matQ(y, x) = - qyx;
+        /* q(y, x) changes by -2 qyx. */
+        matLocalField.row(y) += (real(-2.) * qyx) * J.row(x);
+    }
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::annealColoredPlaneLocalField(CPURandom &random, int iPlane) {
+    EigenAlignedMappedMatrix matQ(sq::mapToAligned(matQ_));
+    EigenAlignedMappedMatrix matLocalField(sq::mapToAligned(matLocalField_));
 #ifndef _OPENMP
     /* single thread */
-    sq::Random &random = random_[0];
     for (int yOffset = 0; yOffset < 2; ++yOffset) {
-        for (int y = yOffset; y < m_; y += 2)
-            tryFlip(matQ_, y, h_, J_, random, twoDivM, coef, beta);
+        for (int y = yOffset; y < m_; y += 2) {
+            random.seek(step_, y, iPlane);
+            tryFlipLocalField(matQ, matLocalField, y, J_, random, acceptance_);
+        }
     }
 #else
     sq::IdxType m2 = (m_ / 2) * 2; /* round down */
-#  pragma omp parallel
-    {
-        sq::Random &random = random_[omp_get_thread_num()];
-        for (int yOffset = 0; yOffset < 2; ++yOffset) {
+    for (int yOffset = 0; yOffset < 2; ++yOffset) {
 #  pragma omp for
-            for (int y = yOffset; y < m2; y += 2) {
-                tryFlip(matQ_, y, h_, J_, random, twoDivM, coef, beta);
-            }
+        for (int y = yOffset; y < m2; y += 2) {
+            random.seek(step_, y, iPlane);
+            tryFlipLocalField(matQ, matLocalField, y, J_, random, acceptance_);
+        }
 #  pragma omp single
-            if ((m_ % 2) != 0) { /* m is odd. */
-                sq::Random &random = random_[0];
-                tryFlip(matQ_, m_ - 1, h_, J_, random, twoDivM, coef, beta);
+        if ((m_ % 2) != 0) { /* m is odd. */
+            CPURandom &random = random_[0];
+            random.seek(step_, m_ - 1, iPlane);
+            tryFlipLocalField(matQ, matLocalField, m_ - 1, J_, random, acceptance_);
+        }
+    }
+#endif
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::annealOneStepLocalField(real G, real beta) {
+    throwErrorIfQNotSet();
+    syncQ();
+
+    if (!localFieldValid_ || (localFieldResyncInterval <= nIncrementalSteps_))
+        updateLocalField();
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G * beta / m_)) * beta;
+    acceptance_.prepare(twoDivM, coef, beta);
+#ifndef _OPENMP
+    for (int idx = 0; idx < (sq::IdxType)N_; ++idx)
+        annealColoredPlaneLocalField(random_[0], idx);
+#else
+#  pragma omp parallel num_threads(nMaxThreads_)
+    {
+        CPURandom &random = random_[omp_get_thread_num()];
+        for (int idx = 0; idx < (sq::IdxType)N_; ++idx)
+            annealColoredPlaneLocalField(random, idx);
+    }
+#endif
+    ++step_;
+    ++nIncrementalSteps_;
+    packedQValid_ = false;
+    clearState(solSolutionAvailable);
+}
+
+
+
+/* multi-spin coding
+ *
+ * Spins are packed into 64-bit words, a bit is set for q = 1 (s = (q + 1) / 2).
+ * J is represented as JScale_ x Jint, and Jint + offset, offset = 2^(nJBits - 1),
+ * is stored as nJBits bit-planes, so that
+ *   sum_j Jint(x, j) s_j = sum_b 2^b popcount(plane_b(x) & s) - offset popcount(s),
+ *   sum_j Jint(x, j) q_j = 2 sum_j Jint(x, j) s_j - sum_j Jint(x, j).
+ * J is used as it is if it's integer-valued (up to a power-of-2 factor),
+ * otherwise quantized to maxQuantizedJBits bits. */
+
+enum {
+    maxIntegerJBits = 16,
+    maxQuantizedJBits = 8,
+};
+
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+/* popcnt instruction is selected at runtime. */
+#  define SQAODC_POPCNT_CLONES __attribute__((target_clones("popcnt", "default")))
+#else
+#  define SQAODC_POPCNT_CLONES
+#endif
+
+inline static
+int popCount(sq::PackedBitSet v) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+/* returns sum_j Jint(x, j) s_j */
+SQAODC_POPCNT_CLONES static
+long long packedDot(const sq::PackedBitSet *planes, const sq::PackedBitSet *s,
+                    int nWords, int nBits) {
+    long long nOnes = 0;
+    for (int iw = 0; iw < nWords; ++iw)
+        nOnes += popCount(s[iw]);
+    long long sum = 0;
+    for (int ib = 0; ib < nBits; ++ib) {
+        const sq::PackedBitSet *plane = &planes[ib * nWords];
+        long long count = 0;
+        for (int iw = 0; iw < nWords; ++iw)
+            count += popCount(plane[iw] & s[iw]);
+        sum += count << ib;
+    }
+    return sum - (nOnes << (nBits - 1));
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::packJ() {
+    /* find a power-of-2 factor to make J integer-valued. */
+    EigenMatrix Jint;
+    nJBits_ = 0;
+    for (real mul = real(1.); mul <= real(16.); mul *= real(2.)) {
+        Jint = J_ * mul;
+        if (!(Jint.array() == Jint.array().round()).all())
+            continue;
+        real maxAbs = Jint.cwiseAbs().maxCoeff();
+        int nBits = 1;
+        while ((nBits < maxIntegerJBits) && (real((1 << (nBits - 1)) - 1) < maxAbs))
+            ++nBits;
+        if (real((1 << (nBits - 1)) - 1) < maxAbs)
+            break;
+        nJBits_ = nBits;
+        JScale_ = real(1.) / mul;
+        break;
+    }
+    if (nJBits_ == 0) {
+        real maxAbs = J_.cwiseAbs().maxCoeff();
+        nJBits_ = maxQuantizedJBits;
+        JScale_ = maxAbs / real((1 << (nJBits_ - 1)) - 1);
+        Jint = (J_ / JScale_).array().round().matrix();
+        sq::log("J is not integer-valued, quantized to %d bits for multi-spin coding.", nJBits_);
+    }
+
+    nWords_ = (N_ + 63) / 64;
+    packedJ_.setZero(N_, nJBits_ * nWords_);
+    JRowSum_ = Jint.rowwise().sum().transpose();
+    long long offset = 1LL << (nJBits_ - 1);
+    for (int x = 0; x < N_; ++x) {
+        for (int j = 0; j < N_; ++j) {
+            long long v = (long long)Jint(x, j) + offset;
+            sq::PackedBitSet bit = sq::PackedBitSet(1) << (j % 64);
+            for (int ib = 0; ib < nJBits_; ++ib) {
+                if ((v >> ib) & 1)
+                    packedJ_(x, ib * nWords_ + j / 64) |= bit;
             }
         }
     }
+    packedJValid_ = true;
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::packQ() {
+    packedQ_.resize(m_, nWords_, sq::paddedStride<sq::PackedBitSet>(nWords_));
+    sq::mapToAligned(packedQ_).setZero();
+    for (int y = 0; y < m_; ++y) {
+        for (int x = 0; x < N_; ++x) {
+            if (real(0.) < matQ_(y, x))
+                packedQ_(y, x / 64) |= sq::PackedBitSet(1) << (x % 64);
+        }
+    }
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::unpackQ() {
+    for (int y = 0; y < m_; ++y) {
+        for (int x = 0; x < N_; ++x) {
+            bool bit = ((packedQ_(y, x / 64) >> (x % 64)) & 1) != 0;
+            matQ_(y, x) = bit ? real(1.) : real(-1.);
+        }
+    }
+}
+
+/* matQ_ is unpacked only when it's referred, annealing steps of multi-spin coding do not touch it. */
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::syncQ() {
+    if (matQValid_)
+        return;
+    unpackQ();
+    matQValid_ = true;
+}
+
+template<class real> inline static
+real unpackedQ(const sq::MatrixType<sq::PackedBitSet> &packedQ, int y, int x) {
+    return ((packedQ(y, x / 64) >> (x % 64)) & 1) ? real(1.) : real(-1.);
+}
+
+template<class real> inline static
+void tryFlipMultiSpinCoding(sq::MatrixType<sq::PackedBitSet> &packedQ, int y,
+                            const sq::EigenRowVectorType<real> &h,
+                            const sq::EigenMatrixType<sq::PackedBitSet> &packedJ,
+                            const sq::EigenRowVectorType<real> &JRowSum, real JScale, int nJBits,
+                            CPURandom &random, const CPUAcceptance<real> &acceptance) {
+    int N = h.cols();
+    int m = packedQ.rows;
+    int nWords = packedQ.cols;
+    int x = random.randInt(N);
+    real qyx = unpackedQ<real>(packedQ, y, x);
+    long long sum = packedDot(&packedJ(x, 0), &packedQ(y, 0), nWords, nJBits);
+    real Jq = JScale * (real(2 * sum) - JRowSum(x));
+    int neibour0 = (y == 0) ? m - 1 : y - 1;
+    int neibour1 = (y == m - 1) ? 0 : y + 1;
+    real qNeibour = qyx * (unpackedQ<real>(packedQ, neibour0, x) + unpackedQ<real>(packedQ, neibour1, x));
+    if (acceptance.accept(qyx * (h(x) + Jq), qNeibour, random.random<real>()))
+        packedQ(y, x / 64) ^= sq::PackedBitSet(1) << (x % 64);
+}
+
+template<class real>
+void CPUDenseGraphAnnealer<real>::annealColoredPlaneMultiSpinCoding(CPURandom &random, int iPlane) {
+#ifndef _OPENMP
+    /* single thread */
+    for (int yOffset = 0; yOffset < 2; ++yOffset) {
+        for (int y = yOffset; y < m_; y += 2) {
+            random.seek(step_, y, iPlane);
+            tryFlipMultiSpinCoding(packedQ_, y, h_, packedJ_, JRowSum_, JScale_, nJBits_,
+                                   random, acceptance_);
+        }
+    }
+#else
+    sq::IdxType m2 = (m_ / 2) * 2; /* round down */
+    for (int yOffset = 0; yOffset < 2; ++yOffset) {
+#  pragma omp for
+        for (int y = yOffset; y < m2; y += 2) {
+            random.seek(step_, y, iPlane);
+            tryFlipMultiSpinCoding(packedQ_, y, h_, packedJ_, JRowSum_, JScale_, nJBits_,
+                                   random, acceptance_);
+        }
+#  pragma omp single
+        if ((m_ % 2) != 0) { /* m is odd. */
+            CPURandom &random = random_[0];
+            random.seek(step_, m_ - 1, iPlane);
+            tryFlipMultiSpinCoding(packedQ_, m_ - 1, h_, packedJ_, JRowSum_, JScale_, nJBits_,
+                                   random, acceptance_);
+        }
+    }
 #endif
 }
 
 template<class real>
-void CPUDenseGraphAnnealer<real>::annealOneStepColoring(real G, real beta) {
+void CPUDenseGraphAnnealer<real>::annealOneStepMultiSpinCoding(real G, real beta) {
     throwErrorIfQNotSet();
-    
-    int stepOffset = random_[0].randInt(2);
+
+    if (!packedJValid_)
+        packJ();
+    if (!packedQValid_) {
+        packQ();
+        packedQValid_ = true;
+    }
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G * beta / m_)) * beta;
+    acceptance_.prepare(twoDivM, coef, beta);
+#ifndef _OPENMP
     for (int idx = 0; idx < (sq::IdxType)N_; ++idx)
-        annealColoredPlane(G, beta, (stepOffset + idx) & 1);
+        annealColoredPlaneMultiSpinCoding(random_[0], idx);
+#else
+#  pragma omp parallel num_threads(nMaxThreads_)
+    {
+        CPURandom &random = random_[omp_get_thread_num()];
+        for (int idx = 0; idx < (sq::IdxType)N_; ++idx)
+            annealColoredPlaneMultiSpinCoding(random, idx);
+    }
+#endif
+    ++step_;
+    matQValid_ = false;
+    localFieldValid_ = false;
     clearState(solSolutionAvailable);
 }
 
@@ -3,6 +3,8 @@
 
 #include <sqaodc/common/Common.h>
 #include <sqaodc/common/EigenBridge.h>
+#include <sqaodc/cpu/CPURandom.h>
+#include <sqaodc/cpu/CPUAcceptance.h>
 
 namespace sqaod_cpu {
 
@@ -13,6 +15,7 @@ class CPUDenseGraphAnnealer : public sq::DenseGraphAnnealer<real> {
 
     typedef sq::EigenMatrixType<real> EigenMatrix;
     typedef sq::EigenRowVectorType<real> EigenRowVector;
+    typedef sq::EigenAlignedMappedMatrixType<real> EigenAlignedMappedMatrix;
     typedef sq::MatrixType<real> Matrix;
     typedef sq::VectorType<real> Vector;
 
@@ -32,7 +35,9 @@ public:
 
     void setHamiltonian(const Vector &h, const Matrix &J, real c = real(0.));
 
-    /* void setPreference(const Preference &pref); */
+    void setPreference(const sq::Preference &pref);
+
+    using sq::Solver<real>::setPreference;
 
     sq::Preferences getPreferences() const;
 
@@ -40,10 +45,14 @@ public:
 
     const sq::BitSetArray &get_x() const;
 
+    void get_x(sq::BitMatrix *x) const;
+
     void set_x(const sq::BitSet &x);
 
     const sq::BitSetArray &get_q() const;
 
+    void get_q(sq::BitMatrix *q) const;
+
     void getHamiltonian(Vector *h, Matrix *J, real *c) const;
 
     void randomizeSpin();
@@ -60,22 +69,62 @@ public:
 
     void annealOneStepNaive(real G, real beta);
     void annealOneStepColoring(real G, real beta);
+    void annealOneStepLocalField(real G, real beta);
+    void annealOneStepMultiSpinCoding(real G, real beta);
+
+    /* cached local fields of annealOneStepLocalField(), q J + h (m x N). */
+    void getLocalField(Matrix *localField) const;
 
 private:    
     typedef void (CPUDenseGraphAnnealer<real>::*AnnealMethod)(real G, real beta);
     AnnealMethod annealMethod_;
 
     /* actual annealing function for annealOneStepColored. */
-    void annealColoredPlane(real G, real beta, int offset);
+    void annealColoredPlane(CPURandom &random, int iPlane);
+    /* coloring with cached local fields, h + J q, for annealOneStepLocalField. */
+    void annealColoredPlaneLocalField(CPURandom &random, int iPlane);
+
+    void updateLocalField();
+
+    /* multi-spin coding, spins and bit-planes of integer J are packed into 64-bit words. */
+    void annealColoredPlaneMultiSpinCoding(CPURandom &random, int iPlane);
+    void packJ();
+    void packQ();
+    void unpackQ();
+    void syncQ();
 
     void syncBits();
+
+    void syncBitSets();
     
-    sq::Random *random_;
+    void setNumThreads(int nThreads);
+
+    CPURandom *random_;
     int nMaxThreads_;
+    unsigned long long seed_;
+    bool counterBased_;
+    unsigned int step_; /* counter for the counter-based random mode */
+    CPUAcceptance<real> acceptance_;
     Vector E_;
-    sq::BitSetArray bitsX_;
-    sq::BitSetArray bitsQ_;
-    EigenMatrix matQ_;
+    sq::BitMatrix bitsX_; /* m x N, synced by makeSolution() */
+    sq::BitMatrix bitsQ_;
+    sq::BitSetArray bitSetsX_; /* rows of bitsX_ and bitsQ_, created on get_x() and get_q(). */
+    sq::BitSetArray bitSetsQ_;
+    bool bitSetsValid_;
+    Matrix matQ_; /* m x N, rows are padded to cache lines. */
+    Matrix matLocalField_; /* m x N, h + J q for each trotter. */
+    bool localFieldValid_;
+    int nIncrementalSteps_; /* steps since matLocalField_ is calculated by GEMM */
+    sq::MatrixType<sq::PackedBitSet> packedQ_; /* m x nWords_, bit is set for q = 1. */
+    /* packedQ_ is the spin state of multi-spin coding, and unpacked to matQ_ on demand. */
+    bool packedQValid_;
+    bool matQValid_;
+    sq::EigenMatrixType<sq::PackedBitSet> packedJ_; /* N x (nJBits_ x nWords_) */
+    EigenRowVector JRowSum_; /* sum of rows of integer J */
+    real JScale_; /* J = JScale_ x integer J */
+    int nJBits_;
+    int nWords_;
+    bool packedJValid_;
     EigenRowVector h_;
     EigenMatrix J_;
     real c_;
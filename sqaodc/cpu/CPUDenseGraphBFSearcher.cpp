@@ -1,10 +1,15 @@
 #include "CPUDenseGraphBFSearcher.h"
 #include "CPUDenseGraphBatchSearch.h"
+#include "CPUDenseGraphBranchAndBound.h"
+#include "CPURangeScheduler.h"
+#include <sqaodc/common/Checkpoint.h>
 #include <sqaodc/common/ShapeChecker.h>
 #include <cmath>
 
 #include <float.h>
+#include <limits.h>
 #include <algorithm>
+#include <vector>
 
 namespace sqint = sqaod_internal;
 using namespace sqaod_cpu;
@@ -12,6 +17,9 @@ using namespace sqaod_cpu;
 template<class real>
 CPUDenseGraphBFSearcher<real>::CPUDenseGraphBFSearcher() {
     tileSize_ = 1024;
+    algo_ = sq::algoGrayCode;
+    topK_ = 0;
+    energyWindow_ = real(-1.);
 #ifdef _OPENMP
     nMaxThreads_ = omp_get_max_threads();
     sq::log("# max threads: %d", nMaxThreads_);
@@ -19,18 +27,20 @@ CPUDenseGraphBFSearcher<real>::CPUDenseGraphBFSearcher() {
     nMaxThreads_ = 1;
 #endif
     searchers_ = new BatchSearcher[nMaxThreads_];
+    bnbs_ = new BranchAndBound[nMaxThreads_];
 }
 
 template<class real>
 CPUDenseGraphBFSearcher<real>::~CPUDenseGraphBFSearcher() {
     delete [] searchers_;
     searchers_ = NULL;
+    delete [] bnbs_;
+    bnbs_ = NULL;
 }
 
 template<class real>
 void CPUDenseGraphBFSearcher<real>::setQUBO(const Matrix &W, sq::OptimizeMethod om) {
     sqint::quboShapeCheck(W, __func__);
-    throwErrorIf(63 < N_, "N must be smaller than 64, N=%d.", N_);
     clearState(solProblemSet);
 
     N_ = W.rows;
@@ -42,10 +52,66 @@ void CPUDenseGraphBFSearcher<real>::setQUBO(const Matrix &W, sq::OptimizeMethod
     setState(solProblemSet);
 }
 
+template<class real> template<class V>
+void CPUDenseGraphBFSearcher<real>::setQUBO(const sq::MatrixType<V> &W, sq::OptimizeMethod om) {
+    Matrix Wr = sq::cast<real>(W);
+    for (sq::IdxType row = 0; row < W.rows; ++row) {
+        for (sq::IdxType col = 0; col < W.cols; ++col)
+            throwErrorIf(double(Wr(row, col)) != double(W(row, col)),
+                         "Weight, %d, is not exactly represented by %d-bit real.",
+                         int(W(row, col)), int(sizeof(real) * 8));
+    }
+    setQUBO(Wr, om);
+}
+
+template<class real>
+sq::Algorithm CPUDenseGraphBFSearcher<real>::selectAlgorithm(sq::Algorithm algo) {
+    switch (algo) {
+    case sq::algoBruteForceSearch:
+    case sq::algoBranchAndBound:
+        algo_ = algo;
+        break;
+    case sq::algoGrayCode:
+    case sq::algoDefault:
+        algo_ = sq::algoGrayCode;
+        break;
+    default:
+        sq::log("Uknown algo, %s, defaulting to %s.",
+                sq::algorithmToString(algo), sq::algorithmToString(sq::algoGrayCode));
+        algo_ = sq::algoGrayCode;
+    }
+    return algo_;
+}
+
+template<class real>
+sq::Algorithm CPUDenseGraphBFSearcher<real>::getAlgorithm() const {
+    return algo_;
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::setPreference(const sq::Preference &pref) {
+    if (pref.name == sq::pnTopK) {
+        throwErrorIf(pref.topK < 0, "top_k must not be negative.");
+        topK_ = pref.topK;
+        clearState(solPrepared);
+    }
+    else if (pref.name == sq::pnEnergyWindow) {
+        energyWindow_ = real(pref.energyWindow);
+        clearState(solPrepared);
+    }
+    else {
+        Base::setPreference(pref);
+    }
+}
+
 template<class real>
 sq::Preferences CPUDenseGraphBFSearcher<real>::getPreferences() const {
     sq::Preferences prefs = Base::getPreferences();
     prefs.pushBack(sq::Preference(sq::pnDevice, "cpu"));
+    if (0 < topK_)
+        prefs.pushBack(sq::Preference(sq::pnTopK, topK_));
+    if (0 <= energyWindow_)
+        prefs.pushBack(sq::Preference(sq::pnEnergyWindow, double(energyWindow_)));
     return prefs;
 }
 
@@ -65,17 +131,42 @@ const sq::VectorType<real> &CPUDenseGraphBFSearcher<real>::get_E() const {
 
 template<class real>
 void CPUDenseGraphBFSearcher<real>::prepare() {
+    throwErrorIfProblemNotSet();
+    if ((63 < N_) && !isBranchAndBound()) {
+        sq::log("N=%d is too large for %s, switched to %s.", N_,
+                sq::algorithmToString(algo_), sq::algorithmToString(sq::algoBranchAndBound));
+        algo_ = sq::algoBranchAndBound;
+    }
+
+    throwErrorIf(isBranchAndBound() && isCollecting(),
+                 "top_k and energy_window are not supported by %s.", sq::algorithmToString(algo_));
+
     Emin_ = FLT_MAX;
     xList_.clear();
     x_ = 0;
-    xMax_ = 1ull << N_;
-    if (xMax_ < (sq::PackedBitSet)tileSize_) {
-        tileSize_ = sq::SizeType(xMax_);
-        sq::log("Tile size is adjusted to %d for N=%d", tileSize_, N_);
+    if (isBranchAndBound()) {
+        nPrefixBits_ = std::min(N_, 10);
+        xMax_ = 1ull << nPrefixBits_;
+        for (int idx = 0; idx < nMaxThreads_; ++idx) {
+            bnbs_[idx].setQUBO(W_, tileSize_);
+            bnbs_[idx].initSearch();
+        }
+        Ebound_ = bnbs_[0].descend();
     }
-    for (int idx = 0; idx < nMaxThreads_; ++idx) {
-        searchers_[idx].setQUBO(W_, tileSize_);
-        searchers_[idx].initSearch();
+    else {
+        xMax_ = 1ull << N_;
+        if (xMax_ < (sq::PackedBitSet)tileSize_) {
+            tileSize_ = sq::SizeType(xMax_);
+            sq::log("Tile size is adjusted to %d for N=%d", tileSize_, N_);
+        }
+        for (int idx = 0; idx < nMaxThreads_; ++idx) {
+            searchers_[idx].setQUBO(W_, tileSize_);
+            searchers_[idx].initSearch();
+            searchers_[idx].collector_.reset(topK_, energyWindow_, tileSize_);
+        }
+        if (searchers_[0].intBits_ != 0)
+            sq::log("W is integer-valued, energies are evaluated by %d-bit integers.",
+                    searchers_[0].intBits_);
     }
     setState(solPrepared);
 
@@ -88,6 +179,20 @@ void CPUDenseGraphBFSearcher<real>::prepare() {
 template<class real>
 void CPUDenseGraphBFSearcher<real>::calculate_E() {
     throwErrorIfNotPrepared();
+    if (isCollecting()) {
+        /* energies of collected states differ, and are calculated from x. */
+        const sq::EigenMappedMatrixType<real> W(mapTo(W_));
+        sq::EigenRowVectorType<real> x(N_);
+        real sign = (om_ == sq::optMaximize) ? real(-1.) : real(1.);
+        E_.resize(xList_.size());
+        for (sq::IdxType idx = 0; idx < (sq::IdxType)xList_.size(); ++idx) {
+            for (int k = 0; k < N_; ++k)
+                x(k) = real(xList_[idx](k));
+            E_(idx) = sign * x.dot(x * W);
+        }
+        setState(solEAvailable);
+        return;
+    }
     if (xList_.empty())
         E_.resize(1);
     else
@@ -100,32 +205,95 @@ template<class real>
 void CPUDenseGraphBFSearcher<real>::makeSolution() {
     throwErrorIfNotPrepared();
 
+    if (isBranchAndBound()) {
+        makeSolutionBranchAndBound();
+        return;
+    }
+    if (isCollecting()) {
+        makeSolutionCollected();
+        return;
+    }
+
     xList_.clear();
     sq::PackedBitSetArray packedXList;
-    for (int idx = 0; idx < nMaxThreads_; ++idx) {
-        const BatchSearcher &searcher = searchers_[idx];
-        if (searcher.Emin_ < Emin_) {
-            Emin_ = searcher.Emin_;
-            packedXList = searcher.packedXList_;
-        }
-        else if (searcher.Emin_ == Emin_) {
-            if (packedXList.size() < tileSize_) {
-                packedXList.insert(searcher.packedXList_.begin(),
-                                   searcher.packedXList_.end());
-            }
-        }
-    }
+    long long EminInt = LLONG_MAX;
+    mergeSolutions(&Emin_, &EminInt, &packedXList);
     
     std::sort(packedXList.begin(), packedXList.end());
     int nSolutions = std::min(tileSize_, packedXList.size());
+    xList_.reserve(nSolutions);
     for (int idx = 0; idx < nSolutions; ++idx) {
         sq::BitSet bits;
         sq::unpackBitSet(&bits, packedXList[idx], N_);
+        xList_.pushBack(std::move(bits));
+    }
+    calculate_E();
+    setState(solSolutionAvailable);
+
+
+#ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
+    assert(rangeMap_.size() == 1);
+    sq::PackedBitSetPair pair = rangeMap_[0];
+    assert((pair.bits0 == 0) && (pair.bits1 == xMax_));
+#endif
+}
+
+
+/* collected states of threads are merged after searches, so no lock is required. */
+template<class real>
+void CPUDenseGraphBFSearcher<real>::makeSolutionCollected() {
+    typedef CPUSolutionCollector<real, sq::PackedBitSet> Collector;
+    Collector collector;
+    collector.reset(topK_, energyWindow_, tileSize_);
+    for (int idx = 0; idx < nMaxThreads_; ++idx)
+        collector.merge(searchers_[idx].collector_);
+    if (collector.isTruncated())
+        sq::log("More than %d states are in the energy window, the lowest %d states are collected.",
+                tileSize_, tileSize_);
+    std::vector<typename Collector::Entry> entries;
+    collector.getSolutions(&entries);
+
+    xList_.clear();
+    Emin_ = entries.empty() ? real(FLT_MAX) : entries[0].E;
+    for (size_t idx = 0; idx < entries.size(); ++idx) {
+        sq::BitSet bits;
+        sq::unpackBitSet(&bits, entries[idx].x, N_);
         xList_.pushBack(bits);
     }
     calculate_E();
     setState(solSolutionAvailable);
+}
 
+/* lexicographic order of x, which is the ascending order of packed x. */
+static bool bitSetLess(const sq::BitSet &lhs, const sq::BitSet &rhs) {
+    return std::lexicographical_compare(lhs.data, lhs.data + lhs.size,
+                                        rhs.data, rhs.data + rhs.size);
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::makeSolutionBranchAndBound() {
+    xList_.clear();
+    Emin_ = FLT_MAX;
+    for (int idx = 0; idx < nMaxThreads_; ++idx)
+        Emin_ = std::min(Emin_, bnbs_[idx].Emin_);
+
+    std::vector<sq::BitSet> xList;
+    for (int idx = 0; idx < nMaxThreads_; ++idx) {
+        const BranchAndBound &bnb = bnbs_[idx];
+        if (bnb.Emin_ != Emin_)
+            continue;
+        for (sq::IdxType iSol = 0; iSol < (sq::IdxType)bnb.getNumSolutions(); ++iSol) {
+            sq::BitSet x;
+            bnb.getSolution(&x, iSol);
+            xList.push_back(x);
+        }
+    }
+    std::sort(xList.begin(), xList.end(), bitSetLess);
+    int nSolutions = std::min(tileSize_, (sq::SizeType)xList.size());
+    for (int idx = 0; idx < nSolutions; ++idx)
+        xList_.pushBack(xList[idx]);
+    calculate_E();
+    setState(solSolutionAvailable);
 
 #ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
     assert(rangeMap_.size() == 1);
@@ -134,46 +302,238 @@ void CPUDenseGraphBFSearcher<real>::makeSolution() {
 #endif
 }
 
+/* merges solutions of threads.  For branch and bound, solutions are in the format of
+ * CPUDenseGraphBranchAndBound.  For integer-valued W, EminInt gives the exact Emin,
+ * and is left as LLONG_MAX otherwise. */
+template<class real>
+void CPUDenseGraphBFSearcher<real>::mergeSolutions(real *Emin, long long *EminInt,
+                                                   sq::PackedBitSetArray *packedXList) const {
+    packedXList->clear();
+    if (isBranchAndBound()) {
+        for (int idx = 0; idx < nMaxThreads_; ++idx)
+            *Emin = std::min(*Emin, bnbs_[idx].Emin_);
+        for (int idx = 0; idx < nMaxThreads_; ++idx) {
+            const BranchAndBound &bnb = bnbs_[idx];
+            if (bnb.Emin_ == *Emin) {
+                const sq::PackedBitSetArray &words = bnb.getPackedXList();
+                for (sq::IdxType iw = 0; iw < (sq::IdxType)words.size(); ++iw)
+                    packedXList->pushBack(words[iw]);
+            }
+        }
+        return;
+    }
+
+    if (searchers_[0].intBits_ != 0) {
+        /* energies are compared in integers, as values of real may be rounded. */
+        for (int idx = 0; idx < nMaxThreads_; ++idx)
+            *EminInt = std::min(*EminInt, searchers_[idx].EminInt_);
+        if (*EminInt == LLONG_MAX)
+            return;
+        *Emin = real(*EminInt);
+        for (int idx = 0; idx < nMaxThreads_; ++idx) {
+            const BatchSearcher &searcher = searchers_[idx];
+            if ((searcher.EminInt_ == *EminInt) && (packedXList->size() < tileSize_)) {
+                packedXList->insert(searcher.packedXList_.begin(),
+                                    searcher.packedXList_.end());
+            }
+        }
+        return;
+    }
+
+    for (int idx = 0; idx < nMaxThreads_; ++idx) {
+        const BatchSearcher &searcher = searchers_[idx];
+        if (searcher.Emin_ < *Emin) {
+            *Emin = searcher.Emin_;
+            *packedXList = searcher.packedXList_;
+        }
+        else if (searcher.Emin_ == *Emin) {
+            if (packedXList->size() < tileSize_) {
+                packedXList->insert(searcher.packedXList_.begin(),
+                                    searcher.packedXList_.end());
+            }
+        }
+    }
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::saveCheckpoint(const char *filename) const {
+    throwErrorIfNotPrepared();
+    throwErrorIf(isCollecting(), "Checkpoint is not supported with top_k or energy_window.");
+    real Emin = FLT_MAX;
+    long long EminInt = LLONG_MAX;
+    sq::PackedBitSetArray packedXList;
+    mergeSolutions(&Emin, &EminInt, &packedXList);
+
+    sq::CheckpointWriter writer(filename, sq::ckDenseGraphBFSearcher);
+    writer.write(int(sizeof(real)));
+    writer.write(N_);
+    writer.write(int(om_));
+    writer.write(sq::fingerprint(W_));
+    writer.write(int(algo_));
+    writer.write(tileSize_);
+    writer.write(x_);
+    writer.write(Emin);
+    writer.write(EminInt);
+    writer.writeArray(packedXList);
+    writer.commit();
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::resumeFromCheckpoint(const char *filename) {
+    throwErrorIfProblemNotSet();
+
+    sq::CheckpointReader reader(filename, sq::ckDenseGraphBFSearcher);
+    int realSize = reader.read<int>();
+    sq::SizeType N = reader.read<sq::SizeType>();
+    int om = reader.read<int>();
+    unsigned long long hash = reader.read<unsigned long long>();
+    throwErrorIf((realSize != (int)sizeof(real)) || (N != N_) || (om != (int)om_) ||
+                 (hash != sq::fingerprint(W_)), "Checkpoint does not match the problem.");
+    sq::Algorithm algo = (sq::Algorithm)reader.read<int>();
+    sq::SizeType tileSize = reader.read<sq::SizeType>();
+    sq::PackedBitSet x = reader.read<sq::PackedBitSet>();
+    real Emin = reader.read<real>();
+    long long EminInt = reader.read<long long>();
+    sq::PackedBitSetArray packedXList;
+    reader.readArray(&packedXList);
+    reader.finish();
+
+    algo_ = algo;
+    tileSize_ = tileSize;
+    prepare();
+    throwErrorIf(xMax_ < x, "Checkpoint is broken.");
+    x_ = x;
+    if (isBranchAndBound()) {
+        bnbs_[0].restore(Emin, packedXList);
+        Ebound_ = std::min(Ebound_, Emin);
+    }
+    else {
+        searchers_[0].restore(Emin, EminInt, packedXList);
+    }
+#ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
+    if (0 < x_)
+        rangeMap_.insert(0, x_);
+#endif
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::searchPartial(sq::PackedBitSet xBegin, sq::PackedBitSet xEnd,
+                                                  sq::DenseGraphBFPartialResult<real> *partial) {
+    prepare();
+    throwErrorIf(isBranchAndBound(), "Partial search is not supported by %s.",
+                 sq::algorithmToString(algo_));
+    throwErrorIf(isCollecting(), "Partial search is not supported with top_k or energy_window.");
+    throwErrorIf((xEnd < xBegin) || (xMax_ < xEnd),
+                 "Range, [%llu, %llu), is out of the search space.", xBegin, xEnd);
+    x_ = xBegin;
+    if (xBegin < xEnd)
+        searchBudget(xEnd - xBegin, NULL);
+
+    partial->N = N_;
+    partial->om = om_;
+    partial->algo = algo_;
+    partial->problemHash = sq::fingerprint(W_);
+    partial->Emin = FLT_MAX;
+    partial->EminInt = LLONG_MAX;
+    mergeSolutions(&partial->Emin, &partial->EminInt, &partial->packedXList);
+    partial->ranges.clear();
+    partial->ranges.pushBack(sq::PackedBitSetPair(xBegin, xEnd));
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::setPartialResult(const sq::DenseGraphBFPartialResult<real> &partial) {
+    throwErrorIfProblemNotSet();
+    throwErrorIf((partial.N != N_) || (partial.om != om_) ||
+                 (partial.problemHash != sq::fingerprint(W_)),
+                 "Partial result does not match the problem.");
+    prepare();
+    throwErrorIf(isBranchAndBound(), "Partial search is not supported by %s.",
+                 sq::algorithmToString(algo_));
+    throwErrorIf(isCollecting(), "Partial search is not supported with top_k or energy_window.");
+    throwErrorIf(partial.algo != algo_, "Partial result is searched by %s, but %s is selected.",
+                 sq::algorithmToString(partial.algo), sq::algorithmToString(algo_));
+    if (!partial.covers(xMax_))
+        sq::log("Partial results do not cover the whole search space.");
+    searchers_[0].restore(partial.Emin, partial.EminInt, partial.packedXList);
+    x_ = xMax_;
+#ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
+    rangeMap_.insert(0, xMax_);
+#endif
+}
+
+template<class real>
+void CPUDenseGraphBFSearcher<real>::searchChunk(int threadNum, sq::PackedBitSet chunkBegin,
+                                                sq::PackedBitSet chunkEnd) {
+    if (isBranchAndBound()) {
+        /* a chunk is a set of prefixes of the search tree.  The best energy is shared
+         * among threads to prune subtrees. */
+        BranchAndBound &bnb = bnbs_[threadNum];
+        for (sq::PackedBitSet prefix = chunkBegin; prefix < chunkEnd; ++prefix) {
+            real Ebound;
+#ifdef _OPENMP
+#pragma omp critical (CPUDenseGraphBFSearcher_Ebound)
+#endif
+            {
+                Ebound_ = std::min(Ebound_, bnb.Emin_);
+                Ebound = Ebound_;
+            }
+            bnb.searchPrefix(prefix, nPrefixBits_, Ebound);
+        }
+    }
+    else if (algo_ == sq::algoGrayCode) {
+        /* gray code search visits gray(i) for i in [chunkBegin, chunkEnd), so chunks cover
+         * the whole search space in the same manner as the naive search. */
+        searchers_[threadNum].searchRangeGrayCode(chunkBegin, chunkEnd);
+    }
+    else {
+        searchers_[threadNum].searchRange(chunkBegin, chunkEnd);
+    }
+}
 
 template<class real>
 bool CPUDenseGraphBFSearcher<real>::searchRange(sq::PackedBitSet *curXEnd) {
+    sq::PackedBitSet budget = nMaxThreads_;
+    if (!isBranchAndBound())
+        budget *= tileSize_;
+    return searchBudget(budget, curXEnd);
+}
+
+template<class real>
+bool CPUDenseGraphBFSearcher<real>::searchBudget(sq::PackedBitSet budget,
+                                                 sq::PackedBitSet *curXEnd) {
     throwErrorIfNotPrepared();
     clearState(solSolutionAvailable);
+
+    sq::PackedBitSet xEnd = (xMax_ - x_ <= budget) ? xMax_ : x_ + budget;
+    /* chunks for the naive search are limited by tileSize, the size of batch matrices. */
+    if (isBranchAndBound())
+        scheduler_.reset(x_, xEnd, nMaxThreads_, 1, 1);
+    else
+        scheduler_.reset(x_, xEnd, nMaxThreads_, std::max(tileSize_ / 16, 1), tileSize_);
+
 #ifdef _OPENMP
 #pragma omp parallel
     {
-        sq::SizeType threadNum = omp_get_thread_num();
-        sq::PackedBitSet batchBegin = x_ + tileSize_ * threadNum;
-        sq::PackedBitSet batchEnd = x_ + tileSize_ * (threadNum + 1);
-        batchBegin = std::min(std::max(0ULL, batchBegin), xMax_);
-        batchEnd = std::min(std::max(0ULL, batchEnd), xMax_);
-
+        int threadNum = omp_get_thread_num();
+#else
+    {
+        int threadNum = 0;
+#endif
+        sq::PackedBitSet chunkBegin, chunkEnd;
+        while (scheduler_.acquire(threadNum, &chunkBegin, &chunkEnd)) {
 #ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
+#ifdef _OPENMP
 #pragma omp critical
-        {
-            rangeMap_.insert(batchBegin, batchEnd);
-        }
 #endif
-
-        if (batchBegin < batchEnd)
-            searchers_[threadNum].searchRange(batchBegin, batchEnd);
-    }
-    x_ = std::min(sq::PackedBitSet(x_ + tileSize_ * nMaxThreads_), xMax_);
-#else
-    sq::PackedBitSet batchBegin = x_;
-    sq::PackedBitSet batchEnd = std::min(x_ + tileSize_, xMax_); ;
-
-#ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
-    if (batchBegin < batchEnd)
-        rangeMap_.insert(batchBegin, batchEnd);
+            {
+                rangeMap_.insert(chunkBegin, chunkEnd);
+            }
 #endif
+            searchChunk(threadNum, chunkBegin, chunkEnd);
+        }
+    }
+    x_ = xEnd;
 
-    if (batchBegin < batchEnd)
-        searchers_[0].searchRange(batchBegin, batchEnd);
-    
-    searchers_[0].searchRange(batchBegin, batchEnd);
-    x_ = batchEnd;
-#endif
     if (curXEnd != NULL)
         *curXEnd = x_;
     return (xMax_ == x_);
@@ -181,3 +541,9 @@ bool CPUDenseGraphBFSearcher<real>::searchRange(sq::PackedBitSet *curXEnd) {
 
 template class CPUDenseGraphBFSearcher<float>;
 template class CPUDenseGraphBFSearcher<double>;
+
+/* integer weights */
+template void CPUDenseGraphBFSearcher<float>::setQUBO<short>(const sq::MatrixType<short> &, sq::OptimizeMethod);
+template void CPUDenseGraphBFSearcher<float>::setQUBO<int>(const sq::MatrixType<int> &, sq::OptimizeMethod);
+template void CPUDenseGraphBFSearcher<double>::setQUBO<short>(const sq::MatrixType<short> &, sq::OptimizeMethod);
+template void CPUDenseGraphBFSearcher<double>::setQUBO<int>(const sq::MatrixType<int> &, sq::OptimizeMethod);
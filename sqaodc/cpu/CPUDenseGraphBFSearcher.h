@@ -2,6 +2,7 @@
 #pragma once
 
 #include <sqaodc/common/Common.h>
+#include <sqaodc/cpu/CPURangeScheduler.h>
 
 #ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
 #include <sqaodc/common/RangeMap.h>
@@ -13,6 +14,7 @@ namespace sq = sqaod;
 
 /* forwarded decl. */
 template<class real> struct CPUDenseGraphBatchSearch;
+template<class real> struct CPUDenseGraphBranchAndBound;
 
 template<class real>
 class CPUDenseGraphBFSearcher : public sq::DenseGraphBFSearcher<real> {
@@ -20,6 +22,7 @@ class CPUDenseGraphBFSearcher : public sq::DenseGraphBFSearcher<real> {
     typedef sq::VectorType<real> Vector;
 
     typedef sqaod_cpu::CPUDenseGraphBatchSearch<real> BatchSearcher;
+    typedef sqaod_cpu::CPUDenseGraphBranchAndBound<real> BranchAndBound;
     
 public:
     CPUDenseGraphBFSearcher();
@@ -29,9 +32,19 @@ public:
 
     void setQUBO(const Matrix &W, sq::OptimizeMethod om = sq::optMinimize);
 
-    sq::Preferences getPreferences() const;
+    /* W of integer weights, short or int.  Weights should be exactly represented by real. */
+    template<class V>
+    void setQUBO(const sq::MatrixType<V> &W, sq::OptimizeMethod om = sq::optMinimize);
+
+    sq::Algorithm selectAlgorithm(sq::Algorithm algo);
+
+    sq::Algorithm getAlgorithm() const;
 
-    /* void setPreference(const Preference &pref); */
+    void setPreference(const sq::Preference &pref);
+
+    using sq::Solver<real>::setPreference;
+
+    sq::Preferences getPreferences() const;
 
     const Vector &get_E() const;
 
@@ -45,9 +58,40 @@ public:
 
     bool searchRange(sq::PackedBitSet *curXEnd);
 
+    bool searchBudget(sq::PackedBitSet budget, sq::PackedBitSet *curXEnd);
+
+    void saveCheckpoint(const char *filename) const;
+
+    void resumeFromCheckpoint(const char *filename);
+
+    void searchPartial(sq::PackedBitSet xBegin, sq::PackedBitSet xEnd,
+                       sq::DenseGraphBFPartialResult<real> *partial);
+
+    void setPartialResult(const sq::DenseGraphBFPartialResult<real> &partial);
+
     /* void search(); */
     
 private:    
+    void searchChunk(int threadNum, sq::PackedBitSet chunkBegin, sq::PackedBitSet chunkEnd);
+
+    void makeSolutionBranchAndBound();
+
+    void mergeSolutions(real *Emin, long long *EminInt, sq::PackedBitSetArray *packedXList) const;
+
+    void makeSolutionCollected();
+
+    /* top-K or energy-window collection of low-lying states. */
+    bool isCollecting() const {
+        return (0 < topK_) || (0 <= energyWindow_);
+    }
+
+    bool isBranchAndBound() const {
+        return algo_ == sq::algoBranchAndBound;
+    }
+
+    sq::Algorithm algo_;
+    sq::SizeType topK_;
+    real energyWindow_;
     Matrix W_;
     real Emin_;
     Vector E_;
@@ -55,6 +99,11 @@ private:
 
     int nMaxThreads_;
     BatchSearcher *searchers_;
+    CPURangeScheduler scheduler_;
+    /* for branch and bound, x_ and xMax_ count prefixes of nPrefixBits_ variables. */
+    BranchAndBound *bnbs_;
+    int nPrefixBits_;
+    real Ebound_;
 
 #ifdef SQAODC_ENABLE_RANGE_COVERAGE_TEST
     sqaod_internal::RangeMap rangeMap_;
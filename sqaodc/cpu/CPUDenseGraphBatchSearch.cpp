@@ -1,51 +1,161 @@
 #include "CPUDenseGraphBatchSearch.h"
 #include "CPUFormulas.h"
 #include <float.h>
+#include <limits.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace sqaod_cpu;
 namespace sq = sqaod;
 
 template<class real>
-CPUDenseGraphBatchSearch<real>::CPUDenseGraphBatchSearch() {
+CPUDenseGraphBatchSearch<real>::CPUDenseGraphBatchSearch() : intBits_(0) {
 }
 
 template<class real>
 void CPUDenseGraphBatchSearch<real>::setQUBO(const Matrix &W, sq::SizeType tileSize) {
-    W_.map(W.data, W.rows, W.cols);
+    W_.map(W.data, W.rows, W.cols, W.stride);
     tileSize_ = tileSize;
+    intBits_ = DGFuncs<real>::integralEnergyBits(W);
+    if (intBits_ != 0) {
+        Wi64_ = mapTo(W_).template cast<long long>();
+        Wi64neg_ = - Wi64_;
+    }
+    if (intBits_ == 32) {
+        Wi32_ = mapTo(W_).template cast<int>();
+        Wi32neg_ = - Wi32_;
+    }
 }
 
 template<class real>
 void CPUDenseGraphBatchSearch<real>::initSearch() {
     Emin_ = FLT_MAX;
+    EminInt_ = LLONG_MAX;
     packedXList_.clear();
 }
 
+template<class real>
+void CPUDenseGraphBatchSearch<real>::restore(real Emin, long long EminInt,
+                                             const sq::PackedBitSetArray &packedXList) {
+    Emin_ = Emin;
+    EminInt_ = EminInt;
+    packedXList_ = packedXList;
+}
+
 
 template<class real>
 void CPUDenseGraphBatchSearch<real>::searchRange(sq::PackedBitSet xBegin, sq::PackedBitSet xEnd) {
+    if (intBits_ != 0) {
+        searchRangeIntegral(xBegin, xEnd);
+        return;
+    }
+    int nBatchSize = int(xEnd - xBegin);
+    int N = W_.rows;
+
+    arena_.reset();
+    Matrix bitsSeq = arena_.matrix<real>(nBatchSize, N);
+    sq::createBitSetSequence(bitsSeq.data, N, xBegin, xEnd);
+
+    /* E = x W x^T for rows x of bitsSeq. */
+    const sq::EigenMappedMatrixType<real> ex(mapTo(bitsSeq));
+    EigenScratchMatrixType<real> exW = arena_.eigenMatrix<real>(nBatchSize, N);
+    exW.noalias() = ex * mapTo(W_);
+    for (int idx = 0; idx < nBatchSize; ++idx)
+        updateXmins(exW.row(idx).dot(ex.row(idx)), xBegin + idx);
+}
+
+static inline int countTrailingZeros(sq::PackedBitSet v) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return (int)idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+template<class real>
+void CPUDenseGraphBatchSearch<real>::searchRangeIntegral(sq::PackedBitSet xBegin,
+                                                         sq::PackedBitSet xEnd) {
     int nBatchSize = int(xEnd - xBegin);
     int N = W_.rows;
 
-    Matrix bitsSeq(nBatchSize, N);
-    Vector Ebatch;
+    arena_.reset();
+    Matrix bitsSeq = arena_.matrix<real>(nBatchSize, N);
     sq::createBitSetSequence(bitsSeq.data, N, xBegin, xEnd);
-    DGFuncs<real>::calculate_E(&Ebatch, W_, bitsSeq);
-
-    for (int idx = 0; idx < nBatchSize; ++idx) {
-        real Etmp = Ebatch(idx);
-        if (Etmp > Emin_) {
-            continue;
-        }
-        else if (Etmp == Emin_) {
-            if (packedXList_.size() < tileSize_)
-                packedXList_.pushBack(xBegin + idx);
-        }
-        else {
-            Emin_ = Etmp;
-            packedXList_.clear();
-            packedXList_.pushBack(xBegin + idx);
-        }
+    EigenScratchMatrixType<long long> x = arena_.eigenMatrix<long long>(nBatchSize, N);
+    x = mapTo(bitsSeq).template cast<long long>();
+    EigenScratchMatrixType<long long> xW = arena_.eigenMatrix<long long>(nBatchSize, N);
+    xW.noalias() = x * Wi64_;
+    for (int idx = 0; idx < nBatchSize; ++idx)
+        updateXminsIntegral(xW.row(idx).dot(x.row(idx)), xBegin + idx);
+}
+
+template<class real> template<class V>
+void CPUDenseGraphBatchSearch<real>::searchRangeGrayCodeIntegral(const sq::EigenMatrixType<V> &W,
+                                                                 const sq::EigenMatrixType<V> &Wneg,
+                                                                 sq::PackedBitSet iBegin,
+                                                                 sq::PackedBitSet iEnd) {
+    typedef Eigen::Matrix<V, 1, Eigen::Dynamic> EigenRowVectorV;
+    int N = W_.rows;
+
+    arena_.reset();
+    EigenScratchRowVectorType<V> xv = arena_.eigenRowVector<V>(N);
+    EigenScratchRowVectorType<V> field = arena_.eigenRowVector<V>(N);
+    sq::PackedBitSet x = iBegin ^ (iBegin >> 1);
+    for (int k = 0; k < N; ++k)
+        xv(k) = V((x >> (N - 1 - k)) & 1);
+    field.noalias() = xv * W;
+    V E = field.dot(xv);
+    updateXminsIntegral(E, x);
+
+    for (sq::PackedBitSet i = iBegin + 1; i < iEnd; ++i) {
+        int bit = countTrailingZeros(i);
+        int k = N - 1 - bit;
+        V d = V(1) - V(2) * xv(k);
+        E += V(2) * d * field(k) + W(k, k);
+        xv(k) += d;
+        /* rows of W or -W are added, so no multiplication is required. */
+        const V *row = (0 < d) ? &W(k, 0) : &Wneg(k, 0);
+        field.noalias() += Eigen::Map<const EigenRowVectorV>(row, N);
+        x ^= sq::PackedBitSet(1) << bit;
+        updateXminsIntegral(E, x);
+    }
+}
+
+template<class real>
+void CPUDenseGraphBatchSearch<real>::searchRangeGrayCode(sq::PackedBitSet iBegin,
+                                                         sq::PackedBitSet iEnd) {
+    if (intBits_ == 32) {
+        searchRangeGrayCodeIntegral(Wi32_, Wi32neg_, iBegin, iEnd);
+        return;
+    }
+    if (intBits_ == 64) {
+        searchRangeGrayCodeIntegral(Wi64_, Wi64neg_, iBegin, iEnd);
+        return;
+    }
+    int N = W_.rows;
+    const sq::EigenMappedMatrixType<real> W(mapTo(W_));
+
+    /* bit (N - 1 - k) of a packed x is x_k. */
+    sq::PackedBitSet x = iBegin ^ (iBegin >> 1);
+    x_.resize(N);
+    for (int k = 0; k < N; ++k)
+        x_(k) = real((x >> (N - 1 - k)) & 1);
+    field_.noalias() = x_ * W;
+    real E = field_.dot(x_);
+    updateXmins(E, x);
+
+    for (sq::PackedBitSet i = iBegin + 1; i < iEnd; ++i) {
+        int bit = countTrailingZeros(i);
+        int k = N - 1 - bit;
+        real d = real(1.) - real(2.) * x_(k); /* +1 : 0 -> 1, -1 : 1 -> 0 */
+        E += real(2.) * d * field_(k) + W(k, k);
+        x_(k) += d;
+        field_.noalias() += d * W.row(k);
+        x ^= sq::PackedBitSet(1) << bit;
+        updateXmins(E, x);
     }
 }
 
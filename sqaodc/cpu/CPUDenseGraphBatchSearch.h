@@ -2,6 +2,8 @@
 
 #include <common/Common.h>
 #include <common/EigenBridge.h>
+#include <cpu/CPUSolutionCollector.h>
+#include <cpu/CPUScratchArena.h>
 
 namespace sqaod_cpu {
 
@@ -11,6 +13,7 @@ template<class real>
 struct CPUDenseGraphBatchSearch {
     typedef sq::MatrixType<real> Matrix;
     typedef sq::VectorType<real> Vector;
+    typedef sq::EigenRowVectorType<real> EigenRowVector;
     
     CPUDenseGraphBatchSearch();
 
@@ -20,10 +23,74 @@ struct CPUDenseGraphBatchSearch {
     
     void searchRange(sq::PackedBitSet xBegin, sq::PackedBitSet xEnd);
 
+    /* visits x = i ^ (i >> 1) for i in [iBegin, iEnd).  Consecutive x differ by one bit,
+     * so E and the local field W x are updated in O(N) per candidate.
+     * Both are computed from scratch at the beginning of a range. */
+    void searchRangeGrayCode(sq::PackedBitSet iBegin, sq::PackedBitSet iEnd);
+
+    /* sets the minimum energy and solutions, used to resume searches. */
+    void restore(real Emin, long long EminInt, const sq::PackedBitSetArray &packedXList);
+
+    void updateXmins(real E, sq::PackedBitSet x) {
+        if (collector_.isEnabled()) {
+            collector_.add(E, x);
+            return;
+        }
+        if (E > Emin_) {
+            return;
+        }
+        else if (E == Emin_) {
+            if (packedXList_.size() < tileSize_)
+                packedXList_.pushBack(x);
+        }
+        else {
+            Emin_ = E;
+            packedXList_.clear();
+            packedXList_.pushBack(x);
+        }
+    }
+
+    /* for integer-valued W, energies are exactly evaluated by integers.  Wneg is -W. */
+    template<class V>
+    void searchRangeGrayCodeIntegral(const sq::EigenMatrixType<V> &W,
+                                     const sq::EigenMatrixType<V> &Wneg,
+                                     sq::PackedBitSet iBegin, sq::PackedBitSet iEnd);
+
+    void searchRangeIntegral(sq::PackedBitSet xBegin, sq::PackedBitSet xEnd);
+
+    void updateXminsIntegral(long long E, sq::PackedBitSet x) {
+        if (collector_.isEnabled()) {
+            collector_.add(real(E), x);
+            return;
+        }
+        if (E > EminInt_) {
+            return;
+        }
+        else if (E == EminInt_) {
+            if (packedXList_.size() < tileSize_)
+                packedXList_.pushBack(x);
+        }
+        else {
+            EminInt_ = E;
+            Emin_ = real(E);
+            packedXList_.clear();
+            packedXList_.pushBack(x);
+        }
+    }
+
     Matrix W_;
     sq::SizeType tileSize_;
     real Emin_;
     sq::PackedBitSetArray packedXList_;
+    CPUSolutionCollector<real, sq::PackedBitSet> collector_; /* for top-K and energy window */
+    EigenRowVector x_, field_;
+
+    int intBits_; /* 32 or 64 for integer-valued W, otherwise 0. */
+    long long EminInt_;
+    sq::EigenMatrixType<int> Wi32_, Wi32neg_;
+    sq::EigenMatrixType<long long> Wi64_, Wi64neg_;
+
+    CPUScratchArena arena_; /* temporaries of searchRange() and integral searchRangeGrayCode() */
 };
 
 
@@ -0,0 +1,196 @@
+#include "CPUDenseGraphBranchAndBound.h"
+#include <float.h>
+#include <algorithm>
+#include <vector>
+
+using namespace sqaod_cpu;
+namespace sq = sqaod;
+
+template<class real>
+CPUDenseGraphBranchAndBound<real>::CPUDenseGraphBranchAndBound() {
+    N_ = 0;
+    nWords_ = 0;
+    maxSolutions_ = 0;
+    order_ = NULL;
+    x_ = NULL;
+}
+
+template<class real>
+CPUDenseGraphBranchAndBound<real>::~CPUDenseGraphBranchAndBound() {
+    delete [] order_;
+    delete [] x_;
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::setQUBO(const Matrix &W, sq::SizeType maxSolutions) {
+    N_ = W.rows;
+    nWords_ = (N_ + 63) / 64;
+    maxSolutions_ = maxSolutions;
+
+    delete [] order_;
+    delete [] x_;
+    order_ = new sq::IdxType[N_];
+    x_ = new sq::PackedBitSet[nWords_];
+
+    const sq::EigenMappedMatrixType<real> eW(mapTo(W));
+    orderVariables(eW);
+
+    W2_.resize(N_, N_);
+    for (int i = 0; i < N_; ++i) {
+        for (int j = 0; j < N_; ++j)
+            W2_(i, j) = real(2.) * eW(order_[i], order_[j]);
+        W2_(i, i) = eW(order_[i], order_[i]);
+    }
+    negSum_.resize(N_);
+    for (int j = 0; j < N_; ++j)
+        negSum_(j) = W2_.row(j).tail(N_ - j - 1).cwiseMin(real(0.)).sum();
+    negSumFree_.resize(N_ + 1, N_);
+    negSumFree_.row(N_).setZero();
+    for (int k = N_ - 1; 0 <= k; --k) {
+        negSumFree_.row(k) = negSumFree_.row(k + 1)
+                + (real(0.5) * W2_.row(k)).cwiseMin(real(0.));
+        negSumFree_(k, k) = negSumFree_(k + 1, k);
+    }
+    g_.resize(N_ + 1, N_);
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::orderVariables(const sq::EigenMappedMatrixType<real> &W) {
+    /* starts from the variable of the largest coupling, and picks the one most strongly
+     * coupled to the fixed variables.  Connected components are fixed one by one. */
+    EigenMatrix absW = W.cwiseAbs();
+    EigenRowVector weight = absW.colwise().sum();
+    EigenRowVector connection = EigenRowVector::Zero(N_);
+    std::vector<bool> fixed(N_, false);
+    for (int k = 0; k < N_; ++k) {
+        int next = -1;
+        for (int j = 0; j < N_; ++j) {
+            if (fixed[j])
+                continue;
+            if ((next == -1) || (connection(next) < connection(j)) ||
+                ((connection(next) == connection(j)) && (weight(next) < weight(j))))
+                next = j;
+        }
+        order_[k] = next;
+        fixed[next] = true;
+        connection += absW.row(next);
+    }
+}
+
+template<class real>
+real CPUDenseGraphBranchAndBound<real>::descend() {
+    /* g : energy change when x_j is set to 1 in the current x. */
+    std::vector<char> x(N_, 0);
+    EigenRowVector g = W2_.diagonal().transpose();
+    real E = real(0.);
+    for (;;) {
+        int jBest = -1;
+        real dEBest = real(0.);
+        for (int j = 0; j < N_; ++j) {
+            real dE = (x[j] == 0) ? g(j) : - g(j);
+            if (dE < dEBest) {
+                dEBest = dE;
+                jBest = j;
+            }
+        }
+        if (jBest == -1)
+            break;
+        real d = (x[jBest] == 0) ? real(1.) : real(-1.);
+        x[jBest] ^= 1;
+        E += dEBest;
+        EigenRowVector row = d * W2_.row(jBest);
+        row(jBest) = real(0.);
+        g += row;
+    }
+    return E;
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::initSearch() {
+    Emin_ = FLT_MAX;
+    packedXList_.clear();
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::fix(int k, int v) {
+    sq::PackedBitSet mask = sq::PackedBitSet(1) << (k % 64);
+    sq::PackedBitSet &word = x_[k / 64];
+    int nRest = N_ - k - 1;
+    if (v == 0) {
+        word &= ~mask;
+        g_.row(k + 1).tail(nRest) = g_.row(k).tail(nRest);
+    }
+    else {
+        word |= mask;
+        g_.row(k + 1).tail(nRest) = g_.row(k).tail(nRest) + W2_.row(k).tail(nRest);
+    }
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::searchPrefix(sq::PackedBitSet prefix,
+                                                     int nPrefixBits, real Ebound) {
+    Ebound_ = Ebound;
+    g_.row(0) = W2_.diagonal().transpose();
+    real E = real(0.);
+    for (int k = 0; k < nPrefixBits; ++k) {
+        int v = int((prefix >> (nPrefixBits - 1 - k)) & 1);
+        if (v != 0)
+            E += g_(k, k);
+        fix(k, v);
+    }
+    search(nPrefixBits, E);
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::search(int k, real E) {
+    if (k == N_) {
+        addSolution(E);
+        return;
+    }
+    int nRest = N_ - k;
+    real lowerBound0 = (g_.row(k).tail(nRest) + negSum_.tail(nRest)).cwiseMin(real(0.)).sum();
+    real lowerBound1 = (g_.row(k).tail(nRest)
+                        + negSumFree_.row(k).tail(nRest)).cwiseMin(real(0.)).sum();
+    real lowerBound = std::max(lowerBound0, lowerBound1);
+    if (std::min(Emin_, Ebound_) < E + lowerBound)
+        return;
+
+    real gk = g_(k, k);
+    int first = (gk < real(0.)) ? 1 : 0;
+    for (int v = first, nVisited = 0; nVisited < 2; v ^= 1, ++nVisited) {
+        fix(k, v);
+        search(k + 1, (v != 0) ? E + gk : E);
+    }
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::addSolution(real E) {
+    if (Emin_ < E)
+        return;
+    if (E < Emin_) {
+        Emin_ = E;
+        packedXList_.clear();
+    }
+    if (getNumSolutions() < maxSolutions_) {
+        for (sq::IdxType iw = 0; iw < nWords_; ++iw)
+            packedXList_.pushBack(x_[iw]);
+    }
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::restore(real Emin, const sq::PackedBitSetArray &packedXList) {
+    throwErrorIf(packedXList.size() % nWords_ != 0, "Wrong size of solutions.");
+    Emin_ = Emin;
+    packedXList_ = packedXList;
+}
+
+template<class real>
+void CPUDenseGraphBranchAndBound<real>::getSolution(sq::BitSet *x, sq::IdxType idx) const {
+    const sq::PackedBitSet *words = &packedXList_[idx * nWords_];
+    x->resize(N_);
+    for (int k = 0; k < N_; ++k)
+        (*x)(order_[k]) = char((words[k / 64] >> (k % 64)) & 1);
+}
+
+template struct sqaod_cpu::CPUDenseGraphBranchAndBound<float>;
+template struct sqaod_cpu::CPUDenseGraphBranchAndBound<double>;
@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Common.h>
+#include <sqaodc/common/EigenBridge.h>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* Exact search for dense graphs without the limit of N < 64.
+ *
+ * Variables are fixed one by one in the depth-first order.  For fixed variables,
+ * x_0 ... x_{k-1}, the energy of the rest is bounded from below by the larger of
+ *   sum_{j >= k} min(0, g_j + sum_{l > j} min(0, 2 W_jl)) and
+ *   sum_{j >= k} min(0, g_j + sum_{l >= k, l != j} min(0, W_jl)),
+ * where g_j = W_jj + 2 sum_{i < k} W_ij x_i, and subtrees whose lower bound exceeds
+ * the best energy are pruned.  Variables are ordered so that each variable is the one
+ * most strongly coupled to those already fixed, and candidates are kept as multi-word
+ * packed bitsets. */
+
+template<class real>
+struct CPUDenseGraphBranchAndBound {
+    typedef sq::MatrixType<real> Matrix;
+    typedef sq::EigenMatrixType<real> EigenMatrix;
+    typedef sq::EigenRowVectorType<real> EigenRowVector;
+
+    CPUDenseGraphBranchAndBound();
+    ~CPUDenseGraphBranchAndBound();
+
+    void setQUBO(const Matrix &W, sq::SizeType maxSolutions);
+
+    void initSearch();
+
+    /* returns E of a local minimum given by greedy descent, an upper bound of Emin. */
+    real descend();
+
+    /* searches the subtree whose first nPrefixBits variables are given by prefix,
+     * (the first variable is the MSB.)  Subtrees are pruned if their lower bound is
+     * greater than min(Emin_, Ebound). */
+    void searchPrefix(sq::PackedBitSet prefix, int nPrefixBits, real Ebound);
+
+    /* unpacks the idx-th solution to the original variable order. */
+    void getSolution(sq::BitSet *x, sq::IdxType idx) const;
+
+    sq::SizeType getNumSolutions() const {
+        return nWords_ == 0 ? 0 : packedXList_.size() / nWords_;
+    }
+
+    /* solutions in the search order, nWords words per solution, for checkpoints. */
+    const sq::PackedBitSetArray &getPackedXList() const {
+        return packedXList_;
+    }
+
+    void restore(real Emin, const sq::PackedBitSetArray &packedXList);
+
+    real Emin_;
+
+private:
+    void orderVariables(const sq::EigenMappedMatrixType<real> &W);
+
+    void fix(int k, int v);
+    
+    void search(int k, real E);
+
+    void addSolution(real E);
+
+    int N_;
+    sq::SizeType nWords_;
+    sq::SizeType maxSolutions_;
+    real Ebound_;
+    EigenMatrix W2_; /* 2 W, rows and columns are reordered, diagonal is W_jj. */
+    EigenRowVector negSum_;
+    EigenMatrix negSumFree_; /* negSumFree_(k, j) : sum_{l >= k, l != j} min(0, W_jl) */
+    EigenMatrix g_; /* g_.row(k) : local fields after fixing x_0 ... x_{k-1}. */
+    sq::IdxType *order_; /* order_[k] : original index of the k-th variable. */
+    sq::PackedBitSet *x_; /* current assignment in the search order, multi-word. */
+    sq::PackedBitSetArray packedXList_; /* nWords_ words per solution. */
+};
+
+}
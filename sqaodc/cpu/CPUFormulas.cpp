@@ -1,12 +1,85 @@
 #include "CPUFormulas.h"
 #include <sqaodc/common/ShapeChecker.h>
 #include <iostream>
+#include <cmath>
+#include <limits.h>
 
 
 namespace {
 
 namespace sq = sqaod;
 
+/* accumulates |v| of integer values, returns false if a value is not an integer. */
+template<class real>
+bool sumIntegralValues(double *sum, const real *values, sq::SizeType size) {
+    for (sq::IdxType idx = 0; idx < size; ++idx) {
+        real v = values[idx];
+        if (std::floor(v) != v) /* also rejects NaN */
+            return false;
+        *sum += std::fabs(double(v));
+    }
+    return true;
+}
+
+template<class real>
+bool sumIntegralValues(double *sum, const sq::MatrixType<real> &mat) {
+    for (sq::IdxType row = 0; row < (sq::IdxType)mat.rows; ++row) {
+        if (!sumIntegralValues(sum, mat.row(row), mat.cols))
+            return false;
+    }
+    return true;
+}
+
+/* |E|, |local field| and |dE| are bounded by the sum, and 2 * field is calculated in flips. */
+int integralBitsForSum(double sum) {
+    if (sum < double(1 << 29))
+        return 32;
+    if (sum < double(1ull << 60))
+        return 64;
+    return 0;
+}
+
+template<class V>
+double sumOfAbs(const V *values, sq::SizeType size) {
+    double sum = 0.;
+    for (sq::IdxType idx = 0; idx < size; ++idx)
+        sum += std::fabs(double(values[idx]));
+    return sum;
+}
+
+template<class V>
+double sumOfAbs(const sq::MatrixType<V> &mat) {
+    double sum = 0.;
+    for (sq::IdxType row = 0; row < (sq::IdxType)mat.rows; ++row)
+        sum += sumOfAbs(mat.row(row), mat.cols);
+    return sum;
+}
+
+/* E = x W x^T for rows of x, accumulated by integers of A. */
+template<class A, class real, class V>
+void dgIntegralE(sq::VectorType<real> *E, const sq::MatrixType<V> &W, const sq::BitMatrix &x) {
+    const sq::EigenMatrixType<A> eW = sq::mapTo(W).template cast<A>();
+    const sq::EigenMatrixType<A> ex = sq::mapTo(x).template cast<A>();
+    sq::EigenMatrixType<A> exW = ex * eW;
+    for (sq::IdxType idx = 0; idx < x.rows; ++idx)
+        (*E)(idx) = real(exW.row(idx).dot(ex.row(idx)));
+}
+
+/* E = b0 x0^T + b1 x1^T + x1 W x0^T for rows of x0 and x1, accumulated by integers of A. */
+template<class A, class real, class V>
+void bgIntegralE(sq::VectorType<real> *E,
+                 const sq::VectorType<V> &b0, const sq::VectorType<V> &b1,
+                 const sq::MatrixType<V> &W, const sq::BitMatrix &x0, const sq::BitMatrix &x1) {
+    const sq::EigenMatrixType<A> eW = sq::mapTo(W).template cast<A>();
+    const sq::EigenRowVectorType<A> eb0 = sq::mapToRowVector(b0).template cast<A>();
+    const sq::EigenRowVectorType<A> eb1 = sq::mapToRowVector(b1).template cast<A>();
+    const sq::EigenMatrixType<A> ex0 = sq::mapTo(x0).template cast<A>();
+    const sq::EigenMatrixType<A> ex1 = sq::mapTo(x1).template cast<A>();
+    sq::EigenMatrixType<A> ex0Wt = ex0 * eW.transpose();
+    for (sq::IdxType idx = 0; idx < x0.rows; ++idx)
+        (*E)(idx) = real(eb0.dot(ex0.row(idx)) + eb1.dot(ex1.row(idx)) +
+                         ex0Wt.row(idx).dot(ex1.row(idx)));
+}
 
 }
 
@@ -23,7 +96,7 @@ void DGFuncs<real>::calculate_E(real *E,
     
     const EigenMappedMatrix eW(mapTo(W));
     EigenMappedColumnVector ex(mapToColumnVector(x)); 
-    EigenMappedMatrix eE(E, 1, 1);
+    EigenMappedMatrix eE(E, 1, 1, Eigen::OuterStride<>(1));
     eE = ex.transpose() * (eW * ex);
 }
 
@@ -48,19 +121,24 @@ void DGFuncs<real>::calculateHamiltonian(Vector *h, Matrix *J, real *c, const Ma
     sqint::prepMatrix(J, W.dim(), __func__);
     sqint::validateScalar(c, __func__);
 
-    const EigenMappedMatrix eW(mapTo(W));
-    EigenMappedMatrix eJ(mapTo(*J));
-    EigenMappedRowVector eh(mapToRowVector(*h));
-    
-    eh = real(-0.5) * eW.colwise().sum();
-
-    eJ = real(-0.25) * eW;
-    real eJsum = eJ.sum();
-    real diagSum = eJ.diagonal().sum();
+    /* h, J and c are computed in a single pass over W.  W is symmetric, so row sums are
+     * used in place of column sums. */
     int N = W.rows;
-    for (int i = 0; i < N; ++i)
-        eJ(i, i) = real(0.);
-    *c = eJsum + diagSum;
+    real sum = real(0.), diagSum = real(0.);
+    for (int i = 0; i < N; ++i) {
+        const real *Wrow = &W(i, 0);
+        real *Jrow = &(*J)(i, 0);
+        real rowSum = real(0.);
+        for (int j = 0; j < N; ++j) {
+            rowSum += Wrow[j];
+            Jrow[j] = real(-0.25) * Wrow[j];
+        }
+        diagSum += Jrow[i];
+        Jrow[i] = real(0.);
+        (*h)(i) = real(-0.5) * rowSum;
+        sum += real(-0.25) * rowSum;
+    }
+    *c = sum + diagSum;
 }
 
 template<class real>
@@ -205,7 +283,118 @@ void BGFuncs<real>::calculate_E(Vector *E,
 }
 
 
+template<class real> template<class V>
+void DGFuncs<real>::calculate_E(real *E, const sq::MatrixType<V> &W, const sq::BitSet &x) {
+    sqint::validateScalar(E, __func__);
+    const sq::BitMatrix xMat(const_cast<char*>(x.data), 1, x.size);
+    Vector Evec(1);
+    calculate_E(&Evec, W, xMat);
+    *E = Evec(0);
+}
+
+template<class real> template<class V>
+void DGFuncs<real>::calculate_E(Vector *E, const sq::MatrixType<V> &W, const sq::BitMatrix &x) {
+    sqint::quboShapeCheck(W, __func__);
+    throwErrorIf(W.cols != x.cols, "%s, Shape does not match.", __func__);
+    sqint::prepVector(E, x.rows, __func__);
+    /* |E| is not larger than the sum of |W|. */
+    if (sumOfAbs(W) < double(INT_MAX))
+        dgIntegralE<int>(E, W, x);
+    else
+        dgIntegralE<long long>(E, W, x);
+}
+
+template<class real>
+int DGFuncs<real>::integralEnergyBits(const Matrix &W) {
+    double sum = 0.;
+    if (!sumIntegralValues(&sum, W))
+        return 0;
+    return integralBitsForSum(sum);
+}
+
+template<class real> template<class V>
+void BGFuncs<real>::calculate_E(real *E,
+                                const sq::VectorType<V> &b0, const sq::VectorType<V> &b1,
+                                const sq::MatrixType<V> &W,
+                                const sq::BitSet &x0, const sq::BitSet &x1) {
+    sqint::validateScalar(E, __func__);
+    const sq::BitMatrix x0Mat(const_cast<char*>(x0.data), 1, x0.size);
+    const sq::BitMatrix x1Mat(const_cast<char*>(x1.data), 1, x1.size);
+    Vector Evec(1);
+    calculate_E(&Evec, b0, b1, W, x0Mat, x1Mat);
+    *E = Evec(0);
+}
+
+template<class real> template<class V>
+void BGFuncs<real>::calculate_E(Vector *E,
+                                const sq::VectorType<V> &b0, const sq::VectorType<V> &b1,
+                                const sq::MatrixType<V> &W,
+                                const sq::BitMatrix &x0, const sq::BitMatrix &x1) {
+    throwErrorIf((W.cols != b0.size) || (W.rows != b1.size) ||
+                 (x0.cols != b0.size) || (x1.cols != b1.size) || (x0.rows != x1.rows),
+                 "%s, Shape does not match.", __func__);
+    sqint::prepVector(E, x0.rows, __func__);
+    double sum = sumOfAbs(b0.data, b0.size) + sumOfAbs(b1.data, b1.size) +
+            sumOfAbs(W);
+    if (sum < double(INT_MAX))
+        bgIntegralE<int>(E, b0, b1, W, x0, x1);
+    else
+        bgIntegralE<long long>(E, b0, b1, W, x0, x1);
+}
+
+template<class real>
+int BGFuncs<real>::integralEnergyBits(const Vector &b0, const Vector &b1, const Matrix &W) {
+    double sum = 0.;
+    if (!sumIntegralValues(&sum, b0.data, b0.size) || !sumIntegralValues(&sum, b1.data, b1.size) ||
+        !sumIntegralValues(&sum, W))
+        return 0;
+    return integralBitsForSum(sum);
+}
+
+
 template struct DGFuncs<double>;
 template struct DGFuncs<float>;
 template struct BGFuncs<double>;
 template struct BGFuncs<float>;
+
+/* integer weights */
+template void DGFuncs<double>::calculate_E<short>(double *, const sq::MatrixType<short> &,
+                                                  const sq::BitSet &);
+template void DGFuncs<double>::calculate_E<short>(sq::VectorType<double> *, const sq::MatrixType<short> &,
+                                                  const sq::BitMatrix &);
+template void BGFuncs<double>::calculate_E<short>(double *, const sq::VectorType<short> &,
+                                                  const sq::VectorType<short> &, const sq::MatrixType<short> &,
+                                                  const sq::BitSet &, const sq::BitSet &);
+template void BGFuncs<double>::calculate_E<short>(sq::VectorType<double> *, const sq::VectorType<short> &,
+                                                  const sq::VectorType<short> &, const sq::MatrixType<short> &,
+                                                  const sq::BitMatrix &, const sq::BitMatrix &);
+template void DGFuncs<double>::calculate_E<int>(double *, const sq::MatrixType<int> &,
+                                                  const sq::BitSet &);
+template void DGFuncs<double>::calculate_E<int>(sq::VectorType<double> *, const sq::MatrixType<int> &,
+                                                  const sq::BitMatrix &);
+template void BGFuncs<double>::calculate_E<int>(double *, const sq::VectorType<int> &,
+                                                  const sq::VectorType<int> &, const sq::MatrixType<int> &,
+                                                  const sq::BitSet &, const sq::BitSet &);
+template void BGFuncs<double>::calculate_E<int>(sq::VectorType<double> *, const sq::VectorType<int> &,
+                                                  const sq::VectorType<int> &, const sq::MatrixType<int> &,
+                                                  const sq::BitMatrix &, const sq::BitMatrix &);
+template void DGFuncs<float>::calculate_E<short>(float *, const sq::MatrixType<short> &,
+                                                  const sq::BitSet &);
+template void DGFuncs<float>::calculate_E<short>(sq::VectorType<float> *, const sq::MatrixType<short> &,
+                                                  const sq::BitMatrix &);
+template void BGFuncs<float>::calculate_E<short>(float *, const sq::VectorType<short> &,
+                                                  const sq::VectorType<short> &, const sq::MatrixType<short> &,
+                                                  const sq::BitSet &, const sq::BitSet &);
+template void BGFuncs<float>::calculate_E<short>(sq::VectorType<float> *, const sq::VectorType<short> &,
+                                                  const sq::VectorType<short> &, const sq::MatrixType<short> &,
+                                                  const sq::BitMatrix &, const sq::BitMatrix &);
+template void DGFuncs<float>::calculate_E<int>(float *, const sq::MatrixType<int> &,
+                                                  const sq::BitSet &);
+template void DGFuncs<float>::calculate_E<int>(sq::VectorType<float> *, const sq::MatrixType<int> &,
+                                                  const sq::BitMatrix &);
+template void BGFuncs<float>::calculate_E<int>(float *, const sq::VectorType<int> &,
+                                                  const sq::VectorType<int> &, const sq::MatrixType<int> &,
+                                                  const sq::BitSet &, const sq::BitSet &);
+template void BGFuncs<float>::calculate_E<int>(sq::VectorType<float> *, const sq::VectorType<int> &,
+                                                  const sq::VectorType<int> &, const sq::MatrixType<int> &,
+                                                  const sq::BitMatrix &, const sq::BitMatrix &);
@@ -32,6 +32,20 @@ struct DGFuncs {
     static
     void calculate_E(Vector *E,
                      const Vector &h, const Matrix &J, real c, const Matrix &q);
+
+    /* W of integer weights, short or int.  Energies are exactly accumulated by integers. */
+    template<class V>
+    static
+    void calculate_E(real *E, const sq::MatrixType<V> &W, const sq::BitSet &x);
+
+    template<class V>
+    static
+    void calculate_E(Vector *E, const sq::MatrixType<V> &W, const sq::BitMatrix &x);
+
+    /* returns 32 or 64 if W is integer-valued and energies, local fields and their
+     * differences are exactly represented by integers of the width, otherwise 0. */
+    static
+    int integralEnergyBits(const Matrix &W);
     
 };
     
@@ -73,6 +87,22 @@ struct BGFuncs {
     void calculate_E(Vector *E,
                      const Vector &h0, const Vector &h1, const Matrix &J, real c,
                      const Matrix &q0, const Matrix &q1);
+
+    /* b0, b1 and W of integer weights, short or int. */
+    template<class V>
+    static
+    void calculate_E(real *E,
+                     const sq::VectorType<V> &b0, const sq::VectorType<V> &b1,
+                     const sq::MatrixType<V> &W, const sq::BitSet &x0, const sq::BitSet &x1);
+
+    template<class V>
+    static
+    void calculate_E(Vector *E,
+                     const sq::VectorType<V> &b0, const sq::VectorType<V> &b1,
+                     const sq::MatrixType<V> &W, const sq::BitMatrix &x0, const sq::BitMatrix &x1);
+
+    static
+    int integralEnergyBits(const Vector &b0, const Vector &b1, const Matrix &W);
     
 };
 
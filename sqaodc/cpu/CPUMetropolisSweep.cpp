@@ -0,0 +1,445 @@
+#include "CPUMetropolisSweep.h"
+#include <sqaodc/common/defines.h>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define SQAODC_SIMD_ENABLED
+#  define SQAODC_TARGET(isa) __attribute__((target(isa)))
+#  include <immintrin.h>
+#  if !defined(__clang__) && (__GNUC__ == 12)
+/* false positives from _mm512_undefined_*() in avx512fintrin.h */
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#  endif
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  define SQAODC_SIMD_ENABLED
+#  define SQAODC_TARGET(isa)
+#  include <intrin.h>
+#  include <immintrin.h>
+#endif
+
+using namespace sqaod_cpu;
+
+
+
+template<class real> static
+void expScalar(real *y, const real *x, sq::SizeType N) {
+    for (int idx = 0; idx < N; ++idx)
+        y[idx] = std::exp(x[idx]);
+}
+
+template<class real> static
+void sweepScalar(real *q, const real *qNeibour0, const real *qNeibour1,
+                 const real *h, const real *dEmat, const real *rand, sq::SizeType N,
+                 real twoDivM, real coef, real beta) {
+    for (int iq = 0; iq < N; ++iq) {
+        real qi = q[iq];
+        real dE = twoDivM * qi * (h[iq] + dEmat[iq]);
+        dE -= qi * (qNeibour0[iq] + qNeibour1[iq]) * coef;
+        real thresh = dE < real(0.) ? real(1.) : std::exp(- dE * beta);
+        if (thresh > rand[iq])
+            q[iq] = -qi;
+    }
+}
+
+
+#ifdef SQAODC_SIMD_ENABLED
+
+/* exp() for vectors, Cephes polynomial (float) and Pade approximation (double). */
+
+namespace {
+
+const float expHiF = 88.3762626647949f;
+const float expLoF = -87.3365478515625f; /* 2^-126, not to make denormals */
+const float log2eF = 1.44269504088896341f;
+const float expC1F = 0.693359375f;
+const float expC2F = -2.12194440e-4f;
+const float expPF[] = { 1.9875691500E-4f, 1.3981999507E-3f, 8.3334519073E-3f,
+                        4.1665795894E-2f, 1.6666665459E-1f, 5.0000001201E-1f };
+
+const double expHiD = 709.782712893384;
+const double expLoD = -708.396418532264; /* 2^-1022, not to make denormals */
+const double log2eD = 1.4426950408889634073599;
+const double expC1D = 6.93145751953125E-1;
+const double expC2D = 1.42860682030941723212E-6;
+const double expPD[] = { 1.26177193074810590878E-4, 3.02994407707441961300E-2,
+                         9.99999999999999999910E-1 };
+const double expQD[] = { 3.00198505138664455042E-6, 2.52448340349684104192E-3,
+                         2.27265548208155028766E-1, 2.00000000000000000009E0 };
+
+}
+
+
+/* AVX2 */
+
+SQAODC_TARGET("avx2,fma") static inline
+__m256 expAVX2(__m256 x) {
+    x = _mm256_min_ps(x, _mm256_set1_ps(expHiF));
+    x = _mm256_max_ps(x, _mm256_set1_ps(expLoF));
+    __m256 fx = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(log2eF)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(expC1F), x);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(expC2F), x);
+    __m256 y = _mm256_set1_ps(expPF[0]);
+    for (int idx = 1; idx < 6; ++idx)
+        y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(expPF[idx]));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.f)));
+    __m256i n = _mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127));
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+SQAODC_TARGET("avx2,fma") static inline
+__m256d expAVX2(__m256d x) {
+    x = _mm256_min_pd(x, _mm256_set1_pd(expHiD));
+    x = _mm256_max_pd(x, _mm256_set1_pd(expLoD));
+    __m256d fx = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(log2eD)),
+                                 _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_fnmadd_pd(fx, _mm256_set1_pd(expC1D), x);
+    x = _mm256_fnmadd_pd(fx, _mm256_set1_pd(expC2D), x);
+    __m256d xx = _mm256_mul_pd(x, x);
+    __m256d px = _mm256_fmadd_pd(_mm256_set1_pd(expPD[0]), xx, _mm256_set1_pd(expPD[1]));
+    px = _mm256_mul_pd(x, _mm256_fmadd_pd(px, xx, _mm256_set1_pd(expPD[2])));
+    __m256d qx = _mm256_fmadd_pd(_mm256_set1_pd(expQD[0]), xx, _mm256_set1_pd(expQD[1]));
+    qx = _mm256_fmadd_pd(qx, xx, _mm256_set1_pd(expQD[2]));
+    qx = _mm256_fmadd_pd(qx, xx, _mm256_set1_pd(expQD[3]));
+    x = _mm256_div_pd(px, _mm256_sub_pd(qx, px));
+    x = _mm256_fmadd_pd(x, _mm256_set1_pd(2.), _mm256_set1_pd(1.));
+    __m256i n = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(fx));
+    n = _mm256_add_epi64(n, _mm256_set1_epi64x(1023));
+    return _mm256_mul_pd(x, _mm256_castsi256_pd(_mm256_slli_epi64(n, 52)));
+}
+
+SQAODC_TARGET("avx2,fma") static
+void sweepAVX2(float *q, const float *qNeibour0, const float *qNeibour1,
+               const float *h, const float *dEmat, const float *rand, sq::SizeType N,
+               float twoDivM, float coef, float beta) {
+    const __m256 vTwoDivM = _mm256_set1_ps(twoDivM), vCoef = _mm256_set1_ps(coef);
+    const __m256 vMinusBeta = _mm256_set1_ps(-beta);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f);
+    const __m256 signBit = _mm256_set1_ps(-0.f);
+    int iq = 0;
+    for (; iq + 8 <= N; iq += 8) {
+        __m256 vq = _mm256_loadu_ps(&q[iq]);
+        __m256 hdE = _mm256_add_ps(_mm256_loadu_ps(&h[iq]), _mm256_loadu_ps(&dEmat[iq]));
+        __m256 dE = _mm256_mul_ps(_mm256_mul_ps(vTwoDivM, vq), hdE);
+        __m256 qNeibour = _mm256_add_ps(_mm256_loadu_ps(&qNeibour0[iq]),
+                                        _mm256_loadu_ps(&qNeibour1[iq]));
+        dE = _mm256_fnmadd_ps(_mm256_mul_ps(vq, qNeibour), vCoef, dE);
+        __m256 thresh = expAVX2(_mm256_mul_ps(dE, vMinusBeta));
+        thresh = _mm256_blendv_ps(thresh, one, _mm256_cmp_ps(dE, zero, _CMP_LT_OQ));
+        __m256 accept = _mm256_cmp_ps(_mm256_loadu_ps(&rand[iq]), thresh, _CMP_LT_OQ);
+        _mm256_storeu_ps(&q[iq], _mm256_xor_ps(vq, _mm256_and_ps(accept, signBit)));
+    }
+    sweepScalar(&q[iq], &qNeibour0[iq], &qNeibour1[iq], &h[iq], &dEmat[iq], &rand[iq],
+                N - iq, twoDivM, coef, beta);
+}
+
+SQAODC_TARGET("avx2,fma") static
+void sweepAVX2(double *q, const double *qNeibour0, const double *qNeibour1,
+               const double *h, const double *dEmat, const double *rand, sq::SizeType N,
+               double twoDivM, double coef, double beta) {
+    const __m256d vTwoDivM = _mm256_set1_pd(twoDivM), vCoef = _mm256_set1_pd(coef);
+    const __m256d vMinusBeta = _mm256_set1_pd(-beta);
+    const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.);
+    const __m256d signBit = _mm256_set1_pd(-0.);
+    int iq = 0;
+    for (; iq + 4 <= N; iq += 4) {
+        __m256d vq = _mm256_loadu_pd(&q[iq]);
+        __m256d hdE = _mm256_add_pd(_mm256_loadu_pd(&h[iq]), _mm256_loadu_pd(&dEmat[iq]));
+        __m256d dE = _mm256_mul_pd(_mm256_mul_pd(vTwoDivM, vq), hdE);
+        __m256d qNeibour = _mm256_add_pd(_mm256_loadu_pd(&qNeibour0[iq]),
+                                         _mm256_loadu_pd(&qNeibour1[iq]));
+        dE = _mm256_fnmadd_pd(_mm256_mul_pd(vq, qNeibour), vCoef, dE);
+        __m256d thresh = expAVX2(_mm256_mul_pd(dE, vMinusBeta));
+        thresh = _mm256_blendv_pd(thresh, one, _mm256_cmp_pd(dE, zero, _CMP_LT_OQ));
+        __m256d accept = _mm256_cmp_pd(_mm256_loadu_pd(&rand[iq]), thresh, _CMP_LT_OQ);
+        _mm256_storeu_pd(&q[iq], _mm256_xor_pd(vq, _mm256_and_pd(accept, signBit)));
+    }
+    sweepScalar(&q[iq], &qNeibour0[iq], &qNeibour1[iq], &h[iq], &dEmat[iq], &rand[iq],
+                N - iq, twoDivM, coef, beta);
+}
+
+/* vector exp() over arrays, the tail is computed in a zero-padded vector. */
+
+SQAODC_TARGET("avx2,fma") static
+void expAVX2(float *y, const float *x, sq::SizeType N) {
+    int idx = 0;
+    for (; idx + 8 <= N; idx += 8)
+        _mm256_storeu_ps(&y[idx], expAVX2(_mm256_loadu_ps(&x[idx])));
+    if (idx < N) {
+        float buf[8] = { 0.f };
+        for (int iv = 0; iv < N - idx; ++iv)
+            buf[iv] = x[idx + iv];
+        _mm256_storeu_ps(buf, expAVX2(_mm256_loadu_ps(buf)));
+        for (int iv = 0; iv < N - idx; ++iv)
+            y[idx + iv] = buf[iv];
+    }
+}
+
+SQAODC_TARGET("avx2,fma") static
+void expAVX2(double *y, const double *x, sq::SizeType N) {
+    int idx = 0;
+    for (; idx + 4 <= N; idx += 4)
+        _mm256_storeu_pd(&y[idx], expAVX2(_mm256_loadu_pd(&x[idx])));
+    if (idx < N) {
+        double buf[4] = { 0. };
+        for (int iv = 0; iv < N - idx; ++iv)
+            buf[iv] = x[idx + iv];
+        _mm256_storeu_pd(buf, expAVX2(_mm256_loadu_pd(buf)));
+        for (int iv = 0; iv < N - idx; ++iv)
+            y[idx + iv] = buf[iv];
+    }
+}
+
+
+/* AVX-512 */
+
+SQAODC_TARGET("avx512f") static inline
+__m512 expAVX512(__m512 x) {
+    x = _mm512_min_ps(x, _mm512_set1_ps(expHiF));
+    x = _mm512_max_ps(x, _mm512_set1_ps(expLoF));
+    __m512 fx = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(log2eF)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(expC1F), x);
+    x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(expC2F), x);
+    __m512 y = _mm512_set1_ps(expPF[0]);
+    for (int idx = 1; idx < 6; ++idx)
+        y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(expPF[idx]));
+    y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, _mm512_set1_ps(1.f)));
+    return _mm512_scalef_ps(y, fx);
+}
+
+SQAODC_TARGET("avx512f") static inline
+__m512d expAVX512(__m512d x) {
+    x = _mm512_min_pd(x, _mm512_set1_pd(expHiD));
+    x = _mm512_max_pd(x, _mm512_set1_pd(expLoD));
+    __m512d fx = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(log2eD)),
+                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm512_fnmadd_pd(fx, _mm512_set1_pd(expC1D), x);
+    x = _mm512_fnmadd_pd(fx, _mm512_set1_pd(expC2D), x);
+    __m512d xx = _mm512_mul_pd(x, x);
+    __m512d px = _mm512_fmadd_pd(_mm512_set1_pd(expPD[0]), xx, _mm512_set1_pd(expPD[1]));
+    px = _mm512_mul_pd(x, _mm512_fmadd_pd(px, xx, _mm512_set1_pd(expPD[2])));
+    __m512d qx = _mm512_fmadd_pd(_mm512_set1_pd(expQD[0]), xx, _mm512_set1_pd(expQD[1]));
+    qx = _mm512_fmadd_pd(qx, xx, _mm512_set1_pd(expQD[2]));
+    qx = _mm512_fmadd_pd(qx, xx, _mm512_set1_pd(expQD[3]));
+    x = _mm512_div_pd(px, _mm512_sub_pd(qx, px));
+    x = _mm512_fmadd_pd(x, _mm512_set1_pd(2.), _mm512_set1_pd(1.));
+    return _mm512_scalef_pd(x, fx);
+}
+
+SQAODC_TARGET("avx512f") static
+void sweepAVX512(float *q, const float *qNeibour0, const float *qNeibour1,
+                 const float *h, const float *dEmat, const float *rand, sq::SizeType N,
+                 float twoDivM, float coef, float beta) {
+    const __m512 vTwoDivM = _mm512_set1_ps(twoDivM), vCoef = _mm512_set1_ps(coef);
+    const __m512 vMinusBeta = _mm512_set1_ps(-beta);
+    const __m512 zero = _mm512_setzero_ps(), one = _mm512_set1_ps(1.f);
+    int iq = 0;
+    for (; iq + 16 <= N; iq += 16) {
+        __m512 vq = _mm512_loadu_ps(&q[iq]);
+        __m512 hdE = _mm512_add_ps(_mm512_loadu_ps(&h[iq]), _mm512_loadu_ps(&dEmat[iq]));
+        __m512 dE = _mm512_mul_ps(_mm512_mul_ps(vTwoDivM, vq), hdE);
+        __m512 qNeibour = _mm512_add_ps(_mm512_loadu_ps(&qNeibour0[iq]),
+                                        _mm512_loadu_ps(&qNeibour1[iq]));
+        dE = _mm512_fnmadd_ps(_mm512_mul_ps(vq, qNeibour), vCoef, dE);
+        __m512 thresh = expAVX512(_mm512_mul_ps(dE, vMinusBeta));
+        thresh = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(dE, zero, _CMP_LT_OQ), thresh, one);
+        __mmask16 accept = _mm512_cmp_ps_mask(_mm512_loadu_ps(&rand[iq]), thresh, _CMP_LT_OQ);
+        _mm512_storeu_ps(&q[iq], _mm512_mask_sub_ps(vq, accept, zero, vq));
+    }
+    sweepScalar(&q[iq], &qNeibour0[iq], &qNeibour1[iq], &h[iq], &dEmat[iq], &rand[iq],
+                N - iq, twoDivM, coef, beta);
+}
+
+SQAODC_TARGET("avx512f") static
+void sweepAVX512(double *q, const double *qNeibour0, const double *qNeibour1,
+                 const double *h, const double *dEmat, const double *rand, sq::SizeType N,
+                 double twoDivM, double coef, double beta) {
+    const __m512d vTwoDivM = _mm512_set1_pd(twoDivM), vCoef = _mm512_set1_pd(coef);
+    const __m512d vMinusBeta = _mm512_set1_pd(-beta);
+    const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.);
+    int iq = 0;
+    for (; iq + 8 <= N; iq += 8) {
+        __m512d vq = _mm512_loadu_pd(&q[iq]);
+        __m512d hdE = _mm512_add_pd(_mm512_loadu_pd(&h[iq]), _mm512_loadu_pd(&dEmat[iq]));
+        __m512d dE = _mm512_mul_pd(_mm512_mul_pd(vTwoDivM, vq), hdE);
+        __m512d qNeibour = _mm512_add_pd(_mm512_loadu_pd(&qNeibour0[iq]),
+                                         _mm512_loadu_pd(&qNeibour1[iq]));
+        dE = _mm512_fnmadd_pd(_mm512_mul_pd(vq, qNeibour), vCoef, dE);
+        __m512d thresh = expAVX512(_mm512_mul_pd(dE, vMinusBeta));
+        thresh = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(dE, zero, _CMP_LT_OQ), thresh, one);
+        __mmask8 accept = _mm512_cmp_pd_mask(_mm512_loadu_pd(&rand[iq]), thresh, _CMP_LT_OQ);
+        _mm512_storeu_pd(&q[iq], _mm512_mask_sub_pd(vq, accept, zero, vq));
+    }
+    sweepScalar(&q[iq], &qNeibour0[iq], &qNeibour1[iq], &h[iq], &dEmat[iq], &rand[iq],
+                N - iq, twoDivM, coef, beta);
+}
+
+SQAODC_TARGET("avx512f") static
+void expAVX512(float *y, const float *x, sq::SizeType N) {
+    int idx = 0;
+    for (; idx + 16 <= N; idx += 16)
+        _mm512_storeu_ps(&y[idx], expAVX512(_mm512_loadu_ps(&x[idx])));
+    if (idx < N) {
+        float buf[16] = { 0.f };
+        for (int iv = 0; iv < N - idx; ++iv)
+            buf[iv] = x[idx + iv];
+        _mm512_storeu_ps(buf, expAVX512(_mm512_loadu_ps(buf)));
+        for (int iv = 0; iv < N - idx; ++iv)
+            y[idx + iv] = buf[iv];
+    }
+}
+
+SQAODC_TARGET("avx512f") static
+void expAVX512(double *y, const double *x, sq::SizeType N) {
+    int idx = 0;
+    for (; idx + 8 <= N; idx += 8)
+        _mm512_storeu_pd(&y[idx], expAVX512(_mm512_loadu_pd(&x[idx])));
+    if (idx < N) {
+        double buf[8] = { 0. };
+        for (int iv = 0; iv < N - idx; ++iv)
+            buf[iv] = x[idx + iv];
+        _mm512_storeu_pd(buf, expAVX512(_mm512_loadu_pd(buf)));
+        for (int iv = 0; iv < N - idx; ++iv)
+            y[idx + iv] = buf[iv];
+    }
+}
+
+
+static bool hostSupports(MetropolisSweepISA isa) {
+    if (isa == msisaScalar)
+        return true;
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (isa == msisaAVX512)
+        return __builtin_cpu_supports("avx512f") != 0;
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    int info[4];
+    __cpuidex(info, 1, 0);
+    bool osxsave = ((info[2] >> 27) & 1) != 0;
+    bool fma = ((info[2] >> 12) & 1) != 0;
+    if (!osxsave)
+        return false;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    bool avx2 = ((info[1] >> 5) & 1) != 0;
+    bool avx512f = ((info[1] >> 16) & 1) != 0;
+    if (isa == msisaAVX512)
+        return avx512f && ((xcr0 & 0xe6) == 0xe6);
+    return avx2 && fma && ((xcr0 & 0x6) == 0x6);
+#endif
+}
+
+#else
+
+static bool hostSupports(MetropolisSweepISA isa) {
+    return isa == msisaScalar;
+}
+
+#endif
+
+
+static MetropolisSweepISA detectISA() {
+    if (hostSupports(msisaAVX512))
+        return msisaAVX512;
+    if (hostSupports(msisaAVX2))
+        return msisaAVX2;
+    return msisaScalar;
+}
+
+static MetropolisSweepISA selectedISA() {
+    static const MetropolisSweepISA isa = detectISA(); /* detected once */
+    return isa;
+}
+
+const char *sqaod_cpu::metropolisSweepISA() {
+    switch (selectedISA()) {
+    case msisaAVX512:
+        return "avx512";
+    case msisaAVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+bool sqaod_cpu::metropolisSweepSupports(MetropolisSweepISA isa) {
+    return hostSupports(isa);
+}
+
+
+/* isa is not checked here, since sweeps are called for every trotter in half steps. */
+template<class real> static
+void sweep(MetropolisSweepISA isa,
+           real *q, const real *qNeibour0, const real *qNeibour1,
+           const real *h, const real *dEmat, const real *rand, sq::SizeType N,
+           real twoDivM, real coef, real beta) {
+    switch (isa) {
+#ifdef SQAODC_SIMD_ENABLED
+    case msisaAVX512:
+        sweepAVX512(q, qNeibour0, qNeibour1, h, dEmat, rand, N, twoDivM, coef, beta);
+        break;
+    case msisaAVX2:
+        sweepAVX2(q, qNeibour0, qNeibour1, h, dEmat, rand, N, twoDivM, coef, beta);
+        break;
+#endif
+    default:
+        sweepScalar(q, qNeibour0, qNeibour1, h, dEmat, rand, N, twoDivM, coef, beta);
+        break;
+    }
+}
+
+template<class real>
+void sqaod_cpu::metropolisSweep(real *q, const real *qNeibour0, const real *qNeibour1,
+                                const real *h, const real *dEmat, const real *rand, sq::SizeType N,
+                                real twoDivM, real coef, real beta) {
+    sweep(selectedISA(), q, qNeibour0, qNeibour1, h, dEmat, rand, N, twoDivM, coef, beta);
+}
+
+template<class real>
+void sqaod_cpu::metropolisSweep(MetropolisSweepISA isa,
+                                real *q, const real *qNeibour0, const real *qNeibour1,
+                                const real *h, const real *dEmat, const real *rand, sq::SizeType N,
+                                real twoDivM, real coef, real beta) {
+    throwErrorIf(!hostSupports(isa), "Instruction set is not supported by the host.");
+    sweep(isa, q, qNeibour0, qNeibour1, h, dEmat, rand, N, twoDivM, coef, beta);
+}
+
+template<class real>
+void sqaod_cpu::metropolisSweepExp(MetropolisSweepISA isa, real *y, const real *x, sq::SizeType N) {
+    throwErrorIf(!hostSupports(isa), "Instruction set is not supported by the host.");
+    switch (isa) {
+#ifdef SQAODC_SIMD_ENABLED
+    case msisaAVX512:
+        expAVX512(y, x, N);
+        break;
+    case msisaAVX2:
+        expAVX2(y, x, N);
+        break;
+#endif
+    default:
+        expScalar(y, x, N);
+        break;
+    }
+}
+
+
+template void sqaod_cpu::metropolisSweep<float>(float *, const float *, const float *,
+                                                const float *, const float *, const float *,
+                                                sq::SizeType, float, float, float);
+template void sqaod_cpu::metropolisSweep<double>(double *, const double *, const double *,
+                                                 const double *, const double *, const double *,
+                                                 sq::SizeType, double, double, double);
+template void sqaod_cpu::metropolisSweep<float>(MetropolisSweepISA,
+                                                float *, const float *, const float *,
+                                                const float *, const float *, const float *,
+                                                sq::SizeType, float, float, float);
+template void sqaod_cpu::metropolisSweep<double>(MetropolisSweepISA,
+                                                 double *, const double *, const double *,
+                                                 const double *, const double *, const double *,
+                                                 sq::SizeType, double, double, double);
+template void sqaod_cpu::metropolisSweepExp<float>(MetropolisSweepISA,
+                                                   float *, const float *, sq::SizeType);
+template void sqaod_cpu::metropolisSweepExp<double>(MetropolisSweepISA,
+                                                    double *, const double *, sq::SizeType);
@@ -0,0 +1,49 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/types.h>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* Metropolis sweep over a row of spins whose flips are independent of each other,
+ * used in coloring half steps of bipartite graph annealers.
+ *
+ *   dE = twoDivM * q[i] * (h[i] + dEmat[i]) - q[i] * (qNeibour0[i] + qNeibour1[i]) * coef
+ *   q[i] is flipped if exp(-dE * beta) > rand[i].
+ *
+ * The kernel is selected at runtime from AVX-512, AVX2 and scalar implementations. */
+
+template<class real>
+void metropolisSweep(real *q, const real *qNeibour0, const real *qNeibour1,
+                     const real *h, const real *dEmat, const real *rand, sq::SizeType N,
+                     real twoDivM, real coef, real beta);
+
+/* name of the instruction set selected for metropolisSweep(), "avx512", "avx2" or "scalar". */
+const char *metropolisSweepISA();
+
+
+/* instruction sets of kernels, used to run kernels other than the selected one in tests. */
+enum MetropolisSweepISA {
+    msisaScalar,
+    msisaAVX2,
+    msisaAVX512,
+};
+
+/* true if the host runs kernels of isa. */
+bool metropolisSweepSupports(MetropolisSweepISA isa);
+
+template<class real>
+void metropolisSweep(MetropolisSweepISA isa,
+                     real *q, const real *qNeibour0, const real *qNeibour1,
+                     const real *h, const real *dEmat, const real *rand, sq::SizeType N,
+                     real twoDivM, real coef, real beta);
+
+/* y = exp(x) by the vector exp() of kernels.  For x in [-87, 0] (float) or [-708, 0] (double),
+ * relative errors against std::exp() are within 2^-22 (float) and 2^-50 (double).
+ * The scalar kernel uses std::exp(). */
+template<class real>
+void metropolisSweepExp(MetropolisSweepISA isa, real *y, const real *x, sq::SizeType N);
+
+}
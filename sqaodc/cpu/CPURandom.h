@@ -0,0 +1,62 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Random.h>
+#include <sqaodc/common/RandomXoshiro.h>
+#include <sqaodc/common/RandomPhilox.h>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* random number generator used in CPU annealers.
+ *
+ * By default, each thread has its own xoshiro stream, so the result depends on
+ * which thread processes which trotter.
+ * In the counter-based mode, annealers call seek(step, trotter, index) before
+ * drawing random numbers for a (step, trotter, index) tuple, and draws are given
+ * by Philox keyed on the seed.  All threads share the same seed, so the result does
+ * not depend on the number of threads or on the OpenMP schedule. */
+
+class CPURandom {
+public:
+    CPURandom() : counterBased_(false) { }
+
+    void seed(unsigned long long s) {
+        xoshiro_.seed(s);
+        philox_.seed(s);
+    }
+
+    void setCounterBased(bool counterBased) {
+        counterBased_ = counterBased;
+    }
+
+    void seek(unsigned int step, unsigned int trotter, unsigned int index) {
+        if (counterBased_)
+            philox_.seek(index, trotter, step);
+    }
+
+    unsigned long randInt(int N) {
+        return counterBased_ ? philox_.randInt(N) : xoshiro_.randInt(N);
+    }
+
+    template<class real>
+    real random() {
+        return counterBased_ ? philox_.random<real>() : xoshiro_.random<real>();
+    }
+
+    template<class real>
+    void fill(real *v, sq::SizeType size) {
+        if (counterBased_)
+            philox_.fill(v, size);
+        else
+            xoshiro_.fill(v, size);
+    }
+
+private:
+    bool counterBased_;
+    sq::RandomXoshiro xoshiro_;
+    sq::RandomPhilox philox_;
+};
+
+}
@@ -0,0 +1,93 @@
+#include "CPURangeScheduler.h"
+#include <algorithm>
+
+using namespace sqaod_cpu;
+namespace sq = sqaod;
+
+CPURangeScheduler::CPURangeScheduler() {
+    ranges_ = NULL;
+    nThreads_ = 0;
+    capacity_ = 0;
+    minChunk_ = maxChunk_ = 1;
+}
+
+CPURangeScheduler::~CPURangeScheduler() {
+    delete [] ranges_;
+    ranges_ = NULL;
+}
+
+void CPURangeScheduler::reset(sq::PackedBitSet begin, sq::PackedBitSet end, int nThreads,
+                              sq::SizeType minChunk, sq::SizeType maxChunk) {
+    throwErrorIf(nThreads <= 0, "# threads must be a positive integer.");
+    if (capacity_ < nThreads) {
+        delete [] ranges_;
+        ranges_ = new Range[nThreads];
+        capacity_ = nThreads;
+    }
+    nThreads_ = nThreads;
+    minChunk_ = std::max(sq::SizeType(1), minChunk);
+    maxChunk_ = std::max(minChunk_, (sq::PackedBitSet)maxChunk);
+
+    sq::PackedBitSet span = end - begin;
+    sq::PackedBitSet quotient = span / nThreads, residue = span % nThreads;
+    for (int idx = 0; idx < nThreads; ++idx) {
+        ranges_[idx].begin = begin + quotient * idx + std::min((sq::PackedBitSet)idx, residue);
+        ranges_[idx].end = ranges_[idx].begin + quotient + ((sq::PackedBitSet)idx < residue ? 1 : 0);
+    }
+}
+
+bool CPURangeScheduler::acquire(int threadNum, sq::PackedBitSet *chunkBegin,
+                                sq::PackedBitSet *chunkEnd) {
+    Range &own = ranges_[threadNum];
+    do {
+        std::lock_guard<std::mutex> guard(own.lock);
+        sq::PackedBitSet remaining = own.end - own.begin;
+        if (remaining != 0) {
+            sq::PackedBitSet chunk = std::max(minChunk_, std::min(maxChunk_, remaining / 4));
+            chunk = std::min(chunk, remaining);
+            *chunkBegin = own.begin;
+            own.begin += chunk;
+            *chunkEnd = own.begin;
+            return true;
+        }
+    } while (steal(threadNum));
+    return false;
+}
+
+bool CPURangeScheduler::steal(int threadNum) {
+    for (;;) {
+        int victim = -1;
+        sq::PackedBitSet maxRemaining = 0;
+        for (int idx = 0; idx < nThreads_; ++idx) {
+            if (idx == threadNum)
+                continue;
+            std::lock_guard<std::mutex> guard(ranges_[idx].lock);
+            sq::PackedBitSet remaining = ranges_[idx].end - ranges_[idx].begin;
+            if (maxRemaining < remaining) {
+                maxRemaining = remaining;
+                victim = idx;
+            }
+        }
+        if (victim == -1)
+            return false;
+
+        sq::PackedBitSet stolenBegin, stolenEnd;
+        {
+            std::lock_guard<std::mutex> guard(ranges_[victim].lock);
+            Range &range = ranges_[victim];
+            sq::PackedBitSet remaining = range.end - range.begin;
+            if (remaining == 0)
+                continue; /* taken by others in the meantime, retry. */
+            /* small ranges are taken as a whole, since their owner may not be running. */
+            stolenBegin = range.begin;
+            if (minChunk_ < remaining)
+                stolenBegin += remaining / 2;
+            stolenEnd = range.end;
+            range.end = stolenBegin;
+        }
+        std::lock_guard<std::mutex> guard(ranges_[threadNum].lock);
+        ranges_[threadNum].begin = stolenBegin;
+        ranges_[threadNum].end = stolenEnd;
+        return true;
+    }
+}
@@ -0,0 +1,45 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Common.h>
+#include <mutex>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* Distributes [begin, end) to threads in a parallel region.
+ *
+ * Each thread owns a contiguous sub-range, and takes chunks from its front.  Chunks
+ * shrink from maxChunk toward minChunk as the owned range runs out.  A thread whose
+ * range is empty steals the latter half of the largest remaining range of others, or
+ * the whole of it if it is not larger than minChunk. */
+
+class CPURangeScheduler {
+public:
+    CPURangeScheduler();
+    ~CPURangeScheduler();
+
+    /* called outside of parallel regions. */
+    void reset(sq::PackedBitSet begin, sq::PackedBitSet end, int nThreads,
+               sq::SizeType minChunk, sq::SizeType maxChunk);
+
+    /* called by threads in a parallel region.  Returns false if no work is left. */
+    bool acquire(int threadNum, sq::PackedBitSet *chunkBegin, sq::PackedBitSet *chunkEnd);
+
+private:
+    bool steal(int threadNum);
+
+    struct Range {
+        std::mutex lock;
+        sq::PackedBitSet begin, end;
+        char padding[64]; /* to avoid false sharing */
+    };
+
+    Range *ranges_;
+    int nThreads_;
+    int capacity_;
+    sq::PackedBitSet minChunk_, maxChunk_;
+};
+
+}
@@ -0,0 +1,55 @@
+#include "CPUScratchArena.h"
+#include <algorithm>
+
+using namespace sqaod_cpu;
+
+enum {
+    /* minimum size of blocks in bytes. */
+    minBlockSize = 4096,
+};
+
+CPUScratchArena::CPUScratchArena() : used_(0) {
+}
+
+CPUScratchArena::~CPUScratchArena() {
+    for (size_t idx = 0; idx < blocks_.size(); ++idx)
+        sq::alignedFree(blocks_[idx].data);
+}
+
+void CPUScratchArena::reset() {
+    used_ = 0;
+    if (blocks_.size() <= 1)
+        return;
+    /* merge blocks into one to serve the next call without adding blocks. */
+    size_t size = capacity();
+    for (size_t idx = 0; idx < blocks_.size(); ++idx)
+        sq::alignedFree(blocks_[idx].data);
+    blocks_.clear();
+    addBlock(size);
+}
+
+size_t CPUScratchArena::capacity() const {
+    size_t size = 0;
+    for (size_t idx = 0; idx < blocks_.size(); ++idx)
+        size += blocks_[idx].size;
+    return size;
+}
+
+void *CPUScratchArena::allocateBytes(size_t size) {
+    /* rounded up to cache lines so that every allocation is aligned. */
+    size = ((size + sq::cacheLineSize - 1) / sq::cacheLineSize) * sq::cacheLineSize;
+    if (blocks_.empty() || (blocks_.back().size < used_ + size)) {
+        addBlock(std::max(size, std::max(capacity(), size_t(minBlockSize))));
+        used_ = 0;
+    }
+    void *pv = blocks_.back().data + used_;
+    used_ += size;
+    return pv;
+}
+
+void CPUScratchArena::addBlock(size_t size) {
+    Block block;
+    block.data = (char*)sq::alignedMalloc(size);
+    block.size = size;
+    blocks_.push_back(block);
+}
@@ -0,0 +1,71 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Common.h>
+#include <sqaodc/common/EigenBridge.h>
+#include <vector>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+template<class V>
+using EigenScratchMatrixType = Eigen::Map<sq::EigenMatrixType<V>, Eigen::Aligned64>;
+template<class V>
+using EigenScratchRowVectorType = Eigen::Map<sq::EigenRowVectorType<V>, Eigen::Aligned64>;
+
+/* Scratch memory for temporaries in hot paths, owned by a solver for each thread.
+ *
+ * Memory is drawn by bumping a pointer, and everything drawn is released at once by
+ * reset() at the beginning of a call.  When the arena runs short, a block is added,
+ * and blocks are merged into one at the next reset(), so calls of the same shape
+ * allocate no heap memory after the first call. */
+
+class CPUScratchArena {
+public:
+    CPUScratchArena();
+    ~CPUScratchArena();
+
+    void reset();
+
+    /* memory drawn is aligned to cache lines, and valid until reset(). */
+    template<class V>
+    V *allocate(sq::SizeType size) {
+        return static_cast<V*>(allocateBytes(sizeof(V) * size));
+    }
+
+    template<class V>
+    sq::MatrixType<V> matrix(sq::SizeType rows, sq::SizeType cols) {
+        return sq::MatrixType<V>(allocate<V>(rows * cols), rows, cols);
+    }
+
+    template<class V>
+    EigenScratchMatrixType<V> eigenMatrix(sq::SizeType rows, sq::SizeType cols) {
+        return EigenScratchMatrixType<V>(allocate<V>(rows * cols), rows, cols);
+    }
+
+    template<class V>
+    EigenScratchRowVectorType<V> eigenRowVector(sq::SizeType size) {
+        return EigenScratchRowVectorType<V>(allocate<V>(size), size);
+    }
+
+    /* total size of blocks in bytes. */
+    size_t capacity() const;
+
+private:
+    void *allocateBytes(size_t size);
+
+    void addBlock(size_t size);
+
+    struct Block {
+        char *data;
+        size_t size;
+    };
+    std::vector<Block> blocks_;
+    size_t used_; /* bytes used in the last block */
+
+    CPUScratchArena(const CPUScratchArena &);
+    CPUScratchArena &operator=(const CPUScratchArena &);
+};
+
+}
@@ -0,0 +1,97 @@
+#include "CPUSolutionCollector.h"
+#include <algorithm>
+#include <float.h>
+
+using namespace sqaod_cpu;
+
+static bool xLess(sq::PackedBitSet lhs, sq::PackedBitSet rhs) {
+    return lhs < rhs;
+}
+
+static bool xLess(const sq::PackedBitSetPair &lhs, const sq::PackedBitSetPair &rhs) {
+    if (lhs.bits0 != rhs.bits0)
+        return lhs.bits0 < rhs.bits0;
+    return lhs.bits1 < rhs.bits1;
+}
+
+template<class Entry>
+static bool entryLess(const Entry &lhs, const Entry &rhs) {
+    if (lhs.E != rhs.E)
+        return lhs.E < rhs.E;
+    return xLess(lhs.x, rhs.x);
+}
+
+
+template<class real, class X>
+CPUSolutionCollector<real, X>::CPUSolutionCollector() {
+    reset(0, real(-1.), 0);
+}
+
+template<class real, class X>
+void CPUSolutionCollector<real, X>::reset(sq::SizeType topK, real energyWindow,
+                                          sq::SizeType maxSize) {
+    topK_ = topK;
+    maxSize_ = maxSize;
+    truncated_ = false;
+    energyWindow_ = energyWindow;
+    Emin_ = FLT_MAX;
+    heap_.clear();
+    updateThreshold();
+}
+
+template<class real, class X>
+void CPUSolutionCollector<real, X>::updateThreshold() {
+    threshold_ = FLT_MAX;
+    if (0 <= energyWindow_)
+        threshold_ = std::min(threshold_, Emin_ + energyWindow_);
+    if (!heap_.empty() && ((sq::SizeType)heap_.size() == capacity()))
+        threshold_ = std::min(threshold_, heap_.front().E);
+}
+
+template<class real, class X>
+void CPUSolutionCollector<real, X>::push(const Entry &entry) {
+    Emin_ = std::min(Emin_, entry.E);
+    if ((sq::SizeType)heap_.size() == capacity()) {
+        /* states in the window are dropped only by maxSize. */
+        truncated_ |= (topK_ == 0);
+        /* E is not larger than the largest, compared with x for ties. */
+        if (!entryLess(entry, heap_.front()))
+            return;
+        std::pop_heap(heap_.begin(), heap_.end(), entryLess<Entry>);
+        heap_.back() = entry;
+    }
+    else {
+        heap_.push_back(entry);
+    }
+    std::push_heap(heap_.begin(), heap_.end(), entryLess<Entry>);
+
+    if (0 <= energyWindow_) {
+        while (Emin_ + energyWindow_ < heap_.front().E) {
+            std::pop_heap(heap_.begin(), heap_.end(), entryLess<Entry>);
+            heap_.pop_back();
+        }
+    }
+    updateThreshold();
+}
+
+template<class real, class X>
+void CPUSolutionCollector<real, X>::merge(const CPUSolutionCollector &other) {
+    truncated_ |= other.truncated_;
+    for (size_t idx = 0; idx < other.heap_.size(); ++idx) {
+        const Entry &entry = other.heap_[idx];
+        if (entry.E <= threshold_)
+            push(entry);
+    }
+}
+
+template<class real, class X>
+void CPUSolutionCollector<real, X>::getSolutions(std::vector<Entry> *entries) const {
+    *entries = heap_;
+    std::sort(entries->begin(), entries->end(), entryLess<Entry>);
+}
+
+
+template class sqaod_cpu::CPUSolutionCollector<float, sq::PackedBitSet>;
+template class sqaod_cpu::CPUSolutionCollector<double, sq::PackedBitSet>;
+template class sqaod_cpu::CPUSolutionCollector<float, sq::PackedBitSetPair>;
+template class sqaod_cpu::CPUSolutionCollector<double, sq::PackedBitSetPair>;
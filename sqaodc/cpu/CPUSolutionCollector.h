@@ -0,0 +1,76 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Common.h>
+#include <vector>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* Collects low-lying states visited by a thread of brute force searchers.
+ *
+ * In the top-K mode, K lowest states are kept.  In the energy-window mode, states of
+ * E <= Emin + energyWindow are kept, where Emin is the lowest energy visited so far.
+ * Both limits apply if both are given.  Without top-K, the number of states is capped at
+ * maxSize, and the lowest maxSize states are kept.  States are kept in a max-heap ordered
+ * by (E, x), so collected states do not depend on the visiting order, and states above
+ * threshold() are rejected by one comparison. */
+
+template<class real, class X>
+class CPUSolutionCollector {
+public:
+    struct Entry {
+        Entry() { }
+        Entry(real _E, const X &_x) : E(_E), x(_x) { }
+        real E;
+        X x;
+    };
+
+    CPUSolutionCollector();
+
+    /* topK == 0 : up to maxSize states, energyWindow < 0 : no energy window. */
+    void reset(sq::SizeType topK, real energyWindow, sq::SizeType maxSize);
+
+    bool isEnabled() const {
+        return (0 < topK_) || (0 <= energyWindow_);
+    }
+
+    real threshold() const {
+        return threshold_;
+    }
+
+    void add(real E, const X &x) {
+        if (threshold_ < E)
+            return;
+        push(Entry(E, x));
+    }
+
+    /* merges states of another collector, called after searches. */
+    void merge(const CPUSolutionCollector &other);
+
+    /* states in the ascending order of (E, x). */
+    void getSolutions(std::vector<Entry> *entries) const;
+
+    /* true if states in the energy window are dropped by maxSize. */
+    bool isTruncated() const {
+        return truncated_;
+    }
+
+private:
+    void push(const Entry &entry);
+
+    void updateThreshold();
+
+    sq::SizeType capacity() const {
+        return (0 < topK_) ? topK_ : maxSize_;
+    }
+
+    sq::SizeType topK_, maxSize_;
+    bool truncated_;
+    real energyWindow_;
+    real Emin_, threshold_;
+    std::vector<Entry> heap_;
+};
+
+}
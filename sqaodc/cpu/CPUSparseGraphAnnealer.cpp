@@ -0,0 +1,476 @@
+#include "CPUSparseGraphAnnealer.h"
+#include <sqaodc/common/ShapeChecker.h>
+#include <common/Common.h>
+#include <algorithm>
+#include <time.h>
+
+namespace sqint = sqaod_internal;
+using namespace sqaod_cpu;
+
+/* # spins processed by a work item in a colored sweep. */
+static const int colorChunkSize = 256;
+/* default # trotters is N / 4 as dense graph annealers, capped so that spins of
+ * large sparse graphs fit in memory. */
+static const int maxDefaultTrotters = 256;
+
+template<class real>
+CPUSparseGraphAnnealer<real>::CPUSparseGraphAnnealer() {
+    m_ = -1;
+    bitSetsValid_ = false;
+    c_ = real(0.);
+    seed_ = 0;
+    counterBased_ = false;
+    step_ = 0;
+    random_ = NULL;
+    nMaxThreads_ = 0;
+#ifdef _OPENMP
+    setNumThreads(omp_get_max_threads());
+    sq::log("# max threads: %d", nMaxThreads_);
+#else
+    setNumThreads(1);
+#endif
+}
+
+template<class real>
+CPUSparseGraphAnnealer<real>::~CPUSparseGraphAnnealer() {
+    delete [] random_;
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::seed(unsigned long long seed) {
+    seed_ = seed;
+    /* threads share the seed in the counter-based mode. */
+    for (int idx = 0; idx < nMaxThreads_; ++idx) {
+        random_[idx].seed(counterBased_ ? seed : seed + 17 * idx);
+        random_[idx].setCounterBased(counterBased_);
+    }
+    step_ = 0;
+    setState(solRandSeedGiven);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::setNumThreads(int nThreads) {
+    if (nThreads == nMaxThreads_)
+        return;
+    delete [] random_;
+    nMaxThreads_ = nThreads;
+    random_ = new CPURandom[nMaxThreads_];
+    if (isRandSeedGiven())
+        seed(seed_);
+}
+
+
+template<class real>
+sq::Algorithm CPUSparseGraphAnnealer<real>::selectAlgorithm(enum sq::Algorithm algo) {
+    if ((algo != sq::algoColoring) && (algo != sq::algoDefault))
+        sq::log("Uknown algo, %s, defaulting to %s.",
+                sq::algorithmToString(algo), sq::algorithmToString(sq::algoColoring));
+    return sq::algoColoring;
+}
+
+template<class real>
+sq::Algorithm CPUSparseGraphAnnealer<real>::getAlgorithm() const {
+    return sq::algoColoring;
+}
+
+
+/* copy off-diagonal elements of src x scale to dst.  Columns in rows are sorted,
+ * duplicates are summed up and zeros are removed.  Returns the sum of diagonal elements. */
+template<class real> static
+real compressRows(sq::SparseMatrixType<real> *dst, const sq::SparseMatrixType<real> &src, real scale) {
+    typedef std::pair<sq::IdxType, real> Entry;
+    std::vector<Entry> entries;
+    std::vector<sq::IdxType> rowPtr(src.rows + 1, 0);
+    real diagSum = real(0.);
+    std::vector<Entry> row;
+    for (sq::IdxType i = 0; i < src.rows; ++i) {
+        row.clear();
+        for (sq::IdxType idx = src.rowPtr(i); idx < src.rowPtr(i + 1); ++idx) {
+            if (src.colIdx(idx) == i)
+                diagSum += src.values(idx);
+            else
+                row.push_back(Entry(src.colIdx(idx), src.values(idx)));
+        }
+        std::sort(row.begin(), row.end());
+        for (size_t k = 0; k < row.size(); ) {
+            Entry entry(row[k].first, real(0.));
+            for (; (k < row.size()) && (row[k].first == entry.first); ++k)
+                entry.second += row[k].second;
+            if (entry.second != real(0.))
+                entries.push_back(Entry(entry.first, entry.second * scale));
+        }
+        rowPtr[i + 1] = (sq::IdxType)entries.size();
+    }
+    dst->resize(src.rows, src.cols, (sq::SizeType)entries.size());
+    for (sq::IdxType i = 0; i < src.rows + 1; ++i)
+        dst->rowPtr(i) = rowPtr[i];
+    for (sq::IdxType idx = 0; idx < dst->nnz(); ++idx) {
+        dst->colIdx(idx) = entries[idx].first;
+        dst->values(idx) = entries[idx].second;
+    }
+    return diagSum;
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::setQUBO(const SparseMatrix &W, sq::OptimizeMethod om) {
+    sqint::quboShapeCheck(W, __func__);
+    clearState(solProblemSet);
+
+    N_ = W.rows;
+    m_ = std::min(N_ / 4, maxDefaultTrotters);
+
+    /* h = -1/2 sum_j W(i, j), J = -1/4 W (off-diagonal), c = -1/4 (sum W + trace W) */
+    h_.resize(1, N_);
+    real wSum = real(0.);
+    for (sq::IdxType i = 0; i < N_; ++i) {
+        real rowSum = real(0.);
+        for (sq::IdxType idx = W.rowPtr(i); idx < W.rowPtr(i + 1); ++idx)
+            rowSum += W.values(idx);
+        h_(i) = real(-0.5) * rowSum;
+        wSum += rowSum;
+    }
+    real diagSum = compressRows(&J_, W, real(-0.25));
+    c_ = real(-0.25) * (wSum + diagSum);
+    om_ = om;
+    if (om_ == sq::optMaximize) {
+        h_ *= real(-1.);
+        sq::mapToRowVector(J_.values) *= real(-1.);
+        c_ *= real(-1.);
+    }
+    colorGraph();
+    updateLocalFieldRange();
+    setState(solProblemSet);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::setHamiltonian(const Vector &h, const SparseMatrix &J, real c) {
+    sqint::isingModelShapeCheck(h, J, c, __func__);
+    clearState(solProblemSet);
+
+    N_ = J.rows;
+    m_ = std::min(N_ / 4, maxDefaultTrotters);
+    om_ = sq::optMinimize;
+    h_ = sq::mapToRowVector(h);
+    /* q(i)^2 = 1, diagonal elements of J are constant. */
+    real diagSum = compressRows(&J_, J, real(1.));
+    c_ = c + diagSum;
+    colorGraph();
+    updateLocalFieldRange();
+    setState(solProblemSet);
+}
+
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::updateLocalFieldRange() {
+    /* local fields are given by h + 2 J q. */
+    SparseMatrix J2(J_);
+    sq::mapToRowVector(J2.values) *= real(2.);
+    acceptance_.clearLocalFieldRange();
+    acceptance_.addLocalFieldRange(h_, J2);
+}
+
+
+/* greedy coloring in the descending order of degrees. */
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::colorGraph() {
+    std::vector<sq::IdxType> order(N_);
+    for (sq::IdxType i = 0; i < N_; ++i)
+        order[i] = i;
+    const SparseMatrix &J = J_;
+    std::stable_sort(order.begin(), order.end(), [&J](sq::IdxType lhs, sq::IdxType rhs) {
+            return (J.rowPtr(lhs + 1) - J.rowPtr(lhs)) > (J.rowPtr(rhs + 1) - J.rowPtr(rhs));
+        });
+
+    std::vector<sq::IdxType> colors(N_, -1);
+    std::vector<sq::IdxType> usedBy; /* usedBy[color] == i if a neighbour of i has the color. */
+    sq::SizeType nColors = 0;
+    for (sq::IdxType k = 0; k < N_; ++k) {
+        sq::IdxType i = order[k];
+        for (sq::IdxType idx = J_.rowPtr(i); idx < J_.rowPtr(i + 1); ++idx) {
+            sq::IdxType color = colors[J_.colIdx(idx)];
+            if (color != -1)
+                usedBy[color] = i;
+        }
+        sq::IdxType color = 0;
+        while ((color < nColors) && (usedBy[color] == i))
+            ++color;
+        if (color == nColors) {
+            ++nColors;
+            usedBy.push_back(-1);
+        }
+        colors[i] = color;
+    }
+
+    /* bucket variables by colors, variables in a color are in the ascending order. */
+    colorPtr_.assign(nColors + 1, 0);
+    for (sq::IdxType i = 0; i < N_; ++i)
+        ++colorPtr_[colors[i] + 1];
+    for (sq::IdxType color = 0; color < nColors; ++color)
+        colorPtr_[color + 1] += colorPtr_[color];
+    colorVertices_.resize(N_);
+    std::vector<sq::IdxType> pos(colorPtr_.begin(), colorPtr_.end() - 1);
+    for (sq::IdxType i = 0; i < N_; ++i)
+        colorVertices_[pos[colors[i]]++] = i;
+
+    chunkOffset_.assign(nColors + 1, 0);
+    for (sq::IdxType color = 0; color < nColors; ++color) {
+        sq::SizeType nVertices = colorPtr_[color + 1] - colorPtr_[color];
+        sq::SizeType nChunks = (nVertices + colorChunkSize - 1) / colorChunkSize;
+        chunkOffset_[color + 1] = chunkOffset_[color] + nChunks;
+    }
+}
+
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::setPreference(const sq::Preference &pref) {
+    if (pref.name == sq::pnNumThreads) {
+        throwErrorIf(pref.nThreads <= 0, "# threads must be a positive integer.");
+        setNumThreads(pref.nThreads);
+    }
+    else if (pref.name == sq::pnAcceptance) {
+        acceptance_.setMethod(pref.acceptance);
+    }
+    else if (pref.name == sq::pnRandom) {
+        throwErrorIf(pref.rng == sq::rngUnknown, "Unknown random number generator.");
+        counterBased_ = (pref.rng == sq::rngCounterBased);
+        if (isRandSeedGiven())
+            seed(seed_);
+    }
+    else {
+        Base::setPreference(pref);
+    }
+}
+
+template<class real>
+sq::Preferences CPUSparseGraphAnnealer<real>::getPreferences() const {
+    sq::Preferences prefs = Base::getPreferences();
+    prefs.pushBack(sq::Preference(sq::pnDevice, "cpu"));
+    prefs.pushBack(sq::Preference(sq::pnNumThreads, nMaxThreads_));
+    prefs.pushBack(sq::Preference(sq::pnRandom, counterBased_ ? sq::rngCounterBased : sq::rngDefault));
+    prefs.pushBack(sq::Preference(sq::pnAcceptance, acceptance_.getMethod()));
+    return prefs;
+}
+
+template<class real>
+const sq::VectorType<real> &CPUSparseGraphAnnealer<real>::get_E() const {
+    if (!isEAvailable())
+        const_cast<This*>(this)->calculate_E();
+    return E_;
+}
+
+template<class real>
+const sq::BitSetArray &CPUSparseGraphAnnealer<real>::get_x() const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    const_cast<This*>(this)->syncBitSets();
+    return bitSetsX_;
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::get_x(sq::BitMatrix *x) const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    sq::copyToMatrix(x, bitsX_);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::set_x(const sq::BitSet &x) {
+    throwErrorIfNotPrepared();
+    throwErrorIf(x.size != N_,
+                 "Dimension of x, %d,  should be equal to N, %d.", x.size, N_);
+
+    EigenRowVector ex = mapToRowVector(sq::cast<real>(x));
+    sq::mapToAligned(matQ_).rowwise() = (ex.array() * 2 - 1).matrix();
+    setState(solQSet);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::getHamiltonian(Vector *h, SparseMatrix *J, real *c) const {
+    throwErrorIfProblemNotSet();
+    throwErrorIf((h == NULL) || (J == NULL) || (c == NULL), "%s, NULL given.", __func__);
+    if (h->data == NULL)
+        h->allocate(N_);
+    throwErrorIf(h->size != N_, "%s, Shape does not match.", __func__);
+    mapToRowVector(*h) = h_;
+    if (J->values.data == NULL)
+        J->resize(N_, N_, J_.nnz());
+    throwErrorIf((J->dim() != J_.dim()) || (J->nnz() != J_.nnz()),
+                 "%s, Shape does not match.", __func__);
+    J->rowPtr.copyFrom(J_.rowPtr);
+    J->colIdx.copyFrom(J_.colIdx);
+    J->values.copyFrom(J_.values);
+    *c = c_;
+}
+
+template<class real>
+const sq::BitSetArray &CPUSparseGraphAnnealer<real>::get_q() const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    const_cast<This*>(this)->syncBitSets();
+    return bitSetsQ_;
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::get_q(sq::BitMatrix *q) const {
+    if (!isSolutionAvailable())
+        const_cast<This*>(this)->makeSolution();
+    sq::copyToMatrix(q, bitsQ_);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::randomizeSpin() {
+    throwErrorIfNotPrepared();
+    for (int y = 0; y < sq::IdxType(m_); ++y) {
+        random_[0].seek(step_, y, 0);
+        for (int x = 0; x < sq::IdxType(N_); ++x)
+            matQ_(y, x) = random_[0].randInt(2) ? real(1.) : real(-1.);
+    }
+    ++step_;
+    setState(solQSet);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::prepare() {
+    throwErrorIfProblemNotSet();
+    throwErrorIf(m_ <= 0, "# trotters must be a positive integer.");
+    if (!isRandSeedGiven())
+        seed((unsigned long long)time(NULL));
+    setState(solRandSeedGiven);
+    bitsX_.resize(m_, N_);
+    bitsQ_.resize(m_, N_);
+    matQ_.resize(m_, N_, sq::paddedStride<real>(N_));
+    E_.resize(m_);
+
+    setState(solPrepared);
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::makeSolution() {
+    throwErrorIfQNotSet();
+    syncBits();
+    setState(solSolutionAvailable);
+    calculate_E();
+}
+
+
+/* E = - c - sum_i q(i) (h(i) + sum_j J(i, j) q(j)) */
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::calculate_E() {
+    throwErrorIfQNotSet();
+#pragma omp parallel for num_threads(nMaxThreads_)
+    for (int y = 0; y < sq::IdxType(m_); ++y) {
+        real sum = real(0.);
+        for (sq::IdxType x = 0; x < N_; ++x) {
+            real field = h_(x);
+            for (sq::IdxType idx = J_.rowPtr(x); idx < J_.rowPtr(x + 1); ++idx)
+                field += J_.values(idx) * matQ_(y, J_.colIdx(idx));
+            sum += matQ_(y, x) * field;
+        }
+        E_(y) = - c_ - sum;
+    }
+    if (om_ == sq::optMaximize)
+        mapToRowVector(E_) *= real(-1.);
+    setState(solEAvailable);
+}
+
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::syncBits() {
+    for (int idx = 0; idx < sq::IdxType(m_); ++idx) {
+        for (int x = 0; x < sq::IdxType(N_); ++x)
+            bitsQ_(idx, x) = (char)matQ_(idx, x);
+    }
+    sq::x_from_q(bitsX_.data, bitsQ_.data, m_ * N_);
+    bitSetsValid_ = false;
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::syncBitSets() {
+    if (bitSetsValid_)
+        return;
+    bitSetsX_.clear();
+    bitSetsQ_.clear();
+    bitSetsX_.reserve(m_);
+    bitSetsQ_.reserve(m_);
+    for (int idx = 0; idx < sq::IdxType(m_); ++idx) {
+        bitSetsX_.pushBack(sq::BitSet(&bitsX_(idx, 0), N_));
+        bitSetsQ_.pushBack(sq::BitSet(&bitsQ_(idx, 0), N_));
+    }
+    bitSetsValid_ = true;
+}
+
+
+template<class real> inline static
+void tryFlip(sq::MatrixType<real> &matQ, int y, int x,
+             const sq::EigenRowVectorType<real> &h, const sq::SparseMatrixType<real> &J,
+             CPURandom &random, const CPUAcceptance<real> &acceptance) {
+    int m = matQ.rows;
+    real qyx = matQ(y, x);
+    /* J(x, j) and J(j, x) contribute to E, the local field is h(x) + 2 sum_j J(x, j) q(y, j). */
+    real sum = real(0.);
+    for (sq::IdxType idx = J.rowPtr(x); idx < J.rowPtr(x + 1); ++idx)
+        sum += J.values(idx) * matQ(y, J.colIdx(idx));
+    real field = h(x) + real(2.) * sum;
+    int neibour0 = (y == 0) ? m - 1 : y - 1;
+    int neibour1 = (y == m - 1) ? 0 : y + 1;
+    real qNeibour = qyx * (matQ(neibour0, x) + matQ(neibour1, x));
+    if (acceptance.accept(qyx * field, qNeibour, random.random<real>()))
+        matQ(y, x) = - qyx;
+}
+
+
+/* annealColoredRows() is called by all threads in a parallel region.
+ * A work item is a chunk of spins of the color in a trotter. */
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::annealColoredRows(CPURandom &random, int color, int yBegin, int nRows) {
+    sq::IdxType vBegin = colorPtr_[color], vEnd = colorPtr_[color + 1];
+    int nChunks = chunkOffset_[color + 1] - chunkOffset_[color];
+    int nItems = nRows * nChunks;
+#pragma omp for
+    for (int item = 0; item < nItems; ++item) {
+        int y = yBegin + (item / nChunks) * 2;
+        int chunk = item % nChunks;
+        random.seek(step_, y, chunkOffset_[color] + chunk);
+        sq::IdxType begin = vBegin + chunk * colorChunkSize;
+        sq::IdxType end = std::min(begin + colorChunkSize, vEnd);
+        for (sq::IdxType idx = begin; idx < end; ++idx)
+            tryFlip(matQ_, y, colorVertices_[idx], h_, J_, random, acceptance_);
+    }
+}
+
+template<class real>
+void CPUSparseGraphAnnealer<real>::annealOneStepColoring(real G, real beta) {
+    throwErrorIfQNotSet();
+
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G * beta / m_)) * beta;
+    acceptance_.prepare(twoDivM, coef, beta);
+
+    /* even and odd trotters in turn, the last trotter is separately processed if m is odd. */
+    int m2 = (m_ / 2) * 2; /* round down */
+    int nColors = getNumColors();
+#ifndef _OPENMP
+    {
+        CPURandom &random = random_[0];
+#else
+#  pragma omp parallel num_threads(nMaxThreads_)
+    {
+        CPURandom &random = random_[omp_get_thread_num()];
+#endif
+        for (int color = 0; color < nColors; ++color) {
+            annealColoredRows(random, color, 0, m2 / 2);
+            annealColoredRows(random, color, 1, m2 / 2);
+            if ((m_ % 2) != 0)
+                annealColoredRows(random, color, m_ - 1, 1);
+        }
+    }
+    ++step_;
+    clearState(solSolutionAvailable);
+}
+
+
+template class CPUSparseGraphAnnealer<float>;
+template class CPUSparseGraphAnnealer<double>;
@@ -0,0 +1,144 @@
+/* -*- c++ -*- */
+#pragma once
+
+#include <sqaodc/common/Common.h>
+#include <sqaodc/common/EigenBridge.h>
+#include <sqaodc/cpu/CPURandom.h>
+#include <sqaodc/cpu/CPUAcceptance.h>
+#include <vector>
+
+namespace sqaod_cpu {
+
+namespace sq = sqaod;
+
+/* Annealer for sparse graphs, J is stored in the CSR format.
+ *
+ * Variables are colored so that no two coupled variables share a color.  Spins of
+ * a color are independent of each other in a trotter, and are flipped in parallel
+ * for even and odd trotters in turn.  Local fields, h + 2 J q, are computed on demand
+ * with O(degree) cost, and memory use is O(m N + nnz). */
+
+template<class real>
+class CPUSparseGraphAnnealer : public sq::SparseGraphAnnealer<real> {
+
+    typedef sq::EigenRowVectorType<real> EigenRowVector;
+    typedef sq::SparseMatrixType<real> SparseMatrix;
+    typedef sq::MatrixType<real> Matrix;
+    typedef sq::VectorType<real> Vector;
+
+public:
+    CPUSparseGraphAnnealer();
+    ~CPUSparseGraphAnnealer();
+
+    void seed(unsigned long long seed);
+
+    sq::Algorithm selectAlgorithm(enum sq::Algorithm algo);
+
+    sq::Algorithm getAlgorithm() const;
+
+    /* void getProblemSize(SizeType *N) const; */
+
+    void setQUBO(const SparseMatrix &W, sq::OptimizeMethod om = sq::optMinimize);
+
+    void setHamiltonian(const Vector &h, const SparseMatrix &J, real c = real(0.));
+
+    void setPreference(const sq::Preference &pref);
+
+    using sq::Solver<real>::setPreference;
+
+    sq::Preferences getPreferences() const;
+
+    const Vector &get_E() const;
+
+    const sq::BitSetArray &get_x() const;
+
+    void get_x(sq::BitMatrix *x) const;
+
+    void set_x(const sq::BitSet &x);
+
+    const sq::BitSetArray &get_q() const;
+
+    void get_q(sq::BitMatrix *q) const;
+
+    void getHamiltonian(Vector *h, SparseMatrix *J, real *c) const;
+
+    void randomizeSpin();
+
+    void prepare();
+
+    void calculate_E();
+
+    void makeSolution();
+
+    void annealOneStep(real G, real beta) {
+        annealOneStepColoring(G, beta);
+    }
+
+    void annealOneStepColoring(real G, real beta);
+
+    /* number of colors given by graph coloring, available after setQUBO()/setHamiltonian(). */
+    sq::SizeType getNumColors() const {
+        return sq::SizeType(colorPtr_.size()) - 1;
+    }
+
+private:
+    /* called by all threads in a parallel region, flips spins of a color in nRows trotters,
+     * yBegin, yBegin + 2, ... */
+    void annealColoredRows(CPURandom &random, int color, int yBegin, int nRows);
+
+    void colorGraph();
+
+    void updateLocalFieldRange();
+
+    void syncBits();
+
+    void syncBitSets();
+
+    void setNumThreads(int nThreads);
+
+    CPURandom *random_;
+    int nMaxThreads_;
+    unsigned long long seed_;
+    bool counterBased_;
+    unsigned int step_; /* counter for the counter-based random mode */
+    CPUAcceptance<real> acceptance_;
+    Vector E_;
+    sq::BitMatrix bitsX_; /* m x N, synced by makeSolution() */
+    sq::BitMatrix bitsQ_;
+    sq::BitSetArray bitSetsX_; /* rows of bitsX_ and bitsQ_, created on get_x() and get_q(). */
+    sq::BitSetArray bitSetsQ_;
+    bool bitSetsValid_;
+    Matrix matQ_; /* m x N, rows are padded to cache lines. */
+    EigenRowVector h_;
+    SparseMatrix J_; /* rows are sorted by column indices, diagonal is folded into c_. */
+    real c_;
+
+    /* variables of the color c are colorVertices_[colorPtr_[c]] ... [colorPtr_[c + 1] - 1].
+     * They are processed in chunks, and chunkOffset_[c] is the index of the first chunk. */
+    std::vector<sq::IdxType> colorPtr_;
+    std::vector<sq::IdxType> colorVertices_;
+    std::vector<sq::IdxType> chunkOffset_;
+
+    typedef CPUSparseGraphAnnealer<real> This;
+    typedef sq::SparseGraphAnnealer<real> Base;
+    using Base::om_;
+    using Base::N_;
+    using Base::m_;
+    /* annealer state */
+    using Base::solRandSeedGiven;
+    using Base::solPrepared;
+    using Base::solProblemSet;
+    using Base::solQSet;
+    using Base::solEAvailable;
+    using Base::solSolutionAvailable;
+    using Base::setState;
+    using Base::clearState;
+    using Base::isRandSeedGiven;
+    using Base::isEAvailable;
+    using Base::isSolutionAvailable;
+    using Base::throwErrorIfProblemNotSet;
+    using Base::throwErrorIfNotPrepared;
+    using Base::throwErrorIfQNotSet;
+};
+
+}
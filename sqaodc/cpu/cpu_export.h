@@ -2,6 +2,7 @@
 
 #include <sqaodc/cpu/CPUDenseGraphBFSearcher.h>
 #include <sqaodc/cpu/CPUDenseGraphAnnealer.h>
+#include <sqaodc/cpu/CPUSparseGraphAnnealer.h>
 #include <sqaodc/cpu/CPUBipartiteGraphBFSearcher.h>
 #include <sqaodc/cpu/CPUBipartiteGraphAnnealer.h>
 #include <sqaodc/cpu/CPUFormulas.h>
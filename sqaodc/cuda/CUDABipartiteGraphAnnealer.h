@@ -59,6 +59,8 @@ public:
 
     const sq::BitSetPairArray &get_x() const;
 
+    using sq::BipartiteGraphAnnealer<real>::get_x;
+
     void set_x(const BitSet &x0, const BitSet &x1);
 
     /* Ising machine / spins */
@@ -67,6 +69,8 @@ public:
 
     const BitSetPairArray &get_q() const;
 
+    using sq::BipartiteGraphAnnealer<real>::get_q;
+
     void randomizeSpin();
 
     void prepare();
@@ -56,10 +56,14 @@ public:
 
     const BitSetArray &get_x() const;
 
+    using sq::DenseGraphAnnealer<real>::get_x;
+
     void set_x(const BitSet &x);
 
     const sq::BitSetArray &get_q() const;
 
+    using sq::DenseGraphAnnealer<real>::get_q;
+
     void getHamiltonian(HostVector *h, HostMatrix *J, real *c) const;
 
     void randomizeSpin();
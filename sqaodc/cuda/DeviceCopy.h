@@ -144,6 +144,7 @@ template<class V> void DeviceCopy::
 operator()(DeviceMatrixType<V> *dst, const sq::MatrixType<V> &src) {
     devAlloc_->allocateIfNull(dst, src.dim());
     assertSameShape(*dst, src, __func__);
+    throwErrorIf(!src.isPacked(), "%s, rows of host matrix should not be padded.", __func__);
     copy(dst->d_data, src.data, src.rows * src.cols);
 }
 
@@ -152,6 +153,7 @@ operator()(sq::MatrixType<V> *dst, const DeviceMatrixType<V> &src) const {
     if (dst->data == NULL)
         dst->resize(src.dim());
     assertSameShape(*dst, src, __func__);
+    throwErrorIf(!dst->isPacked(), "%s, rows of host matrix should not be padded.", __func__);
     copy(dst->data, src.d_data, src.rows * src.cols);
 }
 
@@ -70,9 +70,10 @@ void HostObjectAllocator::allocate(sq::MatrixType<V> *mat, const sq::Dim &dim) {
 
 template<class V> inline
 void HostObjectAllocator::allocate(sq::MatrixType<V> *mat, sq::SizeType rows, sq::SizeType cols) {
-    mat->data = allocate(sizeof(V) * rows * cols);
+    mat->data = (V*)allocate(sizeof(V) * rows * cols);
     mat->rows = rows;
     mat->cols = cols;
+    mat->stride = cols;
 }
 
 template<class V> inline
@@ -41,16 +41,16 @@ struct NpMatrixType {
         mat.map(data, (sq::SizeType)PyArray_SHAPE(arr)[0], (sq::SizeType)PyArray_SHAPE(arr)[1]);
     }
 
-    void allocate(int nRows, int nCols) {
+    NpMatrixType(int nRows, int nCols, int npyType) {
         /* new array object */
         npy_intp dims[2];
         dims[0] = nRows;
         dims[1] = nCols;
-        obj = PyArray_EMPTY(2, dims, NPY_INT8, 0);
+        obj = PyArray_EMPTY(2, dims, npyType, 0);
         PyArrayObject *arr = (PyArrayObject*)obj;
         /* setup members */
-        char *data = (char*)PyArray_DATA(arr);
-        mat.set(data, nRows, nCols);
+        real *data = (real*)PyArray_DATA(arr);
+        mat.map(data, nRows, nCols);
     }
     
     /* accessor for ease of coding. */
@@ -248,16 +248,37 @@ int parsePreference(const char *key, PyObject *valueObj, sqaod::Preference *pref
         *pref = sqaod::Preference(sqaod::pnAlgorithm, algo);
         return 0;
     }
+    case sqaod::pnRandom: {
+        if (!isStringObject(valueObj)) {
+            PyErr_SetString(PyExc_RuntimeError, "random value is not a string");
+            return -1;
+        }
+        sqaod::RandomGenerator rng = sqaod::randomGeneratorFromString(getStringFromObject(valueObj));
+        *pref = sqaod::Preference(sqaod::pnRandom, rng);
+        return 0;
+    }
+    case sqaod::pnAcceptance: {
+        if (!isStringObject(valueObj)) {
+            PyErr_SetString(PyExc_RuntimeError, "acceptance value is not a string");
+            return -1;
+        }
+        sqaod::AcceptanceMethod method =
+                sqaod::acceptanceMethodFromString(getStringFromObject(valueObj));
+        *pref = sqaod::Preference(sqaod::pnAcceptance, method);
+        return 0;
+    }
     case sqaod::pnNumTrotters:
     case sqaod::pnTileSize:
     case sqaod::pnTileSize0:
-    case sqaod::pnTileSize1: {
+    case sqaod::pnTileSize1:
+    case sqaod::pnNumThreads:
+    case sqaod::pnTopK: {
         if (IsIntegerType(valueObj)) {
-            *pref = sqaod::Preference(prefName, PyLong_AsLong(valueObj));
+            *pref = sqaod::Preference(prefName, (sqaod::SizeType)PyLong_AsLong(valueObj));
             return 0;
         }
         else if (PyLong_Check(valueObj)) {
-            *pref = sqaod::Preference(prefName, PyLong_AsLong(valueObj));
+            *pref = sqaod::Preference(prefName, (sqaod::SizeType)PyLong_AsLong(valueObj));
             return 0;
         }
         else {
@@ -265,6 +286,13 @@ int parsePreference(const char *key, PyObject *valueObj, sqaod::Preference *pref
             return -1;
         }
     }
+    case sqaod::pnEnergyWindow: {
+        double value = PyFloat_AsDouble(valueObj);
+        if ((value == -1.) && (PyErr_Occurred() != NULL))
+            return -1;
+        *pref = sqaod::Preference(prefName, value);
+        return 0;
+    }
     default:
         PyErr_SetString(PyExc_RuntimeError, "unknown preference name");
         return -1;
@@ -309,12 +337,25 @@ PyObject *createPreferenceValue(const sqaod::Preference &pref) {
         const char *algoName = sqaod::algorithmToString(pref.algo);
         return Py_BuildValue("s", algoName);
     }
+    case sqaod::pnRandom: {
+        const char *rngName = sqaod::randomGeneratorToString(pref.rng);
+        return Py_BuildValue("s", rngName);
+    }
+    case sqaod::pnAcceptance: {
+        const char *methodName = sqaod::acceptanceMethodToString(pref.acceptance);
+        return Py_BuildValue("s", methodName);
+    }
     case sqaod::pnNumTrotters:
     case sqaod::pnTileSize:
     case sqaod::pnTileSize0:
-    case sqaod::pnTileSize1: {
+    case sqaod::pnTileSize1:
+    case sqaod::pnNumThreads:
+    case sqaod::pnTopK: {
         return Py_BuildValue("i", pref.size);
     }
+    case sqaod::pnEnergyWindow: {
+        return Py_BuildValue("d", pref.value);
+    }
     case sqaod::pnPrecision : {
         return Py_BuildValue("s", pref.precision);
     }
@@ -349,6 +390,24 @@ PyObject *createPreferences(const sqaod::Preferences &prefs) {
             return NULL;                                    \
         }
 
+/* releases the GIL in its scope, so that solvers run concurrently from python threads.
+ * Placed in TRY blocks, the GIL is reacquired before exceptions are caught.
+ * Python C-API must not be called in the scope, though numpy array data passed as
+ * arguments is accessible since callers hold references to arrays. */
+class ScopedGILRelease {
+public:
+    ScopedGILRelease() {
+        state_ = PyEval_SaveThread();
+    }
+    ~ScopedGILRelease() {
+        PyEval_RestoreThread(state_);
+    }
+private:
+    ScopedGILRelease(const ScopedGILRelease &);
+    ScopedGILRelease &operator=(const ScopedGILRelease &);
+    PyThreadState *state_;
+};
+
 
 
 #if PY_MAJOR_VERSION >= 3
@@ -20,6 +20,9 @@ using DenseGraphAnnealer = sqaod_cpu::CPUDenseGraphAnnealer<real>;
 template<class real>
 using DenseGraphFormulas = sqaod_cpu::DGFuncs<real>;
 
+template<class real>
+using SparseGraphAnnealer = sqaod_cpu::CPUSparseGraphAnnealer<real>;
+
 template<class real>
 using BipartiteGraphBFSearcher = sqaod_cpu::CPUBipartiteGraphBFSearcher<real>;
 
@@ -0,0 +1,109 @@
+#include "ArrayTest.h"
+#include <sqaodc/sqaodc.h>
+
+namespace sq = sqaod;
+
+ArrayTest::ArrayTest(void) : MinimalTestSuite("ArrayTest") {
+}
+
+ArrayTest::~ArrayTest(void) {
+}
+
+
+void ArrayTest::setUp() {
+}
+
+void ArrayTest::tearDown() {
+}
+    
+void ArrayTest::run(std::ostream &ostm) {
+
+    testcase("no allocation until elements are added") {
+        sq::ArrayType<int> arr;
+        TEST_ASSERT(arr.capacity() == 0);
+        TEST_ASSERT(arr.data() == nullptr);
+        TEST_ASSERT(arr.empty());
+        sq::ArrayType<int> copied(arr);
+        TEST_ASSERT(copied.capacity() == 0);
+    }
+
+    testcase("insert grows capacity to hold all elements") {
+        const int nElms = 1000;
+        sq::ArrayType<int> src(nElms);
+        for (int idx = 0; idx < nElms; ++idx)
+            src.pushBack(idx);
+        sq::ArrayType<int> arr;
+        arr.pushBack(-1);
+        arr.insert(src.begin(), src.end());
+        TEST_ASSERT(arr.size() == nElms + 1);
+        TEST_ASSERT(nElms + 1 <= arr.capacity());
+        bool ok = (arr[0] == -1);
+        for (int idx = 0; idx < nElms; ++idx)
+            ok &= (arr[idx + 1] == idx);
+        TEST_ASSERT(ok);
+    }
+
+    testcase("insert and erase") {
+        sq::ArrayType<int> arr;
+        for (int idx = 0; idx < 16; ++idx)
+            arr.pushBack(idx);
+        /* reallocated, since the size reaches the capacity. */
+        arr.insert(arr.begin() + 3, arr[10]);
+        TEST_ASSERT(arr.size() == 17);
+        TEST_ASSERT((arr[2] == 2) && (arr[3] == 10) && (arr[4] == 3) && (arr[16] == 15));
+        arr.erase(arr.begin() + 3);
+        bool ok = (arr.size() == 16);
+        for (int idx = 0; idx < 16; ++idx)
+            ok &= (arr[idx] == idx);
+        TEST_ASSERT(ok);
+    }
+
+    testcase("move") {
+        sq::BitSetArray arr;
+        sq::BitSet bits(8);
+        bits = 1;
+        char *data = bits.data;
+        arr.pushBack(std::move(bits));
+        TEST_ASSERT(arr[0].data == data);
+        arr.emplaceBack(8);
+        TEST_ASSERT(arr[1].size == 8);
+
+        const sq::BitSet *elms = arr.data();
+        sq::BitSetArray moved(std::move(arr));
+        TEST_ASSERT(moved.data() == elms);
+        TEST_ASSERT((arr.size() == 0) && (arr.data() == nullptr));
+        arr = std::move(moved);
+        TEST_ASSERT((arr.data() == elms) && (arr.size() == 2));
+        TEST_ASSERT(moved.data() == nullptr);
+    }
+
+    testcase("emplaceBack of an element on reallocation") {
+        sq::BitSetArray arr;
+        for (int idx = 0; idx < 16; ++idx) {
+            arr.emplaceBack(8);
+            arr[idx] = char(idx);
+        }
+        TEST_ASSERT(arr.size() == arr.capacity());
+        arr.emplaceBack(arr[3]);
+        arr.insert(arr.begin() + 1, arr[5]);
+        arr.erase(arr.begin());
+        bool ok = (arr.size() == 17) && (arr[0] == arr[5]) && (arr[16] == arr[3]);
+        for (int idx = 1; idx < 16; ++idx)
+            ok &= arr[idx].size == 8;
+        TEST_ASSERT(ok);
+    }
+
+    testcase("copy") {
+        sq::BitSetPairArray arr;
+        for (int idx = 0; idx < 20; ++idx)
+            arr.emplaceBack(sq::BitSet(4), sq::BitSet(5));
+        sq::BitSetPairArray copied;
+        copied = arr;
+        TEST_ASSERT(copied.size() == 20);
+        TEST_ASSERT(copied[0].first.data != arr[0].first.data);
+        const sq::BitSetPairArray &self = copied;
+        copied = self;
+        TEST_ASSERT(copied.size() == 20);
+        TEST_ASSERT((copied[19].first.size == 4) && (copied[19].second.size == 5));
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+
+
+class ArrayTest : public MinimalTestSuite {
+public:
+    ArrayTest(void);
+    ~ArrayTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+};
@@ -0,0 +1,225 @@
+#include "CPUBipartiteGraphAnnealerTest.h"
+#include <cpu/CPUBipartiteGraphAnnealer.h>
+#include <cpu/CPUMetropolisSweep.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "utils.h"
+
+namespace sqcpu = sqaod_cpu;
+
+
+CPUBipartiteGraphAnnealerTest::CPUBipartiteGraphAnnealerTest(void)
+        : MinimalTestSuite("CPUBipartiteGraphAnnealerTest") {
+}
+
+
+CPUBipartiteGraphAnnealerTest::~CPUBipartiteGraphAnnealerTest(void) {
+}
+
+
+void CPUBipartiteGraphAnnealerTest::setUp() {
+}
+
+void CPUBipartiteGraphAnnealerTest::tearDown() {
+}
+    
+void CPUBipartiteGraphAnnealerTest::run(std::ostream &ostm) {
+    tests<float>();
+    tests<double>();
+}
+
+
+/* range of x and relative errors stated for the vector exp() */
+template<class real> static real expLowerBound();
+template<> float expLowerBound<float>() { return -87.f; }
+template<> double expLowerBound<double>() { return -708.; }
+template<class real> static real expTolerance();
+template<> float expTolerance<float>() { return std::ldexp(1.f, -22); }
+template<> double expTolerance<double>() { return std::ldexp(1., -50); }
+
+/* counts flips in rows of q, and records if rows are updated by rank-k updates and by GEMVs,
+ * which are chosen by the ratio of flips, 1 / 8. */
+template<class real>
+static void countFlips(const sq::MatrixType<real> &qPrev, const sq::MatrixType<real> &q,
+                       bool *rankUpdated, bool *recalculated) {
+    for (sq::IdxType im = 0; im < q.rows; ++im) {
+        int nFlipped = 0;
+        for (sq::IdxType iq = 0; iq < q.cols; ++iq)
+            nFlipped += (qPrev(im, iq) != q(im, iq)) ? 1 : 0;
+        if (q.cols < nFlipped * 8)
+            *recalculated = true;
+        else if (0 < nFlipped)
+            *rankUpdated = true;
+    }
+}
+
+/* dEmat0 = q1 J and dEmat1 = q0 J^T, compared with GEMMs. */
+template<class real>
+static bool dEmatSynced(const sqcpu::CPUBipartiteGraphAnnealer<real> &an,
+                        const sq::MatrixType<real> &J,
+                        const sq::MatrixType<real> &q0, const sq::MatrixType<real> &q1) {
+    sq::MatrixType<real> dEmat0, dEmat1;
+    an.getDEmat(&dEmat0, &dEmat1);
+    sq::EigenMatrixType<real> expected0 = mapTo(q1) * mapTo(J);
+    sq::EigenMatrixType<real> expected1 = mapTo(q0) * mapTo(J).transpose();
+    real tol0 = real(100.) * epusiron<real>() * (real(1.) + expected0.cwiseAbs().maxCoeff());
+    real tol1 = real(100.) * epusiron<real>() * (real(1.) + expected1.cwiseAbs().maxCoeff());
+    return ((mapTo(dEmat0) - expected0).cwiseAbs().maxCoeff() <= tol0) &&
+            ((mapTo(dEmat1) - expected1).cwiseAbs().maxCoeff() <= tol1);
+}
+
+template<class real>
+static void getQ(const sqcpu::CPUBipartiteGraphAnnealer<real> &an,
+                 sq::MatrixType<real> *q0, sq::MatrixType<real> *q1) {
+    sq::BitMatrix bq0, bq1;
+    an.get_q(&bq0, &bq1);
+    *q0 = sq::cast<real>(bq0);
+    *q1 = sq::cast<real>(bq1);
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealerTest::tests() {
+
+    const sq::SizeType N0 = 40, N1 = 48;
+    const sq::SizeType m = 9; /* odd, to test a wrapped coloring. */
+
+    /* dEmat is updated from flips in a step, by rank-k updates for a few flips, and by
+     * GEMVs for many flips.  Both are tested before dEmat is resynced in 64 steps. */
+    testcase("dEmat follows flips") {
+        sq::VectorType<real> b0(N0), b1(N1);
+        sq::MatrixType<real> W(N1, N0);
+        sq::Random random;
+        random.seed(5);
+        for (sq::IdxType idx = 0; idx < N0; ++idx)
+            b0(idx) = random.random<real>() - real(0.5);
+        for (sq::IdxType idx = 0; idx < N1; ++idx)
+            b1(idx) = random.random<real>() - real(0.5);
+        for (sq::IdxType idx = 0; idx < N0 * N1; ++idx)
+            W.data[idx] = random.random<real>() - real(0.5);
+
+        sqcpu::CPUBipartiteGraphAnnealer<real> an;
+        an.setQUBO(b0, b1, W);
+        an.setPreference(sq::Preference(sq::pnNumTrotters, m));
+        an.selectAlgorithm(sq::algoColoring);
+        an.seed(0);
+        an.prepare();
+        an.randomizeSpin();
+        sq::VectorType<real> h0(N0), h1(N1);
+        sq::MatrixType<real> J(N1, N0);
+        real c;
+        an.getHamiltonian(&h0, &h1, &J, &c);
+
+        bool ok = true, rankUpdated = false, recalculated = false;
+        sq::MatrixType<real> q0, q1, q0prev, q1prev;
+        getQ(an, &q0, &q1);
+        /* hot steps flip many spins, and cold steps flip a few. */
+        const real betas[] = { real(0.05), real(20.) };
+        for (int iBeta = 0; iBeta < 2; ++iBeta) {
+            for (int idx = 0; idx < 30; ++idx) {
+                q0prev = q0;
+                q1prev = q1;
+                an.annealOneStep(real(0.5), betas[iBeta]);
+                getQ(an, &q0, &q1);
+                countFlips(q0prev, q0, &rankUpdated, &recalculated);
+                countFlips(q1prev, q1, &rankUpdated, &recalculated);
+                ok &= dEmatSynced(an, J, q0, q1);
+            }
+        }
+        TEST_ASSERT(ok);
+        TEST_ASSERT(rankUpdated && recalculated);
+    }
+
+    /* integer weights, acceptance methods give the same energies as the SIMD kernels. */
+    testcase("acceptance methods in coloring") {
+        const sq::AcceptanceMethod methods[] =
+                { sq::acceptDefault, sq::acceptLogUniform, sq::acceptTable, sq::acceptFastExp };
+        sq::VectorType<real> b0 = testVecBalanced<real>(N0), b1 = testVecBalanced<real>(N1);
+        sq::MatrixType<real> W = testMatBalanced<real>(sq::Dim(N1, N0));
+        real Emin[4];
+        bool found = true;
+        for (int idx = 0; idx < 4; ++idx) {
+            sqcpu::CPUBipartiteGraphAnnealer<real> an;
+            an.setQUBO(b0, b1, W);
+            an.setPreference(sq::Preference(sq::pnNumTrotters, m));
+            an.setPreference(sq::Preference(sq::pnAcceptance, methods[idx]));
+            an.selectAlgorithm(sq::algoColoring);
+            an.seed(0);
+            an.prepare();
+            an.randomizeSpin();
+            real G = real(5.);
+            for (int step = 0; step < 50; ++step) {
+                an.annealOneStep(G, real(1. / 0.02));
+                G *= real(0.9);
+            }
+            an.makeSolution();
+            Emin[idx] = sq::mapToRowVector(an.get_E()).minCoeff();
+            sq::Preferences prefs = an.getPreferences();
+            for (sq::IdxType ip = 0; ip < (sq::IdxType)prefs.size(); ++ip) {
+                if (prefs[ip].name == sq::pnAcceptance)
+                    found &= prefs[ip].acceptance == methods[idx];
+            }
+        }
+        TEST_ASSERT(found);
+        TEST_ASSERT((Emin[0] == Emin[1]) && (Emin[0] == Emin[2]) && (Emin[0] == Emin[3]));
+    }
+
+    const sqcpu::MetropolisSweepISA isas[] =
+            { sqcpu::msisaScalar, sqcpu::msisaAVX2, sqcpu::msisaAVX512 };
+
+    /* every kernel supported by the host gives the same decisions as the scalar kernel. */
+    testcase("metropolis sweep kernels") {
+        const sq::SizeType N = 1003; /* not a multiple of vector widths, to run tails */
+        const real twoDivM = real(2.) / real(8.), coef = real(0.7), beta = real(5.);
+        std::vector<real> q(N), qNeibour0(N), qNeibour1(N), h(N), dEmat(N), rand(N);
+        sq::Random random;
+        random.seed(3);
+        for (int idx = 0; idx < N; ++idx) {
+            q[idx] = real(2 * (int)random.randInt(2) - 1);
+            qNeibour0[idx] = real(2 * (int)random.randInt(2) - 1);
+            qNeibour1[idx] = real(2 * (int)random.randInt(2) - 1);
+            h[idx] = real(4.) * random.random<real>() - real(2.);
+            dEmat[idx] = real(4.) * random.random<real>() - real(2.);
+            rand[idx] = random.random<real>();
+            /* uniforms close to thresholds are moved away, as decisions there depend on
+             * rounding errors of dE and exp(). */
+            real qi = q[idx];
+            real dE = twoDivM * qi * (h[idx] + dEmat[idx]) - qi * (qNeibour0[idx] + qNeibour1[idx]) * coef;
+            double thresh = std::exp(- std::max(double(dE), 0.) * double(beta));
+            if (std::fabs(rand[idx] - thresh) < 1.e-3 * thresh)
+                rand[idx] = real(thresh * ((rand[idx] < thresh) ? 0.9 : 1.1));
+        }
+        std::vector<real> qScalar(q);
+        sqcpu::metropolisSweep(sqcpu::msisaScalar, &qScalar[0], &qNeibour0[0], &qNeibour1[0],
+                               &h[0], &dEmat[0], &rand[0], N, twoDivM, coef, beta);
+        bool ok = qScalar != q;
+        for (int iIsa = 1; iIsa < 3; ++iIsa) {
+            if (!sqcpu::metropolisSweepSupports(isas[iIsa]))
+                continue;
+            std::vector<real> qVec(q);
+            sqcpu::metropolisSweep(isas[iIsa], &qVec[0], &qNeibour0[0], &qNeibour1[0],
+                                   &h[0], &dEmat[0], &rand[0], N, twoDivM, coef, beta);
+            ok &= qVec == qScalar;
+        }
+        TEST_ASSERT(ok);
+    }
+
+    testcase("metropolis sweep exp") {
+        /* -dE * beta in the range where exp() does not make denormals. */
+        const sq::SizeType N = 100003;
+        std::vector<real> x(N), y(N);
+        for (int idx = 0; idx < N; ++idx)
+            x[idx] = expLowerBound<real>() * real(idx) / real(N - 1);
+        bool ok = true;
+        for (int iIsa = 0; iIsa < 3; ++iIsa) {
+            if (!sqcpu::metropolisSweepSupports(isas[iIsa]))
+                continue;
+            sqcpu::metropolisSweepExp(isas[iIsa], &y[0], &x[0], N);
+            for (int idx = 0; idx < N; ++idx) {
+                double expected = std::exp(double(x[idx]));
+                ok &= std::fabs(y[idx] - expected) <= expTolerance<real>() * expected;
+            }
+        }
+        TEST_ASSERT(ok);
+    }
+}
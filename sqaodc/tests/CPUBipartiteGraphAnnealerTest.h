@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+#include <sqaodc/sqaodc.h>
+
+
+class CPUBipartiteGraphAnnealerTest : public MinimalTestSuite {
+public:
+    CPUBipartiteGraphAnnealerTest(void);
+    ~CPUBipartiteGraphAnnealerTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+private:
+    template<class real>
+    void tests();
+};
@@ -0,0 +1,160 @@
+#include "CPUBipartiteGraphBFSearcherTest.h"
+#include <cpu/CPUBipartiteGraphBFSearcher.h>
+#include <cpu/CPUFormulas.h>
+#include "utils.h"
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+
+namespace sqcpu = sqaod_cpu;
+
+
+CPUBipartiteGraphBFSearcherTest::CPUBipartiteGraphBFSearcherTest(void)
+        : MinimalTestSuite("CPUBipartiteGraphBFSearcherTest") {
+}
+
+
+CPUBipartiteGraphBFSearcherTest::~CPUBipartiteGraphBFSearcherTest(void) {
+}
+
+
+void CPUBipartiteGraphBFSearcherTest::setUp() {
+}
+
+void CPUBipartiteGraphBFSearcherTest::tearDown() {
+}
+    
+void CPUBipartiteGraphBFSearcherTest::run(std::ostream &ostm) {
+    tests<float>();
+    tests<double>();
+}
+
+
+template<class real>
+static void search(sqcpu::CPUBipartiteGraphBFSearcher<real> &searcher,
+                   const sq::VectorType<real> &b0, const sq::VectorType<real> &b1,
+                   const sq::MatrixType<real> &W, sq::OptimizeMethod om,
+                   sq::Algorithm algo, sq::SizeType tileSize0, sq::SizeType tileSize1) {
+    searcher.setQUBO(b0, b1, W, om);
+    searcher.setPreference(sq::Preference(sq::pnAlgorithm, algo));
+    searcher.setPreference(sq::Preference(sq::pnTileSize0, tileSize0));
+    searcher.setPreference(sq::Preference(sq::pnTileSize1, tileSize1));
+    searcher.search();
+}
+
+template<class real>
+void CPUBipartiteGraphBFSearcherTest::tests() {
+
+    const sq::SizeType N0 = 10, N1 = 9;
+    sq::VectorType<real> b0 = testVec<real>(N0);
+    sq::VectorType<real> b1 = testVec<real>(N1);
+    sq::MatrixType<real> W = testMat<real>(sq::Dim(N1, N0));
+
+    /* tile sizes are not powers of 2, so x1 tiles start in the middle of gray code sequences. */
+    testcase("gray code search") {
+        sq::MatrixType<real> Wb = testMatBalanced<real>(sq::Dim(N1, N0));
+        sq::OptimizeMethod oms[] = { sq::optMinimize, sq::optMaximize };
+        bool ok = true;
+        for (int idx = 0; idx < 2; ++idx) {
+            sqcpu::CPUBipartiteGraphBFSearcher<real> bf, gc;
+            search(bf, b0, b1, Wb, oms[idx], sq::algoBruteForceSearch, 61, 37);
+            search(gc, b0, b1, Wb, oms[idx], sq::algoGrayCode, 61, 37);
+            ok &= gc.getAlgorithm() == sq::algoGrayCode;
+            ok &= bf.get_E()(0) == gc.get_E()(0);
+            ok &= bf.get_x() == gc.get_x();
+        }
+        TEST_ASSERT(ok);
+    }
+
+    /* b0 is not integer-valued, and energies are evaluated by real. */
+    testcase("real-valued problem") {
+        sq::MatrixType<real> Wb = testMatBalanced<real>(sq::Dim(N1, N0));
+        sq::VectorType<real> b0r = b0;
+        b0r(3) += real(0.5);
+        sqcpu::CPUBipartiteGraphBFSearcher<real> bf, gc;
+        search(bf, b0r, b1, Wb, sq::optMinimize, sq::algoBruteForceSearch, 61, 37);
+        search(gc, b0r, b1, Wb, sq::optMinimize, sq::algoGrayCode, 61, 37);
+        TEST_ASSERT(bf.get_E()(0) == gc.get_E()(0));
+        TEST_ASSERT(bf.get_x() == gc.get_x());
+    }
+
+    testcase("integer weights") {
+        sq::MatrixType<real> Wb = testMatBalanced<real>(sq::Dim(N1, N0));
+        sq::VectorType<short> b0s = sq::cast<short>(b0), b1s = sq::cast<short>(b1);
+        sq::MatrixType<short> Ws = sq::cast<short>(Wb);
+        sq::BitMatrix x0(4, N0), x1(4, N1);
+        for (sq::IdxType idx = 0; idx < 4 * N0; ++idx)
+            x0.data[idx] = (idx * 7) % 5 < 2;
+        for (sq::IdxType idx = 0; idx < 4 * N1; ++idx)
+            x1.data[idx] = (idx * 3) % 4 < 2;
+        sq::VectorType<real> E, Es;
+        sqcpu::BGFuncs<real>::calculate_E(&E, b0, b1, Wb,
+                                          sq::cast<real>(x0), sq::cast<real>(x1));
+        sqcpu::BGFuncs<real>::calculate_E(&Es, b0s, b1s, Ws, x0, x1);
+        TEST_ASSERT(E == Es);
+
+        sqcpu::CPUBipartiteGraphBFSearcher<real> sr, ss;
+        search(sr, b0, b1, Wb, sq::optMaximize, sq::algoGrayCode, 61, 37);
+        ss.setQUBO(b0s, b1s, Ws, sq::optMaximize);
+        ss.search();
+        TEST_ASSERT(sr.get_E()(0) == ss.get_E()(0));
+        TEST_ASSERT(sr.get_x() == ss.get_x());
+    }
+
+    testcase("top-k collection, maximize") {
+        const int K = 50;
+        sq::MatrixType<real> Wb = testMatBalanced<real>(sq::Dim(N1, N0));
+        sq::MatrixType<real> bits0(1 << N0, N0), bits1(1 << N1, N1), E;
+        sq::createBitSetSequence(bits0.data, N0, 0, 1 << N0);
+        sq::createBitSetSequence(bits1.data, N1, 0, 1 << N1);
+        sqcpu::BGFuncs<real>::calculate_E_2d(&E, b0, b1, Wb, bits0, bits1);
+        /* (-E, x0, x1), ascending */
+        typedef std::pair<real, std::pair<int, int> > State;
+        std::vector<State> sorted;
+        for (int x1 = 0; x1 < (1 << N1); ++x1) {
+            for (int x0 = 0; x0 < (1 << N0); ++x0)
+                sorted.push_back(State(- E(x1, x0), std::make_pair(x0, x1)));
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        sqcpu::CPUBipartiteGraphBFSearcher<real> searcher;
+        searcher.setPreference(sq::Preference(sq::pnTopK, K));
+        search(searcher, b0, b1, Wb, sq::optMaximize, sq::algoGrayCode, 61, 37);
+        const sq::BitSetPairArray &xPairList = searcher.get_x();
+        const sq::VectorType<real> &Eres = searcher.get_E();
+        bool ok = (xPairList.size() == K) && (Eres.size == K);
+        for (int idx = 0; ok && (idx < K); ++idx) {
+            sq::BitSet x0, x1;
+            sq::unpackBitSet(&x0, sorted[idx].second.first, N0);
+            sq::unpackBitSet(&x1, sorted[idx].second.second, N1);
+            ok &= (xPairList[idx].first == x0) && (xPairList[idx].second == x1);
+            ok &= Eres(idx) == - sorted[idx].first;
+        }
+        TEST_ASSERT(ok);
+    }
+
+    testcase("checkpoint and resume") {
+        const char *filename = "CPUBipartiteGraphBFSearcherTest.ckpt";
+        sqcpu::CPUBipartiteGraphBFSearcher<real> bf, interrupted, resumed;
+        bf.setPreference(sq::Preference(sq::pnTileSize0, 61));
+        bf.setPreference(sq::Preference(sq::pnTileSize1, 37));
+        bf.setQUBO(b0, b1, W);
+        bf.search();
+
+        interrupted.setPreference(sq::Preference(sq::pnTileSize0, 61));
+        interrupted.setPreference(sq::Preference(sq::pnTileSize1, 37));
+        interrupted.setQUBO(b0, b1, W);
+        interrupted.prepare();
+        for (int idx = 0; idx < 20; ++idx)
+            interrupted.searchRange(NULL, NULL);
+        interrupted.saveCheckpoint(filename);
+
+        resumed.setQUBO(b0, b1, W);
+        resumed.resumeFromCheckpoint(filename);
+        while (!resumed.searchRange(NULL, NULL));
+        resumed.makeSolution();
+        TEST_ASSERT(bf.get_E()(0) == resumed.get_E()(0));
+        TEST_ASSERT(bf.get_x() == resumed.get_x());
+        remove(filename);
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+#include <sqaodc/sqaodc.h>
+
+
+class CPUBipartiteGraphBFSearcherTest : public MinimalTestSuite {
+public:
+    CPUBipartiteGraphBFSearcherTest(void);
+    ~CPUBipartiteGraphBFSearcherTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+private:
+    template<class real>
+    void tests();
+};
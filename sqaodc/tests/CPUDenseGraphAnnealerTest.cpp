@@ -0,0 +1,243 @@
+#include "CPUDenseGraphAnnealerTest.h"
+#include <cpu/CPUDenseGraphAnnealer.h>
+#include "utils.h"
+#include <vector>
+
+namespace sqcpu = sqaod_cpu;
+
+
+CPUDenseGraphAnnealerTest::CPUDenseGraphAnnealerTest(void)
+        : MinimalTestSuite("CPUDenseGraphAnnealerTest") {
+}
+
+
+CPUDenseGraphAnnealerTest::~CPUDenseGraphAnnealerTest(void) {
+}
+
+
+void CPUDenseGraphAnnealerTest::setUp() {
+}
+
+void CPUDenseGraphAnnealerTest::tearDown() {
+}
+    
+void CPUDenseGraphAnnealerTest::run(std::ostream &ostm) {
+    tests<float>();
+    tests<double>();
+}
+
+
+template<class real>
+static void anneal(sqcpu::CPUDenseGraphAnnealer<real> &an, const sq::MatrixType<real> &W,
+                   sq::Algorithm algo, sq::SizeType m) {
+    an.setQUBO(W);
+    an.setPreference(sq::Preference(sq::pnNumTrotters, m));
+    an.selectAlgorithm(algo);
+    an.seed(0);
+    an.prepare();
+    an.randomizeSpin();
+    real G = real(5.), beta = real(1. / 0.02);
+    for (int idx = 0; idx < 50; ++idx) {
+        an.annealOneStep(G, beta);
+        G *= real(0.9);
+    }
+    an.makeSolution();
+}
+
+/* records steps, and stops annealing at the 2nd call. */
+template<class real>
+static bool stopAtSecondCall(void *userData, sq::IdxType step, real G, real beta) {
+    std::vector<sq::IdxType> *steps = (std::vector<sq::IdxType>*)userData;
+    steps->push_back(step);
+    return steps->size() < 2;
+}
+
+template<class real>
+void CPUDenseGraphAnnealerTest::tests() {
+
+    const sq::SizeType N = 40;
+    const sq::SizeType m = 21; /* odd, to test a wrapped coloring. */
+    /* integer weights to get identical energies from both algorithms. */
+    sq::MatrixType<real> W = testMatSymmetric<real>(N);
+
+    testcase("algoLocalField selection") {
+        sqcpu::CPUDenseGraphAnnealer<real> an;
+        TEST_ASSERT(an.selectAlgorithm(sq::algoLocalField) == sq::algoLocalField);
+        TEST_ASSERT(an.getAlgorithm() == sq::algoLocalField);
+    }
+
+    testcase("algoLocalField gives the same q as algoColoring") {
+        sqcpu::CPUDenseGraphAnnealer<real> an0, an1;
+        anneal(an0, W, sq::algoColoring, m);
+        anneal(an1, W, sq::algoLocalField, m);
+        const sq::BitSetArray &q0 = an0.get_q(), &q1 = an1.get_q();
+        bool ok = q0.size() == q1.size();
+        for (sq::IdxType idx = 0; ok && (idx < (sq::IdxType)q0.size()); ++idx)
+            ok &= q0[idx] == q1[idx];
+        TEST_ASSERT(ok);
+        TEST_ASSERT(an0.get_E() == an1.get_E());
+    }
+
+    testcase("anneal with a schedule gives the same q as annealOneStep") {
+        sqcpu::CPUDenseGraphAnnealer<real> an0, an1;
+        anneal(an0, W, sq::algoColoring, m);
+        sq::AnnealSchedule<real> schedule = sq::AnnealSchedule<real>::geometric(
+                real(5.), real(0.027), real(0.9), real(1. / 0.02));
+        TEST_ASSERT(schedule.size() == 50);
+        an1.setQUBO(W);
+        an1.setPreference(sq::Preference(sq::pnNumTrotters, m));
+        an1.selectAlgorithm(sq::algoColoring);
+        an1.seed(0);
+        an1.prepare();
+        an1.randomizeSpin();
+        an1.anneal(schedule);
+        an1.makeSolution();
+        const sq::BitSetArray &q0 = an0.get_q(), &q1 = an1.get_q();
+        bool ok = q0.size() == q1.size();
+        for (sq::IdxType idx = 0; ok && (idx < (sq::IdxType)q0.size()); ++idx)
+            ok &= q0[idx] == q1[idx];
+        TEST_ASSERT(ok);
+    }
+
+    testcase("x and q in matrices") {
+        sqcpu::CPUDenseGraphAnnealer<real> an;
+        anneal(an, W, sq::algoColoring, m);
+        sq::BitMatrix x, q(m, N);
+        an.get_x(&x);
+        an.get_q(&q);
+        const sq::BitSetArray &xList = an.get_x(), &qList = an.get_q();
+        bool ok = (x.rows == m) && (x.cols == N);
+        for (sq::IdxType idx = 0; ok && (idx < m); ++idx) {
+            ok &= sq::BitSet(&x(idx, 0), N) == xList[idx];
+            ok &= sq::BitSet(&q(idx, 0), N) == qList[idx];
+        }
+        TEST_ASSERT(ok);
+    }
+
+    testcase("anneal callback") {
+        sq::AnnealSchedule<real> schedule =
+                sq::AnnealSchedule<real>::linear(real(5.), real(0.), 20, real(10.));
+        TEST_ASSERT((schedule.size() == 20) && (schedule.G(19) == real(0.)));
+        sqcpu::CPUDenseGraphAnnealer<real> an;
+        an.setQUBO(W);
+        an.seed(0);
+        an.prepare();
+        an.randomizeSpin();
+        std::vector<sq::IdxType> steps;
+        an.anneal(schedule, stopAtSecondCall<real>, &steps, 5);
+        TEST_ASSERT((steps.size() == 2) && (steps[0] == 4) && (steps[1] == 9));
+    }
+
+    testcase("algoMultiSpinCoding gives the same q as algoColoring") {
+        sqcpu::CPUDenseGraphAnnealer<real> an0, an1;
+        anneal(an0, W, sq::algoColoring, m);
+        anneal(an1, W, sq::algoMultiSpinCoding, m);
+        TEST_ASSERT(an1.getAlgorithm() == sq::algoMultiSpinCoding);
+        const sq::BitSetArray &q0 = an0.get_q(), &q1 = an1.get_q();
+        bool ok = q0.size() == q1.size();
+        for (sq::IdxType idx = 0; ok && (idx < (sq::IdxType)q0.size()); ++idx)
+            ok &= q0[idx] == q1[idx];
+        TEST_ASSERT(ok);
+        TEST_ASSERT(an0.get_E() == an1.get_E());
+    }
+
+    testcase("algoMultiSpinCoding with N > 64") {
+        sq::MatrixType<real> W = testMatSymmetric<real>(130);
+        sqcpu::CPUDenseGraphAnnealer<real> an0, an1;
+        anneal(an0, W, sq::algoColoring, 4);
+        anneal(an1, W, sq::algoMultiSpinCoding, 4);
+        TEST_ASSERT(an0.get_E() == an1.get_E());
+    }
+
+    testcase("algoMultiSpinCoding syncs q with solutions and other algorithms") {
+        sqcpu::CPUDenseGraphAnnealer<real> an0, an1;
+        anneal(an0, W, sq::algoColoring, m);
+        an1.setQUBO(W);
+        an1.setPreference(sq::Preference(sq::pnNumTrotters, m));
+        an1.seed(0);
+        an1.prepare();
+        an1.randomizeSpin();
+        real G = real(5.), beta = real(1. / 0.02);
+        for (int idx = 0; idx < 50; ++idx) {
+            /* switches algorithms, and reads solutions in the middle of annealing. */
+            an1.selectAlgorithm(((idx / 3) % 2 == 0) ? sq::algoMultiSpinCoding : sq::algoColoring);
+            an1.annealOneStep(G, beta);
+            if ((idx % 7) == 0)
+                an1.makeSolution();
+            G *= real(0.9);
+        }
+        an1.makeSolution();
+        const sq::BitSetArray &q0 = an0.get_q(), &q1 = an1.get_q();
+        bool ok = q0.size() == q1.size();
+        for (sq::IdxType idx = 0; ok && (idx < (sq::IdxType)q0.size()); ++idx)
+            ok &= q0[idx] == q1[idx];
+        TEST_ASSERT(ok);
+        TEST_ASSERT(an0.get_E() == an1.get_E());
+    }
+
+    testcase("counter-based random does not depend on # threads") {
+        const sq::Algorithm algos[] = { sq::algoColoring, sq::algoLocalField };
+        for (int iAlgo = 0; iAlgo < 2; ++iAlgo) {
+            sqcpu::CPUDenseGraphAnnealer<real> an0, an1;
+            an0.setPreference(sq::Preference(sq::pnRandom, sq::rngCounterBased));
+            an0.setPreference(sq::Preference(sq::pnNumThreads, 1));
+            an1.setPreference(sq::Preference(sq::pnRandom, sq::rngCounterBased));
+            an1.setPreference(sq::Preference(sq::pnNumThreads, 3));
+            anneal(an0, W, algos[iAlgo], m);
+            anneal(an1, W, algos[iAlgo], m);
+            const sq::BitSetArray &q0 = an0.get_q(), &q1 = an1.get_q();
+            bool ok = q0.size() == q1.size();
+            for (sq::IdxType idx = 0; ok && (idx < (sq::IdxType)q0.size()); ++idx)
+                ok &= q0[idx] == q1[idx];
+            TEST_ASSERT(ok);
+        }
+    }
+
+    testcase("acceptance methods") {
+        const sq::AcceptanceMethod methods[] = { sq::acceptLogUniform, sq::acceptTable, sq::acceptFastExp };
+        sqcpu::CPUDenseGraphAnnealer<real> an0;
+        anneal(an0, W, sq::algoColoring, m);
+        real Emin0 = sq::mapToRowVector(an0.get_E()).minCoeff();
+        for (int idx = 0; idx < 3; ++idx) {
+            sqcpu::CPUDenseGraphAnnealer<real> an1;
+            an1.setPreference(sq::Preference(sq::pnAcceptance, methods[idx]));
+            anneal(an1, W, sq::algoColoring, m);
+            sq::Preferences prefs = an1.getPreferences();
+            bool found = false;
+            for (sq::IdxType ip = 0; ip < (sq::IdxType)prefs.size(); ++ip) {
+                if (prefs[ip].name == sq::pnAcceptance)
+                    found = prefs[ip].acceptance == methods[idx];
+            }
+            TEST_ASSERT(found);
+            real Emin1 = sq::mapToRowVector(an1.get_E()).minCoeff();
+            TEST_ASSERT(Emin0 == Emin1);
+        }
+    }
+
+    /* local fields are updated by flips, and resynced by GEMM every 64 steps. */
+    testcase("algoLocalField keeps local fields after many steps") {
+        sq::MatrixType<real> Wr = createRandomSymmetricMatrix<real>(N);
+        sqcpu::CPUDenseGraphAnnealer<real> an;
+        an.setQUBO(Wr);
+        an.setPreference(sq::Preference(sq::pnNumTrotters, m));
+        an.selectAlgorithm(sq::algoLocalField);
+        an.seed(0);
+        an.prepare();
+        an.randomizeSpin();
+        for (int idx = 0; idx < 200; ++idx)
+            an.annealOneStep(real(1.), real(1.));
+
+        sq::VectorType<real> h(N);
+        sq::MatrixType<real> J(N, N), localField;
+        real c;
+        an.getHamiltonian(&h, &J, &c);
+        an.getLocalField(&localField);
+        sq::BitMatrix bitsQ;
+        an.get_q(&bitsQ);
+        sq::MatrixType<real> q = sq::cast<real>(bitsQ);
+        sq::EigenMatrixType<real> expected = mapTo(q) * mapTo(J);
+        expected.rowwise() += mapToRowVector(h);
+        real tol = real(10.) * epusiron<real>() * (real(1.) + expected.cwiseAbs().maxCoeff());
+        TEST_ASSERT((mapTo(localField) - expected).cwiseAbs().maxCoeff() <= tol);
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+#include <sqaodc/sqaodc.h>
+
+
+class CPUDenseGraphAnnealerTest : public MinimalTestSuite {
+public:
+    CPUDenseGraphAnnealerTest(void);
+    ~CPUDenseGraphAnnealerTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+private:
+    template<class real>
+    void tests();
+};
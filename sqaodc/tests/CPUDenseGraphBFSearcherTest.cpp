@@ -0,0 +1,498 @@
+#include "CPUDenseGraphBFSearcherTest.h"
+#include <cpu/CPUDenseGraphBFSearcher.h>
+#include <cpu/CPUDenseGraphBatchSearch.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPURangeScheduler.h>
+#include <common/Checkpoint.h>
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include "utils.h"
+
+namespace sqcpu = sqaod_cpu;
+
+
+CPUDenseGraphBFSearcherTest::CPUDenseGraphBFSearcherTest(void)
+        : MinimalTestSuite("CPUDenseGraphBFSearcherTest") {
+}
+
+
+CPUDenseGraphBFSearcherTest::~CPUDenseGraphBFSearcherTest(void) {
+}
+
+
+void CPUDenseGraphBFSearcherTest::setUp() {
+}
+
+void CPUDenseGraphBFSearcherTest::tearDown() {
+}
+    
+template<class real>
+static void search(sqcpu::CPUDenseGraphBFSearcher<real> &searcher,
+                   const sq::MatrixType<real> &W, sq::OptimizeMethod om,
+                   sq::Algorithm algo, sq::SizeType tileSize) {
+    searcher.setQUBO(W, om);
+    searcher.setPreference(sq::Preference(sq::pnAlgorithm, algo));
+    searcher.setPreference(sq::Preference(sq::pnTileSize, tileSize));
+    searcher.search();
+}
+
+void CPUDenseGraphBFSearcherTest::run(std::ostream &ostm) {
+    testcase("range scheduler covers a range") {
+        /* 5 slots for 3 threads, ranges of absent threads are stolen. */
+        const sq::PackedBitSet begin = 17, end = 100017;
+        sqcpu::CPURangeScheduler scheduler;
+        scheduler.reset(begin, end, 5, 7, 1000);
+        std::vector<char> visited(end - begin, 0);
+        bool ok = true;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(3)
+        {
+            int threadNum = omp_get_thread_num();
+#else
+        {
+            int threadNum = 0;
+#endif
+            sq::PackedBitSet chunkBegin, chunkEnd;
+            while (scheduler.acquire(threadNum, &chunkBegin, &chunkEnd)) {
+                for (sq::PackedBitSet x = chunkBegin; x < chunkEnd; ++x) {
+                    if (visited[x - begin] != 0)
+                        ok = false;
+                    visited[x - begin] = 1;
+                }
+            }
+        }
+        for (size_t idx = 0; idx < visited.size(); ++idx)
+            ok &= visited[idx] == 1;
+        TEST_ASSERT(ok);
+    }
+
+    /* energies exceed 2^24, and are not exactly represented by float. */
+    testcase("integer-valued W, large energies") {
+        const sq::SizeType N = 16;
+        sq::MatrixType<float> Wf = testMatSymmetric<float>(N);
+        sq::MatrixType<double> Wd = testMatSymmetric<double>(N);
+        mapTo(Wf) *= float(1 << 22);
+        mapTo(Wd) *= double(1 << 22);
+        Wf(0, 0) += 1.f;
+        Wd(0, 0) += 1.;
+        sqcpu::CPUDenseGraphBFSearcher<float> sf;
+        sqcpu::CPUDenseGraphBFSearcher<double> sd;
+        search(sf, Wf, sq::optMinimize, sq::algoGrayCode, 1000);
+        search(sd, Wd, sq::optMinimize, sq::algoGrayCode, 1000);
+        TEST_ASSERT(sf.get_x() == sd.get_x());
+    }
+
+    /* E(0x4001) = -2^24 - 1 and E(0x8001) = -2^24 are equal in float.  The ground state is
+     * found before the checkpoint, and 0x8001 should not be taken after resume. */
+    testcase("integer-valued W, resume with large energies") {
+        const char *filename = "CPUDenseGraphBFSearcherTest.ckpt";
+        const sq::SizeType N = 16;
+        sq::MatrixType<float> W = sq::MatrixType<float>::eye(N);
+        W(N - 1, N - 1) = - float(1 << 24);
+        W(1, 1) = -1.f;
+        W(0, 0) = 0.f;
+        W(0, 1) = W(1, 0) = 1.f;
+        sqcpu::CPUDenseGraphBFSearcher<float> bf, interrupted, resumed, merger;
+        search(bf, W, sq::optMinimize, sq::algoGrayCode, 256);
+        TEST_ASSERT(bf.get_x().size() == 1);
+
+        interrupted.setQUBO(W, sq::optMinimize);
+        interrupted.setPreference(sq::Preference(sq::pnTileSize, 256));
+        interrupted.prepare();
+        interrupted.searchBudget(0x6000, NULL);
+        interrupted.saveCheckpoint(filename);
+        resumed.setQUBO(W, sq::optMinimize);
+        resumed.resumeFromCheckpoint(filename);
+        remove(filename);
+        while (!resumed.searchRange(NULL));
+        resumed.makeSolution();
+        TEST_ASSERT(bf.get_x() == resumed.get_x());
+
+        /* partial results are merged by integer energies. */
+        sq::PackedBitSet bounds[] = { 0, 0x6000, 1ull << N };
+        sq::DenseGraphBFPartialResult<float> merged;
+        for (int idx = 0; idx < 2; ++idx) {
+            sq::DenseGraphBFPartialResult<float> partial;
+            interrupted.searchPartial(bounds[idx], bounds[idx + 1], &partial);
+            partial.save(filename);
+            partial = sq::DenseGraphBFPartialResult<float>();
+            partial.load(filename);
+            remove(filename);
+            merged.merge(partial, 256);
+        }
+        merger.setQUBO(W, sq::optMinimize);
+        merger.setPartialResult(merged);
+        merger.makeSolution();
+        TEST_ASSERT(bf.get_x() == merger.get_x());
+    }
+
+    tests<float>();
+    tests<double>();
+}
+
+
+/* energies of all states in the ascending order of (E, x). */
+template<class real>
+static std::vector<std::pair<real, sq::PackedBitSet> >
+sortedEnergies(const sq::MatrixType<real> &W) {
+    sq::SizeType N = W.rows;
+    sq::PackedBitSet xMax = 1ull << N;
+    sq::MatrixType<real> bitsSeq(sq::SizeType(xMax), N);
+    sq::VectorType<real> E;
+    sq::createBitSetSequence(bitsSeq.data, N, 0, xMax);
+    sqcpu::DGFuncs<real>::calculate_E(&E, W, bitsSeq);
+    std::vector<std::pair<real, sq::PackedBitSet> > sorted;
+    for (sq::PackedBitSet x = 0; x < xMax; ++x)
+        sorted.push_back(std::make_pair(E(sq::IdxType(x)), x));
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+/* checks if collected states are the first nStates of sorted. */
+template<class real>
+static bool collected(const sqcpu::CPUDenseGraphBFSearcher<real> &searcher,
+                      const std::vector<std::pair<real, sq::PackedBitSet> > &sorted,
+                      size_t nStates) {
+    const sq::BitSetArray &xList = searcher.get_x();
+    const sq::VectorType<real> &E = searcher.get_E();
+    if ((xList.size() != (sq::SizeType)nStates) || (E.size != (sq::SizeType)nStates))
+        return false;
+    bool ok = true;
+    for (size_t idx = 0; idx < nStates; ++idx) {
+        sq::BitSet x;
+        sq::unpackBitSet(&x, sorted[idx].second, xList[idx].size);
+        ok &= (xList[idx] == x) && (E(idx) == sorted[idx].first);
+    }
+    return ok;
+}
+
+template<class real>
+void CPUDenseGraphBFSearcherTest::tests() {
+
+    const sq::SizeType N = 18;
+    sq::MatrixType<real> W = testMatSymmetric<real>(N);
+
+    testcase("algorithm selection") {
+        sqcpu::CPUDenseGraphBFSearcher<real> searcher;
+        bool ok = searcher.getAlgorithm() == sq::algoGrayCode;
+        searcher.setPreference(sq::Preference(sq::pnAlgorithm, sq::algoBruteForceSearch));
+        ok &= searcher.getAlgorithm() == sq::algoBruteForceSearch;
+        searcher.setPreference(sq::Preference(sq::pnAlgorithm, sq::algoDefault));
+        ok &= searcher.getAlgorithm() == sq::algoGrayCode;
+        TEST_ASSERT(ok);
+    }
+
+    /* tile size is not a power of 2, so batches start in the middle of gray code sequences. */
+    testcase("gray code search, minimize") {
+        sqcpu::CPUDenseGraphBFSearcher<real> bf, gc;
+        search(bf, W, sq::optMinimize, sq::algoBruteForceSearch, 1000);
+        search(gc, W, sq::optMinimize, sq::algoGrayCode, 1000);
+        TEST_ASSERT(bf.get_E()(0) == gc.get_E()(0));
+        TEST_ASSERT(bf.get_x() == gc.get_x());
+    }
+
+    testcase("gray code search, maximize") {
+        sqcpu::CPUDenseGraphBFSearcher<real> bf, gc;
+        search(bf, W, sq::optMaximize, sq::algoBruteForceSearch, 777);
+        search(gc, W, sq::optMaximize, sq::algoGrayCode, 777);
+        TEST_ASSERT(bf.get_E()(0) == gc.get_E()(0));
+        TEST_ASSERT(bf.get_x() == gc.get_x());
+    }
+
+    testcase("search budget") {
+        sqcpu::CPUDenseGraphBFSearcher<real> bf, budgeted;
+        search(bf, W, sq::optMinimize, sq::algoGrayCode, 1000);
+        budgeted.setQUBO(W);
+        budgeted.setPreference(sq::Preference(sq::pnTileSize, 1000));
+        budgeted.prepare();
+        sq::PackedBitSet curX = 0;
+        int nCalls = 0;
+        bool ok = true;
+        while (!budgeted.searchBudget(100000, &curX)) {
+            ok &= curX == sq::PackedBitSet(100000) * ++nCalls;
+        }
+        budgeted.makeSolution();
+        TEST_ASSERT(ok && (nCalls == 2) && (curX == (1ull << N)));
+        TEST_ASSERT(bf.get_x() == budgeted.get_x());
+    }
+
+    testcase("top-k collection") {
+        std::vector<std::pair<real, sq::PackedBitSet> > sorted = sortedEnergies(W);
+        sqcpu::CPUDenseGraphBFSearcher<real> searcher;
+        searcher.setPreference(sq::Preference(sq::pnTopK, 100));
+        search(searcher, W, sq::optMinimize, sq::algoGrayCode, 1000);
+        TEST_ASSERT(collected(searcher, sorted, 100));
+    }
+
+    testcase("energy window collection") {
+        std::vector<std::pair<real, sq::PackedBitSet> > sorted = sortedEnergies(W);
+        real Emax = sorted[0].first + real(4.);
+        size_t nStates = 0;
+        while (sorted[nStates].first <= Emax)
+            ++nStates;
+        sqcpu::CPUDenseGraphBFSearcher<real> searcher, limited;
+        searcher.setPreference(sq::Preference(sq::pnEnergyWindow, 4.));
+        search(searcher, W, sq::optMinimize, sq::algoBruteForceSearch, 777);
+        bool ok = collected(searcher, sorted, nStates);
+        /* top-K and energy window together */
+        limited.setPreference(sq::Preference(sq::pnEnergyWindow, 4.));
+        limited.setPreference(sq::Preference(sq::pnTopK, 5));
+        search(limited, W, sq::optMinimize, sq::algoGrayCode, 777);
+        ok &= collected(limited, sorted, std::min(nStates, size_t(5)));
+        TEST_ASSERT(ok);
+    }
+
+    /* all states are degenerate, and collected states are capped by the tile size. */
+    testcase("energy window collection, capped") {
+        sq::MatrixType<real> W0(N, N);
+        W0 = real(0.);
+        std::vector<std::pair<real, sq::PackedBitSet> > sorted = sortedEnergies(W0);
+        sqcpu::CPUDenseGraphBFSearcher<real> searcher;
+        searcher.setPreference(sq::Preference(sq::pnEnergyWindow, 1.));
+        search(searcher, W0, sq::optMinimize, sq::algoGrayCode, 100);
+        TEST_ASSERT(collected(searcher, sorted, 100));
+    }
+
+    testcase("checkpoint and resume") {
+        const char *filename = "CPUDenseGraphBFSearcherTest.ckpt";
+        sq::Algorithm algos[] = { sq::algoGrayCode, sq::algoBranchAndBound };
+        bool ok = true;
+        for (int iAlgo = 0; iAlgo < 2; ++iAlgo) {
+            sqcpu::CPUDenseGraphBFSearcher<real> bf, interrupted, resumed;
+            search(bf, W, sq::optMaximize, algos[iAlgo], 1000);
+            interrupted.setQUBO(W, sq::optMaximize);
+            interrupted.setPreference(sq::Preference(sq::pnAlgorithm, algos[iAlgo]));
+            interrupted.prepare();
+            for (int idx = 0; idx < 3; ++idx)
+                interrupted.searchRange(NULL);
+            interrupted.saveCheckpoint(filename);
+
+            resumed.setQUBO(W, sq::optMaximize);
+            resumed.resumeFromCheckpoint(filename);
+            ok &= resumed.getAlgorithm() == algos[iAlgo];
+            while (!resumed.searchRange(NULL));
+            resumed.makeSolution();
+            ok &= bf.get_E()(0) == resumed.get_E()(0);
+            ok &= bf.get_x() == resumed.get_x();
+        }
+        TEST_ASSERT(ok);
+
+        /* problem mismatch */
+        sqcpu::CPUDenseGraphBFSearcher<real> other;
+        other.setQUBO(W, sq::optMinimize);
+        bool thrown = false;
+        try {
+            other.resumeFromCheckpoint(filename);
+        }
+        catch (...) {
+            thrown = true;
+        }
+        TEST_ASSERT(thrown);
+        remove(filename);
+    }
+
+    /* the number of elements is read before the hash is verified. */
+    testcase("broken array size in checkpoint") {
+        const char *filename = "CPUDenseGraphBFSearcherTest.broken";
+        sq::CheckpointWriter writer(filename, sq::ckDenseGraphBFPartialResult);
+        writer.write(0x7fffffffull);
+        writer.write(sq::PackedBitSet(0));
+        writer.commit();
+        sq::PackedBitSetArray arr;
+        bool thrown = false;
+        try {
+            sq::CheckpointReader reader(filename, sq::ckDenseGraphBFPartialResult);
+            reader.readArray(&arr);
+        }
+        catch (...) {
+            thrown = true;
+        }
+        TEST_ASSERT(thrown && arr.empty());
+        remove(filename);
+    }
+
+    /* W is not integer-valued, and energies are evaluated by real. */
+    testcase("real-valued W") {
+        sq::MatrixType<real> Wr = W;
+        mapTo(Wr) *= real(0.5);
+        Wr(1, 2) = Wr(2, 1) = real(0.25);
+        sqcpu::CPUDenseGraphBFSearcher<real> bf, gc;
+        search(bf, Wr, sq::optMinimize, sq::algoBruteForceSearch, 1000);
+        search(gc, Wr, sq::optMinimize, sq::algoGrayCode, 1000);
+        TEST_ASSERT(bf.get_E()(0) == gc.get_E()(0));
+        TEST_ASSERT(bf.get_x() == gc.get_x());
+    }
+
+    testcase("integer weights") {
+        sq::MatrixType<short> Ws = sq::cast<short>(W);
+        sq::MatrixType<int> Wi = sq::cast<int>(W);
+        sq::BitMatrix x(5, N);
+        for (sq::IdxType idx = 0; idx < 5 * N; ++idx)
+            x.data[idx] = (idx * 7) % 5 < 2;
+        sq::VectorType<real> E, Es, Ei;
+        sqcpu::DGFuncs<real>::calculate_E(&E, W, sq::cast<real>(x));
+        sqcpu::DGFuncs<real>::calculate_E(&Es, Ws, x);
+        sqcpu::DGFuncs<real>::calculate_E(&Ei, Wi, x);
+        TEST_ASSERT(E == Es);
+        TEST_ASSERT(E == Ei);
+
+        sqcpu::CPUDenseGraphBFSearcher<real> sr, ss;
+        search(sr, W, sq::optMinimize, sq::algoGrayCode, 1000);
+        ss.setQUBO(Ws, sq::optMinimize);
+        ss.search();
+        TEST_ASSERT(sr.get_E()(0) == ss.get_E()(0));
+        TEST_ASSERT(sr.get_x() == ss.get_x());
+    }
+
+    /* temporaries of searches are drawn from the arena, which stops growing after the first call. */
+    testcase("scratch arena") {
+        sq::MatrixType<real> Wr = W;
+        mapTo(Wr) *= real(0.5);
+        Wr(1, 2) = Wr(2, 1) = real(0.25);
+        sqcpu::CPUDenseGraphBatchSearch<real> batch;
+        batch.setQUBO(Wr, 16);
+        batch.initSearch();
+        const sq::PackedBitSet batchSize = 1024;
+        batch.searchRange(0, batchSize);
+        size_t capacity = batch.arena_.capacity();
+        for (sq::PackedBitSet x = batchSize; x < (sq::PackedBitSet(1) << N); x += batchSize)
+            batch.searchRange(x, x + batchSize);
+        TEST_ASSERT(batch.arena_.capacity() == capacity);
+
+        sqcpu::CPUDenseGraphBFSearcher<real> bf;
+        search(bf, Wr, sq::optMinimize, sq::algoBruteForceSearch, 1000);
+        real E = bf.get_E()(0);
+        TEST_ASSERT(std::fabs(batch.Emin_ - E) <= epusiron<real>() * (real(1.) + std::fabs(E)));
+
+        /* gray code search of integer-valued W */
+        sqcpu::CPUDenseGraphBatchSearch<real> grayCode;
+        grayCode.setQUBO(W, 16);
+        grayCode.initSearch();
+        TEST_ASSERT(grayCode.intBits_ != 0);
+        grayCode.searchRangeGrayCode(0, batchSize);
+        capacity = grayCode.arena_.capacity();
+        for (sq::PackedBitSet i = batchSize; i < (sq::PackedBitSet(1) << N); i += batchSize)
+            grayCode.searchRangeGrayCode(i, i + batchSize);
+        TEST_ASSERT(grayCode.arena_.capacity() == capacity);
+        sqcpu::CPUDenseGraphBFSearcher<real> bfInt;
+        search(bfInt, W, sq::optMinimize, sq::algoBruteForceSearch, 1000);
+        TEST_ASSERT(real(grayCode.EminInt_) == bfInt.get_E()(0));
+
+        sqcpu::CPUScratchArena arena;
+        real *small = arena.allocate<real>(3);
+        arena.allocate<char>(3 * capacity);
+        TEST_ASSERT(((size_t)small % sq::cacheLineSize) == 0);
+        arena.reset();
+        capacity = arena.capacity();
+        arena.allocate<real>(3);
+        arena.allocate<char>(3 * capacity / 4);
+        TEST_ASSERT(arena.capacity() == capacity);
+    }
+
+    testcase("partial search") {
+        const char *filename = "CPUDenseGraphBFSearcherTest.partial";
+        sqcpu::CPUDenseGraphBFSearcher<real> bf, shard, merger;
+        search(bf, W, sq::optMaximize, sq::algoGrayCode, 1000);
+
+        /* shards searched by separate searchers, one of them is passed through a file. */
+        sq::PackedBitSet bounds[] = { 0, 77777, 200000, 1ull << N };
+        sq::DenseGraphBFPartialResult<real> merged;
+        shard.setQUBO(W, sq::optMaximize);
+        for (int idx = 2; 0 <= idx; --idx) {
+            sq::DenseGraphBFPartialResult<real> partial;
+            shard.searchPartial(bounds[idx], bounds[idx + 1], &partial);
+            if (idx == 1) {
+                partial.save(filename);
+                partial = sq::DenseGraphBFPartialResult<real>();
+                partial.load(filename);
+                remove(filename);
+            }
+            merged.merge(partial, 1024);
+        }
+        TEST_ASSERT(merged.covers(1ull << N));
+
+        merger.setQUBO(W, sq::optMaximize);
+        merger.setPartialResult(merged);
+        merger.makeSolution();
+        TEST_ASSERT(bf.get_E()(0) == merger.get_E()(0));
+        TEST_ASSERT(bf.get_x() == merger.get_x());
+    }
+
+    /* ranges of gray_code and brute_force_search are in different orders. */
+    testcase("partial results of different algorithms") {
+        sqcpu::CPUDenseGraphBFSearcher<real> gc, bf, merger;
+        sq::DenseGraphBFPartialResult<real> merged, partial;
+        gc.setQUBO(W);
+        gc.searchPartial(0, 1ull << (N - 1), &merged);
+        bf.setQUBO(W);
+        bf.selectAlgorithm(sq::algoBruteForceSearch);
+        bf.searchPartial(1ull << (N - 1), 1ull << N, &partial);
+        bool mergeThrown = false;
+        try {
+            merged.merge(partial, 1024);
+        }
+        catch (...) {
+            mergeThrown = true;
+        }
+        TEST_ASSERT(mergeThrown);
+
+        merger.setQUBO(W);
+        merger.selectAlgorithm(sq::algoBruteForceSearch);
+        bool setThrown = false;
+        try {
+            merger.setPartialResult(merged);
+        }
+        catch (...) {
+            setThrown = true;
+        }
+        TEST_ASSERT(setThrown);
+    }
+
+    testcase("branch and bound, minimize") {
+        sqcpu::CPUDenseGraphBFSearcher<real> gc, bnb;
+        search(gc, W, sq::optMinimize, sq::algoGrayCode, 1000);
+        search(bnb, W, sq::optMinimize, sq::algoBranchAndBound, 1000);
+        TEST_ASSERT(gc.get_E()(0) == bnb.get_E()(0));
+        TEST_ASSERT(gc.get_x() == bnb.get_x());
+    }
+
+    testcase("branch and bound, maximize") {
+        sqcpu::CPUDenseGraphBFSearcher<real> gc, bnb;
+        search(gc, W, sq::optMaximize, sq::algoGrayCode, 1000);
+        search(bnb, W, sq::optMaximize, sq::algoBranchAndBound, 1000);
+        TEST_ASSERT(gc.get_E()(0) == bnb.get_E()(0));
+        TEST_ASSERT(gc.get_x() == bnb.get_x());
+    }
+
+    /* 5 uncoupled 4x4 grids, minimum E is 5 times of that of a grid. */
+    testcase("branch and bound, N=80") {
+        const sq::SizeType nBlock = 16, nBlocks = 5;
+        sq::MatrixType<real> Wblock = testMatSymmetric<real>(nBlock);
+        for (sq::IdxType i = 0; i < nBlock; ++i) {
+            for (sq::IdxType j = 0; j < nBlock; ++j) {
+                sq::IdxType d = std::abs(i - j);
+                bool neighbor = (d == 4) || ((d == 1) && (std::min(i, j) % 4 != 3));
+                if ((d != 0) && !neighbor)
+                    Wblock(i, j) = real(0.);
+            }
+        }
+        sq::MatrixType<real> Wlarge = sq::MatrixType<real>::zeros(nBlock * nBlocks, nBlock * nBlocks);
+        for (sq::IdxType iBlock = 0; iBlock < nBlocks; ++iBlock) {
+            for (sq::IdxType i = 0; i < nBlock; ++i) {
+                for (sq::IdxType j = 0; j < nBlock; ++j)
+                    Wlarge(iBlock * nBlock + i, iBlock * nBlock + j) = Wblock(i, j);
+            }
+        }
+        sqcpu::CPUDenseGraphBFSearcher<real> gc, bnb;
+        search(gc, Wblock, sq::optMinimize, sq::algoGrayCode, 1000);
+        bnb.setQUBO(Wlarge);
+        bnb.search();
+        TEST_ASSERT(bnb.getAlgorithm() == sq::algoBranchAndBound);
+        TEST_ASSERT(bnb.get_E()(0) == gc.get_E()(0) * real(nBlocks));
+        const sq::BitSetArray &xList = bnb.get_x();
+        real E;
+        sqcpu::DGFuncs<real>::calculate_E(&E, Wlarge, sq::cast<real>(xList[0]));
+        TEST_ASSERT(E == bnb.get_E()(0));
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+#include <sqaodc/sqaodc.h>
+
+
+class CPUDenseGraphBFSearcherTest : public MinimalTestSuite {
+public:
+    CPUDenseGraphBFSearcherTest(void);
+    ~CPUDenseGraphBFSearcherTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+private:
+    template<class real>
+    void tests();
+};
@@ -0,0 +1,155 @@
+#include "CPUSparseGraphAnnealerTest.h"
+#include <cpu/CPUSparseGraphAnnealer.h>
+#include <cpu/CPUDenseGraphBFSearcher.h>
+#include <cpu/CPUFormulas.h>
+#include "utils.h"
+
+namespace sqcpu = sqaod_cpu;
+
+
+CPUSparseGraphAnnealerTest::CPUSparseGraphAnnealerTest(void)
+        : MinimalTestSuite("CPUSparseGraphAnnealerTest") {
+}
+
+
+CPUSparseGraphAnnealerTest::~CPUSparseGraphAnnealerTest(void) {
+}
+
+
+void CPUSparseGraphAnnealerTest::setUp() {
+}
+
+void CPUSparseGraphAnnealerTest::tearDown() {
+}
+    
+void CPUSparseGraphAnnealerTest::run(std::ostream &ostm) {
+    tests<float>();
+    tests<double>();
+}
+
+
+/* W(i, j) is kept if (j - i) mod N is 0, +-1 or +-3, W(i, j) is zeroed otherwise. */
+template<class real>
+static void sparsify(sq::MatrixType<real> *W, sq::SparseMatrixType<real> *spW) {
+    sq::SizeType N = W->rows;
+    sq::SizeType nnz = 0;
+    for (sq::IdxType i = 0; i < N; ++i) {
+        for (sq::IdxType j = 0; j < N; ++j) {
+            int d = (j - i + N) % N;
+            bool kept = (d == 0) || (d == 1) || (d == N - 1) || (d == 3) || (d == N - 3);
+            if (!kept)
+                (*W)(i, j) = real(0.);
+            else if ((*W)(i, j) != real(0.))
+                ++nnz;
+        }
+    }
+    spW->resize(N, N, nnz);
+    sq::IdxType pos = 0;
+    for (sq::IdxType i = 0; i < N; ++i) {
+        spW->rowPtr(i) = pos;
+        /* columns are stored in the descending order, annealers should accept them. */
+        for (sq::IdxType j = N - 1; 0 <= j; --j) {
+            if ((*W)(i, j) != real(0.)) {
+                spW->colIdx(pos) = j;
+                spW->values(pos) = (*W)(i, j);
+                ++pos;
+            }
+        }
+    }
+    spW->rowPtr(N) = pos;
+}
+
+template<class real>
+static void anneal(sqcpu::CPUSparseGraphAnnealer<real> &an, const sq::SparseMatrixType<real> &W,
+                   sq::SizeType m) {
+    an.setQUBO(W);
+    an.setPreference(sq::Preference(sq::pnNumTrotters, m));
+    an.seed(0);
+    an.prepare();
+    an.randomizeSpin();
+    real G = real(5.), beta = real(1. / 0.02);
+    for (int idx = 0; idx < 50; ++idx) {
+        an.annealOneStep(G, beta);
+        G *= real(0.9);
+    }
+    an.makeSolution();
+}
+
+template<class real>
+void CPUSparseGraphAnnealerTest::tests() {
+
+    const sq::SizeType N = 16;
+    const sq::SizeType m = 7; /* odd, to test a wrapped coloring. */
+    sq::MatrixType<real> W = testMatSymmetric<real>(N);
+    sq::SparseMatrixType<real> spW;
+    sparsify(&W, &spW);
+
+    testcase("asymmetric W is rejected") {
+        sq::SparseMatrixType<real> asymW(spW);
+        asymW.values(0) += real(1.);
+        sqcpu::CPUSparseGraphAnnealer<real> an;
+        bool thrown = false;
+        try {
+            an.setQUBO(asymW);
+        }
+        catch (...) {
+            thrown = true;
+        }
+        TEST_ASSERT(thrown);
+    }
+
+    testcase("E equals to QUBO energy of x") {
+        sqcpu::CPUSparseGraphAnnealer<real> an;
+        anneal(an, spW, m);
+        TEST_ASSERT(an.getNumColors() <= 5);
+        const sq::BitSetArray &xList = an.get_x();
+        const sq::VectorType<real> &E = an.get_E();
+        bool ok = (sq::SizeType)xList.size() == m;
+        for (sq::IdxType idx = 0; ok && (idx < m); ++idx) {
+            real Ex;
+            sqcpu::DGFuncs<real>::calculate_E(&Ex, W, sq::cast<real>(xList[idx]));
+            ok &= Ex == E(idx);
+        }
+        TEST_ASSERT(ok);
+    }
+
+    testcase("minimum E equals to brute-force search") {
+        sqcpu::CPUSparseGraphAnnealer<real> an;
+        anneal(an, spW, m);
+        sqcpu::CPUDenseGraphBFSearcher<real> searcher;
+        searcher.setQUBO(W);
+        searcher.search();
+        real Emin = sq::mapToRowVector(an.get_E()).minCoeff();
+        TEST_ASSERT(Emin == searcher.get_E()(0));
+    }
+
+    testcase("Hamiltonian round trip") {
+        sqcpu::CPUSparseGraphAnnealer<real> an0, an1;
+        anneal(an0, spW, m);
+        sq::VectorType<real> h;
+        sq::SparseMatrixType<real> J;
+        real c;
+        an0.getHamiltonian(&h, &J, &c);
+        an1.setHamiltonian(h, J, c);
+        an1.setPreference(sq::Preference(sq::pnNumTrotters, m));
+        an1.prepare();
+        an1.set_x(an0.get_x()[0]);
+        an1.makeSolution();
+        TEST_ASSERT(an1.get_E()(0) == an0.get_E()(0));
+    }
+
+    testcase("counter-based random does not depend on # threads") {
+        sqcpu::CPUSparseGraphAnnealer<real> an0, an1;
+        an0.setPreference(sq::Preference(sq::pnRandom, sq::rngCounterBased));
+        an0.setPreference(sq::Preference(sq::pnNumThreads, 1));
+        an1.setPreference(sq::Preference(sq::pnRandom, sq::rngCounterBased));
+        an1.setPreference(sq::Preference(sq::pnNumThreads, 3));
+        anneal(an0, spW, m);
+        anneal(an1, spW, m);
+        const sq::BitSetArray &q0 = an0.get_q(), &q1 = an1.get_q();
+        bool ok = q0.size() == q1.size();
+        for (sq::IdxType idx = 0; ok && (idx < (sq::IdxType)q0.size()); ++idx)
+            ok &= q0[idx] == q1[idx];
+        TEST_ASSERT(ok);
+    }
+}
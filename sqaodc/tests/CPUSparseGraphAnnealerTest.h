@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+#include <sqaodc/sqaodc.h>
+
+
+class CPUSparseGraphAnnealerTest : public MinimalTestSuite {
+public:
+    CPUSparseGraphAnnealerTest(void);
+    ~CPUSparseGraphAnnealerTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+private:
+    template<class real>
+    void tests();
+};
@@ -0,0 +1,106 @@
+#include "MatrixTest.h"
+#include <sqaodc/common/EigenBridge.h>
+#include <cpu/CPUFormulas.h>
+#include <stdint.h>
+
+namespace sq = sqaod;
+namespace sqcpu = sqaod_cpu;
+
+MatrixTest::MatrixTest(void) : MinimalTestSuite("MatrixTest") {
+}
+
+MatrixTest::~MatrixTest(void) {
+}
+
+
+void MatrixTest::setUp() {
+}
+
+void MatrixTest::tearDown() {
+}
+
+template<class V>
+static bool isAligned(const V *ptr) {
+    return ((uintptr_t)ptr % sq::cacheLineSize) == 0;
+}
+
+/* W(r, c) = r - 2 c */
+template<class real>
+static void fillMatrix(sq::MatrixType<real> *W) {
+    for (int r = 0; r < W->rows; ++r)
+        for (int c = 0; c < W->cols; ++c)
+            (*W)(r, c) = real(r - 2 * c);
+}
+    
+void MatrixTest::run(std::ostream &ostm) {
+
+    testcase("aligned allocation") {
+        sq::MatrixType<double> mat(3, 5);
+        sq::VectorType<float> vec(7);
+        TEST_ASSERT(mat.isPacked());
+        TEST_ASSERT(isAligned(mat.data) && isAligned(vec.data));
+        sq::MatrixType<float> padded(3, 5, sq::paddedStride<float>(5));
+        TEST_ASSERT(padded.stride == 16);
+        TEST_ASSERT(isAligned(padded.row(0)) && isAligned(padded.row(2)));
+    }
+
+    testcase("padded matrix operations") {
+        const int N = 11;
+        sq::MatrixType<double> packed(N, N), padded(N, N, sq::paddedStride<double>(N));
+        fillMatrix(&packed);
+        fillMatrix(&padded);
+        TEST_ASSERT(padded == packed);
+        TEST_ASSERT(padded.sum() == packed.sum());
+        TEST_ASSERT(padded.min() == packed.min());
+        TEST_ASSERT(sq::mapTo(padded) == sq::mapTo(packed));
+        TEST_ASSERT(sq::mapToAligned(padded) == sq::mapTo(packed));
+
+        sq::MatrixType<double> copied(padded);
+        TEST_ASSERT(copied.isPacked() && (copied == packed));
+        padded = packed;
+        TEST_ASSERT(!padded.isPacked() && (padded == packed));
+
+        sq::MatrixType<float> casted = sq::cast<float>(padded);
+        TEST_ASSERT(casted(N - 1, N - 1) == float(- (N - 1)));
+    }
+
+    testcase("mapping padded memory") {
+        const int N = 5, stride = 8;
+        double buf[N * stride];
+        for (int idx = 0; idx < N * stride; ++idx)
+            buf[idx] = -1.;
+        sq::MatrixType<double> mat(buf, N, N, stride);
+        sq::mapTo(mat) = sq::EigenMatrixType<double>::Ones(N, N);
+        mat *= 2.;
+        bool ok = true;
+        for (int r = 0; r < N; ++r) {
+            for (int c = 0; c < stride; ++c)
+                ok &= (buf[r * stride + c] == ((c < N) ? 2. : -1.));
+        }
+        TEST_ASSERT(ok);
+        TEST_ASSERT(mat.sum() == 2. * N * N);
+    }
+
+    testcase("formulas with padded W") {
+        const int N = 9;
+        sq::MatrixType<double> packed(N, N), padded(N, N, sq::paddedStride<double>(N));
+        for (int r = 0; r < N; ++r)
+            for (int c = 0; c < N; ++c)
+                packed(r, c) = padded(r, c) = double((r * c) % 5) - 2.;
+        sq::BitMatrix x(3, N);
+        for (int r = 0; r < x.rows; ++r)
+            for (int c = 0; c < N; ++c)
+                x(r, c) = (r + c) % 2;
+        sq::VectorType<double> E0, E1;
+        sqcpu::DGFuncs<double>::calculate_E(&E0, packed, sq::cast<double>(x));
+        sqcpu::DGFuncs<double>::calculate_E(&E1, padded, sq::cast<double>(x));
+        TEST_ASSERT(E0 == E1);
+
+        sq::VectorType<double> h0, h1;
+        sq::MatrixType<double> J0, J1(N, N, sq::paddedStride<double>(N));
+        double c0, c1;
+        sqcpu::DGFuncs<double>::calculateHamiltonian(&h0, &J0, &c0, packed);
+        sqcpu::DGFuncs<double>::calculateHamiltonian(&h1, &J1, &c1, padded);
+        TEST_ASSERT((h0 == h1) && (J0 == J1) && (c0 == c1));
+    }
+}
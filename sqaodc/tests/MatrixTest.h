@@ -0,0 +1,16 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+
+
+class MatrixTest : public MinimalTestSuite {
+public:
+    MatrixTest(void);
+    ~MatrixTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+};
@@ -0,0 +1,108 @@
+#include "RandomTest.h"
+#include <sqaodc/common/RandomXoshiro.h>
+#include <sqaodc/common/RandomPhilox.h>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+namespace sq = sqaod;
+
+RandomTest::RandomTest(void) : MinimalTestSuite("RandomTest") {
+}
+
+RandomTest::~RandomTest(void) {
+}
+
+
+void RandomTest::setUp() {
+}
+
+void RandomTest::tearDown() {
+}
+    
+void RandomTest::run(std::ostream &ostm) {
+
+    testcase("RandomXoshiro fill() == random()") {
+        const int nRands = 1000; /* not a multiple of the buffer size */
+        sq::RandomXoshiro random0, random1;
+        random0.seed(0);
+        random1.seed(0);
+        std::vector<float> rand0(nRands), rand1(nRands);
+        bool ok = true;
+        for (int loop = 0; loop < 3; ++loop) {
+            random0.fill(rand0.data(), nRands);
+            for (int idx = 0; idx < nRands; ++idx)
+                rand1[idx] = random1.random<float>();
+            ok &= (rand0 == rand1);
+            ok &= (random0.randInt32() == random1.randInt32());
+        }
+        TEST_ASSERT(ok);
+    }
+
+    testcase("RandomXoshiro range") {
+        const int nRands = 1 << 16;
+        sq::RandomXoshiro random;
+        random.seed(0);
+        std::vector<float> randf(nRands);
+        std::vector<double> randd(nRands);
+        random.fill(randf.data(), nRands);
+        random.fill(randd.data(), nRands);
+        bool ok = true;
+        double sum = 0.;
+        for (int idx = 0; idx < nRands; ++idx) {
+            ok &= (0.f <= randf[idx]) && (randf[idx] < 1.f);
+            ok &= (0. <= randd[idx]) && (randd[idx] < 1.);
+            sum += randf[idx] + randd[idx];
+        }
+        TEST_ASSERT(ok);
+        TEST_ASSERT(std::fabs(sum / (2 * nRands) - 0.5) < 0.01);
+    }
+
+    testcase("RandomXoshiro randInt()") {
+        const int N = 3, nRands = 30000;
+        sq::RandomXoshiro random;
+        random.seed(0);
+        int counts[N] = { };
+        bool ok = true;
+        for (int idx = 0; idx < nRands; ++idx) {
+            unsigned long v = random.randInt(N);
+            ok &= (v < (unsigned long)N);
+            if (v < (unsigned long)N)
+                ++counts[v];
+        }
+        TEST_ASSERT(ok);
+        for (int idx = 0; idx < N; ++idx)
+            TEST_ASSERT(std::abs(counts[idx] - nRands / N) < 500);
+    }
+
+    testcase("RandomPhilox known answer") {
+        /* Philox4x32-10, key = 0, counter = 0 */
+        sq::RandomPhilox random;
+        random.seed(0);
+        unsigned int words[4];
+        for (int idx = 0; idx < 4; ++idx)
+            words[idx] = random.randInt32();
+        TEST_ASSERT(words[0] == 0x6627e8d5u);
+        TEST_ASSERT(words[1] == 0xe169c58du);
+        TEST_ASSERT(words[2] == 0xbc57ac4cu);
+        TEST_ASSERT(words[3] == 0x9b00dbd8u);
+    }
+
+    testcase("RandomPhilox seek()") {
+        const int nRands = 1000;
+        sq::RandomPhilox random0, random1;
+        random0.seed(3);
+        random1.seed(3);
+        std::vector<float> rand0(nRands), rand1(nRands);
+        random0.seek(1, 2, 3);
+        random0.randInt32();
+        random0.fill(rand0.data(), nRands);
+        random1.seek(4, 5, 6); /* moved away and back */
+        random1.randInt32();
+        random1.seek(1, 2, 3);
+        random1.randInt32();
+        for (int idx = 0; idx < nRands; ++idx)
+            rand1[idx] = random1.random<float>();
+        TEST_ASSERT(rand0 == rand1);
+    }
+}
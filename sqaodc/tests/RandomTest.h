@@ -0,0 +1,16 @@
+#pragma once
+
+#include "MinimalTestSuite.h"
+
+
+class RandomTest : public MinimalTestSuite {
+public:
+    RandomTest(void);
+    ~RandomTest(void);
+
+    void setUp();
+
+    void tearDown();
+    
+    void run(std::ostream &ostm);
+};
@@ -1,7 +1,15 @@
 #include <sqaodc/sqaodc.h>
 #include <iostream>
 #include "MinimalTestSuite.h"
+#include "ArrayTest.h"
 #include "BFSearcherRangeCoverageTest.h"
+#include "CPUBipartiteGraphAnnealerTest.h"
+#include "CPUBipartiteGraphBFSearcherTest.h"
+#include "CPUDenseGraphAnnealerTest.h"
+#include "CPUDenseGraphBFSearcherTest.h"
+#include "CPUSparseGraphAnnealerTest.h"
+#include "MatrixTest.h"
+#include "RandomTest.h"
 
 #ifdef SQAODC_CUDA_ENABLED
 
@@ -18,7 +26,15 @@
 
 int main(int argc, char* argv[]) {
     
+    runTest<ArrayTest>();
+    runTest<MatrixTest>();
     runTest<BFSearcherRangeCoverageTest>();
+    runTest<RandomTest>();
+    runTest<CPUDenseGraphAnnealerTest>();
+    runTest<CPUDenseGraphBFSearcherTest>();
+    runTest<CPUBipartiteGraphBFSearcherTest>();
+    runTest<CPUBipartiteGraphAnnealerTest>();
+    runTest<CPUSparseGraphAnnealerTest>();
 #ifdef SQAODC_CUDA_ENABLED
     runTest<DeviceTest>();
     runTest<DeviceSegmentedSumTest>();
@@ -22,8 +22,8 @@ class BipartiteGraphAnnealerBase :
         self._cext.seed(self._cobj, seed, self.dtype)
             
     def set_qubo(self, b0, b1, W, optimize = pref.minimize) :
+        b0, b1, W = common.as_ndarray_from_vars([b0, b1, W], self.dtype)
         checkers.bipartite_graph.qubo(b0, b1, W)
-        b0, b1, W = common.clone_as_ndarray_from_vars([b0, b1, W], self.dtype)
         self._cext.set_qubo(self._cobj, b0, b1, W, optimize, self.dtype);
         self._optimize = optimize
 
@@ -78,3 +78,12 @@ class BipartiteGraphAnnealerBase :
         
     def anneal_one_step(self, G, beta) :
         self._cext.anneal_one_step(self._cobj, G, beta, self.dtype)
+
+    # schedule is a tuple of (G, beta) arrays, or given by sqaod.geometric_schedule() and
+    # sqaod.linear_schedule().  callback(step, G, beta) is called every interval steps,
+    # and annealing stops if it returns False.
+    def anneal(self, schedule, callback = None, interval = 1) :
+        G, beta = schedule
+        G = np.ascontiguousarray(G, self.dtype).reshape(-1)
+        beta = np.ascontiguousarray(beta, self.dtype).reshape(-1)
+        self._cext.anneal(self._cobj, G, beta, callback, interval, self.dtype)
@@ -18,8 +18,8 @@ class BipartiteGraphBFSearcherBase :
         self._cext.delete(self._cobj, self.dtype)
 
     def set_qubo(self, b0, b1, W, optimize = pref.minimize) :
+        b0, b1, W = common.as_ndarray_from_vars([b0, b1, W], self.dtype)
         checkers.bipartite_graph.qubo(b0, b1, W)
-        b0, b1, W = common.clone_as_ndarray_from_vars([b0, b1, W], self.dtype)
         self._dim = (b0.shape[0], b1.shape[0])
         self._cext.set_qubo(self._cobj, b0, b1, W, optimize, self.dtype)
 
@@ -48,6 +48,13 @@ class BipartiteGraphBFSearcherBase :
         
     def make_solution(self) :
         self._cext.make_solution(self._cobj, self.dtype);
+
+    def save_checkpoint(self, filename) :
+        self._cext.save_checkpoint(self._cobj, filename, self.dtype)
+
+    def resume_from_checkpoint(self, filename) :
+        # problem should be set by set_qubo() before resuming.
+        self._cext.resume_from_checkpoint(self._cobj, filename, self.dtype)
         
     def search_range(self) :
         return self._cext.search_range(self._cobj, self.dtype)
@@ -94,6 +94,20 @@ class dense_graph :
             raise_dims_dont_match('W, x', (W, x))
         assert_is_bits((x))
 
+# sparse graph
+
+class sparse_graph :
+
+    # W is given as a (data, indices, indptr) tuple of the CSR format.
+    @staticmethod
+    def qubo(data, indices, indptr) :
+        assert_is_vector('data', data)
+        assert_is_vector('indices', indices)
+        assert_is_vector('indptr', indptr)
+        matched = (data.shape[0] == indices.shape[0]) and (indptr[-1] == data.shape[0])
+        if not matched :
+            raise_dims_dont_match('data, indices, indptr', (data, indices, indptr))
+
 # bipartite_graph
 
 class bipartite_graph :
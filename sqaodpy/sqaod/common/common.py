@@ -30,8 +30,14 @@ def is_bits(v) :
             return False
     return True
 
-def is_symmetric(mat) :
-    return np.allclose(mat, mat.T)
+# compared in row blocks not to create temporaries as large as mat.
+def is_symmetric(mat, blocksize = 256) :
+    N = mat.shape[0]
+    for begin in range(0, N, blocksize) :
+        end = min(begin + blocksize, N)
+        if not np.allclose(mat[begin:end], mat[:, begin:end].T) :
+            return False
+    return True
 
 def generate_random_symmetric_W(N, wmin = -0.5, wmax = 0.5, dtype=np.float64) :
     W = np.zeros((N, N), dtype)
@@ -62,6 +68,36 @@ def clone_as_ndarray(var, dtype) :
     clone[...] = var[...]
     return clone
 
+# returns var as a C-contiguous ndarray of dtype.
+# var is returned as is (not copied) if it already has the dtype and the layout, and
+# any object exposing the buffer protocol is accepted.
+
+def as_ndarray(var, dtype) :
+    return np.ascontiguousarray(var, dtype)
+
+# clone a matrix as a (data, indices, indptr) tuple of the CSR format.
+# W is a scipy.sparse matrix, a (data, indices, indptr) tuple or a dense matrix.
+
+def clone_as_csr(W, dtype) :
+    if hasattr(W, 'tocsr') :
+        W = W.tocsr()
+        data, indices, indptr = W.data, W.indices, W.indptr
+    elif type(W) is tuple :
+        data, indices, indptr = W
+    else :
+        W = np.asarray(W)
+        if len(W.shape) != 2 :
+            raise Exception('W is not a matrix. ' + str(W.shape))
+        rows, cols = np.nonzero(W)
+        data, indices = W[rows, cols], cols
+        indptr = np.zeros((W.shape[0] + 1), np.int32)
+        indptr[1:] = np.cumsum(np.bincount(rows, minlength = W.shape[0]))
+    return (np.array(data, dtype, order='C'), np.array(indices, np.int32, order='C'),
+            np.array(indptr, np.int32, order='C'))
+
+def as_ndarray_from_vars(vars, dtype) :
+    return tuple([as_ndarray(var, dtype) for var in vars])
+
 def clone_as_ndarray_from_vars(vars, dtype) :
     cloned = []
     for var in vars :
@@ -100,20 +136,48 @@ def bit_from_spin(q) :
 
 
 
+# annealing schedules, tuples of (G, beta) arrays given to annealer.anneal().
+
+def geometric_schedule(Ginit = 5., Gfin = 0.01, tau = 0.99, beta = 1. / 0.02) :
+    if not 0. < tau < 1. :
+        raise ValueError('tau must be in (0, 1).')
+    if Gfin <= 0. :
+        raise ValueError('Gfin must be positive.')
+    G = []
+    Gstep = Ginit
+    while Gfin < Gstep :
+        G.append(Gstep)
+        Gstep = Gstep * tau
+    G = np.array(G, np.float64)
+    return G, np.full(G.shape, beta, np.float64)
+
+def linear_schedule(Ginit = 5., Gfin = 0.01, n_steps = 100, beta = 1. / 0.02) :
+    G = np.linspace(Ginit, Gfin, n_steps)
+    return G, np.full(G.shape, beta, np.float64)
+
+# runs a schedule by anneal_one_step(), used by annealers implemented in python.
+def anneal_schedule(annealer, schedule, callback = None, interval = 1) :
+    G, beta = schedule
+    for step in range(len(G)) :
+        annealer.anneal_one_step(G[step], beta[step])
+        if callback is not None and (step + 1) % interval == 0 :
+            if callback(step, G[step], beta[step]) is False :
+                break
+
+
 def anneal(annealer, Ginit = 5., Gfin = 0.01, beta = 1. / 0.02, tau = 0.99, n_repeat = 10, verbose = False) :
     Emin = sys.float_info.max
     q0 = []
     q1 = []
+
+    def print_E(step, G, beta) :
+        annealer.calculate_E()
+        print(annealer.get_E())
+    callback = print_E if verbose else None
     
+    schedule = geometric_schedule(Ginit, Gfin, tau, beta)
     for loop in range(0, n_repeat) :
         annealer.prepare()
         annealer.randomize_spin()
-        G = Ginit
-        while Gfin < G :
-            annealer.anneal_one_step(G, beta)
-            if verbose :
-                E - annealer.calculate_E()
-                print(E)
-            G = G * tau
-
+        annealer.anneal(schedule, callback)
         annealer.make_solution()
@@ -21,8 +21,8 @@ class DenseGraphAnnealerBase :
         self._cext.seed(self._cobj, seed, self.dtype)
         
     def set_qubo(self, W, optimize = pref.minimize) :
+        W = common.as_ndarray(W, self.dtype)
         checkers.dense_graph.qubo(W)
-        W = common.clone_as_ndarray(W, self.dtype)
         self._cext.set_qubo(self._cobj, W, optimize, self.dtype)
         self._optimize = optimize
 
@@ -71,3 +71,12 @@ class DenseGraphAnnealerBase :
 
     def anneal_one_step(self, G, beta) :
         self._cext.anneal_one_step(self._cobj, G, beta, self.dtype)
+
+    # schedule is a tuple of (G, beta) arrays, or given by sqaod.geometric_schedule() and
+    # sqaod.linear_schedule().  callback(step, G, beta) is called every interval steps,
+    # and annealing stops if it returns False.
+    def anneal(self, schedule, callback = None, interval = 1) :
+        G, beta = schedule
+        G = np.ascontiguousarray(G, self.dtype).reshape(-1)
+        beta = np.ascontiguousarray(beta, self.dtype).reshape(-1)
+        self._cext.anneal(self._cobj, G, beta, callback, interval, self.dtype)
@@ -18,8 +18,8 @@ class DenseGraphBFSearcherBase :
             self._cext.delete(self._cobj, self.dtype)
 
     def set_qubo(self, W, optimize = pref.minimize) :
+        W = common.as_ndarray(W, self.dtype)
         checkers.dense_graph.qubo(W)
-        W = common.clone_as_ndarray(W, self.dtype)
         self._N = W.shape[0]
         self._cext.set_qubo(self._cobj, W, optimize, self.dtype)
         self._optimize = optimize
@@ -49,14 +49,36 @@ class DenseGraphBFSearcherBase :
         
     def make_solution(self) :
         self._cext.make_solution(self._cobj, self.dtype);
+
+    def save_checkpoint(self, filename) :
+        self._cext.save_checkpoint(self._cobj, filename, self.dtype)
+
+    def resume_from_checkpoint(self, filename) :
+        # problem should be set by set_qubo() before resuming.
+        self._cext.resume_from_checkpoint(self._cobj, filename, self.dtype)
         
     def search_range(self) :
         return self._cext.search_range(self._cobj, self.dtype)
+
+    def search_budget(self, budget) :
+        # searches at least budget candidates in one call, returns (completed, curx).
+        return self._cext.search_budget(self._cobj, budget, self.dtype)
+        
+    def search_partial(self, begin, end, filename) :
+        # searches [begin, end) of the search space, and saves the result to filename.
+        # ranges are in the enumeration order of the algorithm, x for brute_force_search and
+        # i of gray(i) for gray_code.  partial results of different algorithms are not merged.
+        # results of processes are merged by set_partial_results().
+        self._cext.search_partial(self._cobj, begin, end, filename, self.dtype)
+
+    def set_partial_results(self, filenames) :
+        # merges partial results, solutions are given by make_solution().
+        self._cext.set_partial_results(self._cobj, filenames, self.dtype)
         
     def search(self) :
         self.prepare()
         while True :
-            comp, curx = self._cext.search_range(self._cobj, self.dtype)
+            comp, curx = self._cext.search_budget(self._cobj, 1 << 24, self.dtype)
             if comp :
                 break;
         self.make_solution()
@@ -8,6 +8,10 @@ algorithm.default = 'default'
 algorithm.naive = 'naive'
 algorithm.coloring = 'coloring'
 algorithm.brute_force_search = 'brute_force_search'
+algorithm.local_field = 'local_field'
+algorithm.multi_spin_coding = 'multi_spin_coding'
+algorithm.gray_code = 'gray_code'
+algorithm.branch_and_bound = 'branch_and_bound'
 
 
 class Minimize :
@@ -58,6 +58,10 @@ class Annealer(Sovler) :
     def anneal_one_step(self, G, beta) :
         raise NotImplementedError()
 
+    @abstractmethod
+    def anneal(self, schedule, callback = None, interval = 1) :
+        raise NotImplementedError()
+
     
 class DenseGraphSolver :
     @abstractmethod
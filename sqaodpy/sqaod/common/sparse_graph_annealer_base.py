@@ -0,0 +1,82 @@
+from __future__ import print_function
+import numpy as np
+from . import checkers
+from . import preference as pref
+from . import common
+
+class SparseGraphAnnealerBase :
+    
+    def __init__(self, cext, dtype, W, optimize, prefdict) :
+        self.dtype = dtype
+        self._cext = cext
+        if not W is None :
+            self.set_qubo(W, optimize)
+        self.set_preferences(prefdict)
+
+    def __del__(self) :
+        if hasattr(self, '_cobj') :
+            self._cext.delete(self._cobj, self.dtype)
+        
+    def seed(self, seed) :
+        self._cext.seed(self._cobj, seed, self.dtype)
+
+    # W is a scipy.sparse matrix, a (data, indices, indptr) tuple of the CSR format,
+    # or a dense matrix.
+    def set_qubo(self, W, optimize = pref.minimize) :
+        data, indices, indptr = common.clone_as_csr(W, self.dtype)
+        checkers.sparse_graph.qubo(data, indices, indptr)
+        self._cext.set_qubo(self._cobj, indptr, indices, data, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return self._cext.get_problem_size(self._cobj, self.dtype)
+
+    def set_preferences(self, prefdict = None, **prefs) :
+        if not prefdict is None:
+            self._cext.set_preferences(self._cobj, prefdict, self.dtype)
+        self._cext.set_preferences(self._cobj, prefs, self.dtype)
+
+    def get_preferences(self) :
+        return self._cext.get_preferences(self._cobj, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._cext.get_E(self._cobj, self.dtype)
+
+    def get_x(self) :
+        return self._cext.get_x(self._cobj, self.dtype)
+
+    def set_x(self, x) :
+        self._cext.set_x(self._cobj, x, self.dtype)
+
+    # J is returned as a (data, indices, indptr) tuple of the CSR format.
+    def get_hamiltonian(self) :
+        h, indptr, indices, data, c = self._cext.get_hamiltonian(self._cobj, self.dtype)
+        return h, (data, indices, indptr), c
+
+    def get_q(self) :
+        return self._cext.get_q(self._cobj, self.dtype)
+
+    def randomize_spin(self) :
+        self._cext.randomize_spin(self._cobj, self.dtype)
+
+    def prepare(self) :
+        self._cext.prepare(self._cobj, self.dtype)
+
+    def make_solution(self) :
+        self._cext.make_solution(self._cobj, self.dtype)
+
+    def anneal_one_step(self, G, beta) :
+        self._cext.anneal_one_step(self._cobj, G, beta, self.dtype)
+        return True
+
+    # schedule is a tuple of (G, beta) arrays, or given by sqaod.geometric_schedule() and
+    # sqaod.linear_schedule().  callback(step, G, beta) is called every interval steps,
+    # and annealing stops if it returns False.
+    def anneal(self, schedule, callback = None, interval = 1) :
+        G, beta = schedule
+        G = np.ascontiguousarray(G, self.dtype).reshape(-1)
+        beta = np.ascontiguousarray(beta, self.dtype).reshape(-1)
+        self._cext.anneal(self._cobj, G, beta, callback, interval, self.dtype)
@@ -1,6 +1,7 @@
 from . import formulas
 from .dense_graph_annealer import dense_graph_annealer
 from .dense_graph_bf_searcher import dense_graph_bf_searcher
+from .sparse_graph_annealer import sparse_graph_annealer
 from .bipartite_graph_annealer import bipartite_graph_annealer
 from .bipartite_graph_bf_searcher import bipartite_graph_bf_searcher
 
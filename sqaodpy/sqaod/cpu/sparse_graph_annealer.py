@@ -0,0 +1,44 @@
+from __future__ import print_function
+import numpy as np
+import sqaod
+from sqaod.common.sparse_graph_annealer_base import SparseGraphAnnealerBase
+from . import cpu_sg_annealer as cext
+
+class SparseGraphAnnealer(SparseGraphAnnealerBase) :
+
+    def __init__(self, W, optimize, dtype, prefdict) :
+        self._cobj = cext.new(dtype)
+        SparseGraphAnnealerBase.__init__(self, cext, dtype, W, optimize, prefdict)
+        
+
+def sparse_graph_annealer(W = None, optimize=sqaod.minimize, dtype=np.float64, **prefs) :
+    return SparseGraphAnnealer(W, optimize, dtype, prefs)
+
+
+if __name__ == '__main__' :
+
+    # ring of N spins, W(i, i) = -1, W(i, i + 1) = W(i + 1, i) = 2
+    N = 1000
+    rows = np.concatenate((np.arange(N), np.arange(N), (np.arange(N) + 1) % N))
+    cols = np.concatenate((np.arange(N), (np.arange(N) + 1) % N, np.arange(N)))
+    values = np.concatenate((-np.ones(N), 2 * np.ones(N), 2 * np.ones(N)))
+    W = np.zeros((N, N))
+    W[rows, cols] = values
+
+    ann = sparse_graph_annealer(W, dtype=np.float64, n_trotters = 8)
+    
+    Ginit = 5.
+    Gfin = 0.01
+    beta = 1. / 0.02
+    tau = 0.99
+
+    G = Ginit
+    ann.prepare()
+    ann.randomize_spin()
+    while Gfin < G :
+        ann.anneal_one_step(G, beta)
+        G = G * tau
+    ann.make_solution()
+    E = ann.get_E()
+    print(E)
+    print(ann.get_preferences())
@@ -0,0 +1,14 @@
+#include <sqaodc/pyglue/pyglue.h>
+
+namespace {
+
+template<class real>
+using Annealer = sq::cpu::SparseGraphAnnealer<real>;
+
+}
+
+#define modname "cpu_sg_annealer"
+#define INIT_MODULE INITFUNCNAME(cpu_sg_annealer)
+#define SPARSE_GRAPH
+
+#include <sqaodc/pyglue/annealer.inc>
@@ -130,6 +130,9 @@ class BipartiteGraphAnnealer :
     def anneal_one_step(self, G, beta) :
         # will be dynamically replaced.
         pass
+
+    def anneal(self, schedule, callback = None, interval = 1) :
+        sqaod.anneal_schedule(self, schedule, callback, interval)
                 
     def anneal_one_step_naive(self, G, beta) :
         h0, h1, J, c, q0, q1 = self._vars()
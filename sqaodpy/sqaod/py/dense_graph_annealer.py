@@ -116,6 +116,9 @@ class DenseGraphAnnealer :
     def anneal_one_step(self, G, beta) :
         # will be dynamically replaced.
         pass
+
+    def anneal(self, schedule, callback = None, interval = 1) :
+        sqaod.anneal_schedule(self, schedule, callback, interval)
         
     def anneal_one_step_naive(self, G, beta) :
         h, J, c, q = self._vars()